@@ -0,0 +1,136 @@
+Texture2D<float4> Texture : register(t0, space2);
+SamplerState Sampler : register(s0, space2);
+
+cbuffer UniformBlock : register(b0, space3)
+{
+    float2 TexelSize : packoffset(c0);
+    float SplitPosition : packoffset(c0.z);
+};
+
+// FXAA 3.11 quality preset 12 style edge search
+static const float EdgeThresholdMin = 0.0312f;
+static const float EdgeThreshold = 0.125f;
+static const float SubpixelQuality = 0.75f;
+static const int SearchSteps = 5;
+static const float SearchStepSizes[5] = {1.0f, 1.5f, 2.0f, 4.0f, 12.0f};
+
+float Luma(float3 color)
+{
+    return dot(color, float3(0.299f, 0.587f, 0.114f));
+}
+
+float SampleLuma(float2 texCoord)
+{
+    return Luma(Texture.SampleLevel(Sampler, texCoord, 0).rgb);
+}
+
+float4 main(float2 TexCoord : TEXCOORD0) : SV_Target0
+{
+    float4 color = Texture.SampleLevel(Sampler, TexCoord, 0);
+    if (TexCoord.x < SplitPosition)
+        return color;
+
+    float lumaCenter = Luma(color.rgb);
+    float lumaDown = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(0, 1)).rgb);
+    float lumaUp = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(0, -1)).rgb);
+    float lumaLeft = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(-1, 0)).rgb);
+    float lumaRight = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(1, 0)).rgb);
+
+    float lumaMin = min(lumaCenter, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+    float lumaMax = max(lumaCenter, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+    float lumaRange = lumaMax - lumaMin;
+
+    // Early exit on pixels without enough local contrast, which is most of the image
+    if (lumaRange < max(EdgeThresholdMin, lumaMax * EdgeThreshold))
+        return color;
+
+    float lumaDownLeft = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(-1, 1)).rgb);
+    float lumaUpRight = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(1, -1)).rgb);
+    float lumaUpLeft = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(-1, -1)).rgb);
+    float lumaDownRight = Luma(Texture.SampleLevel(Sampler, TexCoord, 0, int2(1, 1)).rgb);
+
+    float lumaDownUp = lumaDown + lumaUp;
+    float lumaLeftRight = lumaLeft + lumaRight;
+    float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+    float lumaDownCorners = lumaDownLeft + lumaDownRight;
+    float lumaRightCorners = lumaDownRight + lumaUpRight;
+    float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+    float edgeHorizontal = abs(-2.0f * lumaLeft + lumaLeftCorners) + abs(-2.0f * lumaCenter + lumaDownUp) * 2.0f +
+        abs(-2.0f * lumaRight + lumaRightCorners);
+    float edgeVertical = abs(-2.0f * lumaUp + lumaUpCorners) + abs(-2.0f * lumaCenter + lumaLeftRight) * 2.0f +
+        abs(-2.0f * lumaDown + lumaDownCorners);
+    bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+    float luma1 = isHorizontal ? lumaUp : lumaLeft;
+    float luma2 = isHorizontal ? lumaDown : lumaRight;
+    float gradient1 = luma1 - lumaCenter;
+    float gradient2 = luma2 - lumaCenter;
+    bool isSteepest1 = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25f * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = isHorizontal ? TexelSize.y : TexelSize.x;
+    float lumaLocalAverage;
+    if (isSteepest1)
+    {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5f * (luma1 + lumaCenter);
+    }
+    else
+        lumaLocalAverage = 0.5f * (luma2 + lumaCenter);
+
+    // Walk both ways along the edge, starting half a pixel towards the steepest neighbor
+    float2 edgeTexCoord = TexCoord;
+    if (isHorizontal)
+        edgeTexCoord.y += stepLength * 0.5f;
+    else
+        edgeTexCoord.x += stepLength * 0.5f;
+
+    float2 searchOffset = isHorizontal ? float2(TexelSize.x, 0.0f) : float2(0.0f, TexelSize.y);
+    float2 texCoord1 = edgeTexCoord - searchOffset * SearchStepSizes[0];
+    float2 texCoord2 = edgeTexCoord + searchOffset * SearchStepSizes[0];
+    float lumaEnd1 = SampleLuma(texCoord1) - lumaLocalAverage;
+    float lumaEnd2 = SampleLuma(texCoord2) - lumaLocalAverage;
+    bool reached1 = abs(lumaEnd1) >= gradientScaled;
+    bool reached2 = abs(lumaEnd2) >= gradientScaled;
+
+    [loop]
+    for (int i = 1; i < SearchSteps && !(reached1 && reached2); ++i)
+    {
+        if (!reached1)
+        {
+            texCoord1 -= searchOffset * SearchStepSizes[i];
+            lumaEnd1 = SampleLuma(texCoord1) - lumaLocalAverage;
+            reached1 = abs(lumaEnd1) >= gradientScaled;
+        }
+        if (!reached2)
+        {
+            texCoord2 += searchOffset * SearchStepSizes[i];
+            lumaEnd2 = SampleLuma(texCoord2) - lumaLocalAverage;
+            reached2 = abs(lumaEnd2) >= gradientScaled;
+        }
+    }
+
+    float distance1 = isHorizontal ? TexCoord.x - texCoord1.x : TexCoord.y - texCoord1.y;
+    float distance2 = isHorizontal ? texCoord2.x - TexCoord.x : texCoord2.y - TexCoord.y;
+    bool isDirection1 = distance1 < distance2;
+    float edgeOffset = 0.5f - min(distance1, distance2) / (distance1 + distance2);
+
+    // Only move towards the end of the edge whose luma variation matches the center
+    bool isLumaCenterSmaller = lumaCenter < lumaLocalAverage;
+    bool correctVariation = ((isDirection1 ? lumaEnd1 : lumaEnd2) < 0.0f) != isLumaCenterSmaller;
+    float finalOffset = correctVariation ? edgeOffset : 0.0f;
+
+    float lumaAverage = (1.0f / 12.0f) * (2.0f * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+    float subpixelOffset = saturate(abs(lumaAverage - lumaCenter) / lumaRange);
+    subpixelOffset = (-2.0f * subpixelOffset + 3.0f) * subpixelOffset * subpixelOffset;
+    finalOffset = max(finalOffset, subpixelOffset * subpixelOffset * SubpixelQuality);
+
+    float2 finalTexCoord = TexCoord;
+    if (isHorizontal)
+        finalTexCoord.y += finalOffset * stepLength;
+    else
+        finalTexCoord.x += finalOffset * stepLength;
+
+    return float4(Texture.SampleLevel(Sampler, finalTexCoord, 0).rgb, color.a);
+}
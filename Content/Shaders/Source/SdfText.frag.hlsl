@@ -0,0 +1,17 @@
+Texture2D<float4> Atlas : register(t0, space2);
+SamplerState Sampler : register(s0, space2);
+
+struct Input
+{
+    float2 TexCoord : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+};
+
+float4 main(Input input) : SV_Target0
+{
+    // 0.5 is the outline, scaling by the screen space derivative keeps the edge a pixel wide at every size
+    float distance = Atlas.Sample(Sampler, input.TexCoord).r;
+    float edgeWidth = max(fwidth(distance), 1e-5f);
+    float coverage = saturate((distance - 0.5f) / edgeWidth + 0.5f);
+    return float4(input.Color.rgb, input.Color.a * coverage);
+}
@@ -0,0 +1,38 @@
+cbuffer UniformBlock : register(b0, space1)
+{
+    float2 InverseTargetSize : packoffset(c0);
+};
+
+struct Input
+{
+    float4 Rectangle : TEXCOORD0;
+    float4 TexCoordRectangle : TEXCOORD1;
+    float4 Color : TEXCOORD2;
+    uint VertexIndex : SV_VertexID;
+};
+
+struct Output
+{
+    float2 TexCoord : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+    float4 Position : SV_Position;
+};
+
+// Two triangles per glyph instance
+static const float2 Corners[6] = {
+    float2(0.0f, 0.0f), float2(1.0f, 0.0f), float2(0.0f, 1.0f),
+    float2(0.0f, 1.0f), float2(1.0f, 0.0f), float2(1.0f, 1.0f),
+};
+
+Output main(Input input)
+{
+    Output output;
+    float2 corner = Corners[input.VertexIndex];
+    // Pixels from the top left corner to NDC, where Y points up
+    float2 pixel = input.Rectangle.xy + corner * input.Rectangle.zw;
+    float2 position = pixel * InverseTargetSize * 2.0f - 1.0f;
+    output.Position = float4(position.x, -position.y, 0.0f, 1.0f);
+    output.TexCoord = input.TexCoordRectangle.xy + corner * input.TexCoordRectangle.zw;
+    output.Color = input.Color;
+    return output;
+}
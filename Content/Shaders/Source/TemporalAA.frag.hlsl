@@ -0,0 +1,60 @@
+Texture2D<float4> CurrentTexture : register(t0, space2);
+SamplerState CurrentSampler : register(s0, space2);
+Texture2D<float4> HistoryTexture : register(t1, space2);
+SamplerState HistorySampler : register(s1, space2);
+Texture2D<float2> VelocityTexture : register(t2, space2);
+SamplerState VelocitySampler : register(s2, space2);
+
+cbuffer UniformBlock : register(b0, space3)
+{
+    float2 TexelSize : packoffset(c0);
+    float BlendFactor : packoffset(c0.z);
+    float ResetHistory : packoffset(c0.w);
+};
+
+float3 RGBToYCoCg(float3 color)
+{
+    return float3(
+        0.25f * color.r + 0.5f * color.g + 0.25f * color.b,
+        0.5f * color.r - 0.5f * color.b,
+        -0.25f * color.r + 0.5f * color.g - 0.25f * color.b
+    );
+}
+
+float3 YCoCgToRGB(float3 color)
+{
+    return float3(
+        color.x + color.y - color.z,
+        color.x + color.z,
+        color.x - color.y - color.z
+    );
+}
+
+float4 main(float2 TexCoord : TEXCOORD0) : SV_Target0
+{
+    float3 current = CurrentTexture.Sample(CurrentSampler, TexCoord).rgb;
+    if (ResetHistory > 0.0f)
+        return float4(current, 1.0f);
+
+    // Neighborhood bounds of the current frame, history outside of them is rejected by clamping
+    float3 minimum = RGBToYCoCg(current);
+    float3 maximum = minimum;
+    for (int y = -1; y <= 1; ++y)
+    {
+        for (int x = -1; x <= 1; ++x)
+        {
+            float3 neighbor = RGBToYCoCg(CurrentTexture.Sample(CurrentSampler, TexCoord + float2(x, y) * TexelSize).rgb);
+            minimum = min(minimum, neighbor);
+            maximum = max(maximum, neighbor);
+        }
+    }
+
+    float2 previousTexCoord = TexCoord - VelocityTexture.Sample(VelocitySampler, TexCoord);
+    if (any(previousTexCoord < 0.0f) || any(previousTexCoord > 1.0f))
+        return float4(current, 1.0f);
+
+    float3 history = RGBToYCoCg(HistoryTexture.Sample(HistorySampler, previousTexCoord).rgb);
+    history = YCoCgToRGB(clamp(history, minimum, maximum));
+
+    return float4(lerp(history, current, BlendFactor), 1.0f);
+}
@@ -0,0 +1,27 @@
+Texture2D<float4> Texture : register(t0, space2);
+SamplerState Sampler : register(s0, space2);
+
+struct Input
+{
+    float2 TexCoord : TEXCOORD0;
+    float4 CurrentPosition : TEXCOORD1;
+    float4 PreviousPosition : TEXCOORD2;
+};
+
+struct Output
+{
+    float4 Color : SV_Target0;
+    float2 Velocity : SV_Target1;
+};
+
+Output main(Input input)
+{
+    Output output;
+    output.Color = Texture.Sample(Sampler, input.TexCoord);
+
+    // Unjittered NDC motion converted to texture space, where Y points down
+    float2 current = input.CurrentPosition.xy / input.CurrentPosition.w;
+    float2 previous = input.PreviousPosition.xy / input.PreviousPosition.w;
+    output.Velocity = (current - previous) * float2(0.5f, -0.5f);
+    return output;
+}
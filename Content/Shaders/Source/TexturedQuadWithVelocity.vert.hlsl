@@ -0,0 +1,31 @@
+cbuffer UniformBlock : register(b0, space1)
+{
+    float4x4 JitteredTransform : packoffset(c0);
+    float4x4 CurrentTransform : packoffset(c4);
+    float4x4 PreviousTransform : packoffset(c8);
+};
+
+struct Input
+{
+    float3 Position : TEXCOORD0;
+    float2 TexCoord : TEXCOORD1;
+};
+
+struct Output
+{
+    float2 TexCoord : TEXCOORD0;
+    float4 CurrentPosition : TEXCOORD1;
+    float4 PreviousPosition : TEXCOORD2;
+    float4 Position : SV_Position;
+};
+
+Output main(Input input)
+{
+    Output output;
+    float4 position = float4(input.Position, 1.0f);
+    output.TexCoord = input.TexCoord;
+    output.CurrentPosition = mul(CurrentTransform, position);
+    output.PreviousPosition = mul(PreviousTransform, position);
+    output.Position = mul(JitteredTransform, position);
+    return output;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+void RunJobSystemBenchmark();
+
+void RunEcsBenchmark();
+
+void RunTransformHierarchyBenchmark();
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.hpp"
+#include "Components.hpp"
+#include "Ecs.hpp"
+#include "JobSystem.hpp"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	constexpr Uint32 EntityCount{1'000'000};
+	constexpr int Frames{10};
+	constexpr float DeltaTime{1.0f / 60.0f};
+
+	void UpdateSpin(LocalTransform &transform, const Spin &spin) {
+		transform.rotation = normalize(angleAxis(spin.radiansPerSecond * DeltaTime, spin.axis) * transform.rotation);
+	}
+
+	void UpdateWorldTransform(const LocalTransform &localTransform, WorldTransform &worldTransform) {
+		worldTransform.previousMatrix = worldTransform.matrix;
+		worldTransform.matrix = ToMatrix(localTransform);
+	}
+
+	LocalTransform MakeLocalTransform(const Uint32 i) {
+		return {.position = glm::vec3{static_cast<float>(i % 1000), static_cast<float>(i / 1000), 0.0f}};
+	}
+
+	Spin MakeSpin(const Uint32 i) {
+		return {.axis = glm::vec3{0.0f, 1.0f, 0.0f}, .radiansPerSecond = static_cast<float>(i % 7)};
+	}
+
+	// The usual object oriented layout: every object is its own heap allocation updated through a virtual call, with
+	// data the update doesn't need sitting in between
+	class GameObject {
+	public:
+		virtual ~GameObject() = default;
+
+		virtual void Update() = 0;
+	};
+
+	class SpinningObject final : public GameObject {
+	public:
+		explicit SpinningObject(const Uint32 i)
+			: name{"Object " + std::to_string(i)}, localTransform{MakeLocalTransform(i)}, spin{MakeSpin(i)} {}
+
+		void Update() override {
+			UpdateSpin(localTransform, spin);
+			UpdateWorldTransform(localTransform, worldTransform);
+		}
+
+	private:
+		std::string name;
+		LocalTransform localTransform;
+		Spin spin;
+		WorldTransform worldTransform;
+		MeshInstance meshInstance{};
+	};
+
+	template<typename Function>
+	double MeasureFrame(Function &&function) {
+		std::vector<double> timings;
+		for (auto frame{0}; frame < Frames; ++frame) {
+			const auto start{Clock::now()};
+			function();
+			timings.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		}
+		std::ranges::sort(timings);
+		return timings[timings.size() / 2];
+	}
+}
+
+void RunEcsBenchmark() {
+	std::println("Transform update of {} entities, median of {} frames", EntityCount, Frames);
+
+	std::vector<std::unique_ptr<GameObject>> objects;
+	objects.reserve(EntityCount);
+	for (Uint32 i{}; i < EntityCount; ++i)
+		objects.push_back(std::make_unique<SpinningObject>(i));
+	const auto baselineTime{
+		MeasureFrame([&objects] {
+			for (const auto &object: objects)
+				object->Update();
+		})
+	};
+	objects.clear();
+	std::println("{:>28} {:>10.2f} ms", "vector of objects", baselineTime);
+
+	World world;
+	for (Uint32 i{}; i < EntityCount; ++i)
+		world.Create(MakeLocalTransform(i), WorldTransform{}, MakeSpin(i), MeshInstance{});
+
+	const auto serialTime{
+		MeasureFrame([&world] {
+			world.ForEach<LocalTransform, const Spin>(UpdateSpin);
+			world.ForEach<const LocalTransform, WorldTransform>(UpdateWorldTransform);
+		})
+	};
+	std::println("{:>28} {:>10.2f} ms {:>6.2f}x", "ECS, one thread", serialTime, baselineTime / serialTime);
+
+	JobSystem jobSystem{std::max(1u, std::thread::hardware_concurrency()) - 1};
+	SystemSchedule systems;
+	systems.AddForEach<LocalTransform, const Spin>("Spin", UpdateSpin);
+	systems.AddForEach<const LocalTransform, WorldTransform>("Transforms", UpdateWorldTransform);
+	const auto parallelTime{MeasureFrame([&] { systems.Run(world, jobSystem); })};
+	std::println("{:>28} {:>10.2f} ms {:>6.2f}x", std::format("ECS, {} threads", jobSystem.GetThreadCount()),
+	             parallelTime, baselineTime / parallelTime);
+}
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.hpp"
+#include "JobSystem.hpp"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	constexpr size_t ElementCount{1 << 22};
+	constexpr size_t GrainSize{4096};
+	constexpr int Repetitions{5};
+
+	// Compute bound so the scaling measures the scheduler rather than memory bandwidth
+	float Work(const size_t index) {
+		auto value{static_cast<float>(index) * 0.001f};
+		for (auto i{0}; i < 32; ++i)
+			value = std::sin(value) * 0.5f + std::cos(value * 1.5f);
+		return value;
+	}
+
+	double MeasureParallelFor(JobSystem &jobSystem, std::vector<float> &output) {
+		std::vector<double> timings;
+		for (auto repetition{0}; repetition < Repetitions; ++repetition) {
+			const auto start{Clock::now()};
+			ParallelFor(jobSystem, output.size(), GrainSize, [&output](const size_t begin, const size_t end) {
+				for (auto i{begin}; i < end; ++i)
+					output[i] = Work(i);
+			});
+			timings.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		}
+		std::ranges::sort(timings);
+		return timings[timings.size() / 2];
+	}
+
+	double MeasureJobThroughput(JobSystem &jobSystem) {
+		constexpr auto jobCount{200'000};
+		std::atomic<int> executed{};
+
+		const auto start{Clock::now()};
+		JobCounter counter;
+		for (auto i{0}; i < jobCount; ++i)
+			jobSystem.Run([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+		jobSystem.Wait(counter);
+		const auto seconds{std::chrono::duration<double>(Clock::now() - start).count()};
+
+		return jobCount / seconds;
+	}
+}
+
+void RunJobSystemBenchmark() {
+	const auto coreCount{std::max(1u, std::thread::hardware_concurrency())};
+	std::vector<float> output(ElementCount);
+
+	std::println("Job system scaling, ParallelFor over {} elements in grains of {}", ElementCount, GrainSize);
+	std::println("{:>8} {:>12} {:>10} {:>12} {:>14}", "threads", "median ms", "speedup", "efficiency", "empty jobs/s");
+
+	double singleThreadTime{};
+	for (Uint32 threadCount{1}; threadCount <= coreCount; ++threadCount) {
+		JobSystem jobSystem{threadCount - 1};
+		const auto time{MeasureParallelFor(jobSystem, output)};
+		if (threadCount == 1)
+			singleThreadTime = time;
+		const auto speedup{singleThreadTime / time};
+		std::println("{:>8} {:>12.2f} {:>9.2f}x {:>11.0f}% {:>14.0f}", threadCount, time, speedup,
+		             100.0 * speedup / threadCount, MeasureJobThroughput(jobSystem));
+	}
+}
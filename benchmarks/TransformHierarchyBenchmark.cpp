@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.hpp"
+#include "JobSystem.hpp"
+#include "TransformHierarchy.hpp"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	constexpr Uint32 NodeCount{1'000'000};
+	constexpr Uint32 Depth{20};
+	constexpr int Frames{10};
+
+	// Marks the given fraction of nodes dirty every frame before timing the update
+	double MeasureUpdate(TransformHierarchy &hierarchy, JobSystem &jobSystem, const std::vector<TransformNodeId> &nodes,
+	                     const double dirtyFraction) {
+		std::mt19937 random{42};
+		std::uniform_int_distribution<size_t> pick{0, nodes.size() - 1};
+		const auto dirtyCount{static_cast<size_t>(static_cast<double>(nodes.size()) * dirtyFraction)};
+
+		std::vector<double> timings;
+		for (auto frame{0}; frame < Frames; ++frame) {
+			for (size_t i{}; i < dirtyCount; ++i) {
+				const auto node{nodes[pick(random)]};
+				auto transform{hierarchy.GetLocal(node)};
+				transform.position.x += 0.01f;
+				hierarchy.SetLocal(node, transform);
+			}
+
+			const auto start{Clock::now()};
+			hierarchy.Update(jobSystem);
+			timings.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		}
+		std::ranges::sort(timings);
+		return timings[timings.size() / 2];
+	}
+}
+
+void RunTransformHierarchyBenchmark() {
+	TransformHierarchy hierarchy;
+	std::vector<TransformNodeId> nodes;
+	nodes.reserve(NodeCount);
+
+	// Equal sized levels with random parents in the level above
+	std::mt19937 random{7};
+	constexpr auto nodesPerLevel{NodeCount / Depth};
+	for (Uint32 depth{}; depth < Depth; ++depth)
+		for (Uint32 i{}; i < nodesPerLevel; ++i) {
+			const auto parent{depth == 0 ? NoParent : nodes[(depth - 1) * nodesPerLevel + random() % nodesPerLevel]};
+			nodes.push_back(hierarchy.Create(parent, {.position = glm::vec3{1.0f, 0.0f, 0.0f}}));
+		}
+
+	JobSystem jobSystem{std::max(1u, std::thread::hardware_concurrency()) - 1};
+	std::println("Transform hierarchy update of {} nodes over {} levels on {} threads, median of {} frames",
+	             hierarchy.GetNodeCount(), hierarchy.GetDepth(), jobSystem.GetThreadCount(), Frames);
+	for (const auto dirtyFraction: {1.0, 0.01, 0.0}) {
+		const auto time{MeasureUpdate(hierarchy, jobSystem, nodes, dirtyFraction)};
+		std::println("{:>18} {:>10.3f} ms", std::format("{}% dirty", dirtyFraction * 100.0), time);
+	}
+}
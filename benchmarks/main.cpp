@@ -0,0 +1,11 @@
+#include <cstdlib>
+
+#include "Benchmarks.hpp"
+
+int main() {
+	RunJobSystemBenchmark();
+	RunEcsBenchmark();
+	RunTransformHierarchyBenchmark();
+
+	return EXIT_SUCCESS;
+}
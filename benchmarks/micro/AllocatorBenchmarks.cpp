@@ -0,0 +1,61 @@
+#include <memory_resource>
+#include <vector>
+
+#include "Memory.hpp"
+#include "MicroBenchmarks.hpp"
+
+namespace {
+	constexpr size_t AllocationCount{1024};
+
+	struct Particle {
+		float values[16];
+	};
+}
+
+void RunAllocatorBenchmarks(BenchmarkRunner &runner) {
+	std::vector<Particle *> particles(AllocationCount);
+
+	runner.Run("alloc/new and delete 64 B x1024", [&] {
+		for (auto &particle: particles)
+			particle = new Particle{};
+		DoNotOptimize(particles);
+		for (const auto particle: particles)
+			delete particle;
+	});
+
+	ObjectPool<Particle> pool;
+	runner.Run("alloc/object pool 64 B x1024", [&] {
+		for (auto &particle: particles)
+			particle = pool.Create();
+		DoNotOptimize(particles);
+		for (const auto particle: particles)
+			pool.Destroy(particle);
+	});
+
+	LinearArena arena{AllocationCount * sizeof(Particle)};
+	runner.Run("alloc/linear arena 64 B x1024", [&] {
+		for (auto &particle: particles)
+			particle = static_cast<Particle *>(arena.allocate(sizeof(Particle), alignof(Particle)));
+		DoNotOptimize(particles);
+		arena.Reset();
+	});
+
+	// Room for every reallocation of the growing vector
+	LinearArena vectorArena{2 * AllocationCount * sizeof(Particle)};
+	runner.Run("alloc/pmr vector on linear arena x1024", [&] {
+		{
+			std::pmr::vector<Particle> vector{&vectorArena};
+			for (size_t i{}; i < AllocationCount; ++i)
+				vector.emplace_back();
+			DoNotOptimize(vector);
+		}
+		vectorArena.Reset();
+	});
+
+	runner.Run("alloc/std vector x1024", [&] {
+		std::vector<Particle> vector;
+		for (size_t i{}; i < AllocationCount; ++i)
+			vector.emplace_back();
+		DoNotOptimize(vector);
+	});
+}
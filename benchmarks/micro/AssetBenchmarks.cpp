@@ -0,0 +1,122 @@
+#include <array>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "Assets.hpp"
+#include "HdrImage.hpp"
+#include "JobSystem.hpp"
+#include "MicroBenchmarks.hpp"
+#include "TextureConversion.hpp"
+#include "TextureQuality.hpp"
+
+namespace {
+	// Stand-in for a cooked mesh: the arrays exactly as they get uploaded, after their sizes
+	void WriteCookedMesh(const std::filesystem::path &path, const MeshData &mesh) {
+		std::ofstream file{path, std::ios::binary};
+		const std::array counts{static_cast<Uint32>(mesh.vertices.size()), static_cast<Uint32>(mesh.indices.size())};
+		file.write(reinterpret_cast<const char *>(counts.data()), sizeof(counts));
+		file.write(reinterpret_cast<const char *>(mesh.vertices.data()),
+		           static_cast<std::streamsize>(mesh.vertices.size() * sizeof(Vertex)));
+		file.write(reinterpret_cast<const char *>(mesh.indices.data()),
+		           static_cast<std::streamsize>(mesh.indices.size() * sizeof(Uint32)));
+		if (!file)
+			throw std::runtime_error{"Couldn't write cooked mesh"};
+	}
+
+	MeshData ReadCookedMesh(const std::filesystem::path &path) {
+		std::ifstream file{path, std::ios::binary};
+		std::array<Uint32, 2> counts{};
+		file.read(reinterpret_cast<char *>(counts.data()), sizeof(counts));
+		MeshData mesh;
+		mesh.vertices.resize(counts[0]);
+		mesh.indices.resize(counts[1]);
+		file.read(reinterpret_cast<char *>(mesh.vertices.data()),
+		          static_cast<std::streamsize>(mesh.vertices.size() * sizeof(Vertex)));
+		file.read(reinterpret_cast<char *>(mesh.indices.data()),
+		          static_cast<std::streamsize>(mesh.indices.size() * sizeof(Uint32)));
+		if (!file)
+			throw std::runtime_error{"Couldn't read cooked mesh"};
+		return mesh;
+	}
+
+	// One vertex per index, the layout the importer produces before optimization
+	MeshData Unweld(const MeshData &mesh) {
+		MeshData result;
+		result.vertices.reserve(mesh.indices.size());
+		result.indices.reserve(mesh.indices.size());
+		for (const auto index: mesh.indices) {
+			result.indices.push_back(static_cast<Uint32>(result.vertices.size()));
+			result.vertices.push_back(mesh.vertices[index]);
+		}
+		return result;
+	}
+
+	void RunMeshBenchmarks(BenchmarkRunner &runner) {
+		MeshData mesh;
+		try {
+			mesh = LoadMesh("viking_room.obj");
+		} catch (const std::exception &exception) {
+			runner.Skip("mesh", exception.what());
+			return;
+		}
+
+		runner.Run("mesh/import assimp viking_room.obj", [] { DoNotOptimize(LoadMesh("viking_room.obj")); });
+
+		const auto cookedPath{std::filesystem::temp_directory_path() / "viking_room.mesh"};
+		WriteCookedMesh(cookedPath, mesh);
+		runner.Run("mesh/import cooked viking_room", [&cookedPath] { DoNotOptimize(ReadCookedMesh(cookedPath)); });
+		std::filesystem::remove(cookedPath);
+
+		const auto unwelded{Unweld(mesh)};
+		runner.Run("mesh/optimize viking_room", [&unwelded] {
+			auto copy{unwelded};
+			OptimizeMesh(copy);
+			DoNotOptimize(copy);
+		});
+	}
+
+	void RunImageBenchmarks(BenchmarkRunner &runner) {
+		SDL_Surface *decoded;
+		try {
+			decoded = LoadImage("viking_room.png");
+		} catch (const std::exception &exception) {
+			runner.Skip("image", exception.what());
+			return;
+		}
+
+		runner.Run("image/decode viking_room.png", [] { SDL_DestroySurface(LoadImage("viking_room.png")); });
+
+		// Without workers, the time one thread spends on the downscale
+		JobSystem jobSystem{0};
+		const auto image{SDL_ConvertSurface(decoded, SDL_PIXELFORMAT_RGBA32)};
+		SDL_DestroySurface(decoded);
+		if (!image)
+			throw std::runtime_error{"Couldn't convert viking_room.png"};
+		for (const auto quality: {TextureQuality::Half, TextureQuality::Quarter})
+			runner.Run(std::format("image/downscale viking_room.png {}", ToString(quality)), [&] {
+				SDL_DestroySurface(DownscaleImage(jobSystem, image, GetHalvingCount(quality)));
+			});
+		for (const auto usage: {TextureUsage::Color, TextureUsage::Mask, TextureUsage::TwoChannel})
+			runner.Run(std::format("image/convert viking_room.png {}", ToString(usage)), [&] {
+				DoNotOptimize(CreateTextureImage(jobSystem, image, usage, TextureQuality::Full));
+			});
+		SDL_DestroySurface(image);
+
+		HdrImage hdrImage;
+		try {
+			hdrImage = LoadHdrImage(BasePath / "Content/Images/memorial.hdr");
+		} catch (const std::exception &exception) {
+			runner.Skip("image/convert memorial.hdr", exception.what());
+			return;
+		}
+		runner.Run("image/convert memorial.hdr hdr", [&hdrImage] { DoNotOptimize(CreateTextureImage(hdrImage)); });
+	}
+}
+
+void RunAssetBenchmarks(BenchmarkRunner &runner) {
+	RunMeshBenchmarks(runner);
+	RunImageBenchmarks(runner);
+}
@@ -0,0 +1,46 @@
+#include <format>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "MicroBenchmarks.hpp"
+#include "YuvConversion.hpp"
+
+namespace {
+	constexpr Uint32 FrameWidth{1920};
+	constexpr Uint32 FrameHeight{1080};
+
+	// Both sides odd and rows padded, so the SIMD loops end in the scalar tail and the last row and column repeat
+	void CheckYuvConversion(BenchmarkRunner &runner, const std::vector<Uint8> &pixels) {
+		constexpr Uint32 Width{FrameWidth - 1};
+		constexpr Uint32 Height{FrameHeight - 1};
+		constexpr Uint32 Pitch{FrameWidth * 4};
+		std::vector<Uint8> yuv(GetYuv420Size(Width, Height));
+		std::vector<Uint8> expected(yuv.size());
+		for (const auto [format, name]: {
+			     std::pair{SDL_PIXELFORMAT_RGBA32, std::string_view{"rgba"}},
+			     std::pair{SDL_PIXELFORMAT_BGRA32, std::string_view{"bgra"}}
+		     }) {
+			ConvertToYuv420(pixels.data(), Width, Height, Pitch, format, yuv.data());
+			ConvertToYuv420Reference(pixels.data(), Width, Height, Pitch, format, expected.data());
+			runner.Check(std::format("check/{} to yuv420", name), yuv == expected, "against the scalar path");
+		}
+	}
+}
+
+void RunCaptureBenchmarks(BenchmarkRunner &runner) {
+	// Noise rather than a flat color, the conversion doesn't branch on pixels but the memory traffic should be real
+	std::mt19937 random{1234};
+	std::vector<Uint8> pixels(static_cast<size_t>(FrameWidth) * FrameHeight * 4);
+	for (auto &pixel: pixels)
+		pixel = static_cast<Uint8>(random());
+	CheckYuvConversion(runner, pixels);
+
+	std::vector<Uint8> yuv(GetYuv420Size(FrameWidth, FrameHeight));
+
+	runner.Run("capture/bgra to yuv420 1080p", [&] {
+		ConvertToYuv420(pixels.data(), FrameWidth, FrameHeight, FrameWidth * 4, SDL_PIXELFORMAT_BGRA32, yuv.data());
+		DoNotOptimize(yuv);
+	});
+}
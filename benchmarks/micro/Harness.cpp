@@ -0,0 +1,79 @@
+#include "Harness.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <print>
+#include <stdexcept>
+
+#include "Statistics.hpp"
+
+const void *volatile BenchmarkDetail::sink;
+
+BenchmarkRunner::BenchmarkRunner(std::string filter) : filter{std::move(filter)} {
+	std::println("{:<44} {:>12} {:>12} {:>12} {:>12} {:>8}", "Benchmark", "mean", "median", "p90", "p99", "samples");
+}
+
+void BenchmarkRunner::Skip(const std::string_view name, const std::string_view reason) const {
+	if (name.contains(filter))
+		std::println("{:<44} skipped, {}", name, reason);
+}
+
+void BenchmarkRunner::Check(const std::string_view name, const bool passed, const std::string_view detail) {
+	if (!name.contains(filter))
+		return;
+	hasFailedChecks = hasFailedChecks || !passed;
+	std::println("{:<44} {}{}{}", name, passed ? "pass" : "FAIL", detail.empty() ? "" : ", ", detail);
+}
+
+void BenchmarkRunner::AddResult(const std::string_view name, std::vector<double> &samples,
+                                const Uint64 iterationsPerSample) {
+	std::ranges::sort(samples);
+	const auto &result{
+		results.emplace_back(BenchmarkResult{
+			.name = std::string{name},
+			.sampleCount = samples.size(),
+			.iterationsPerSample = iterationsPerSample,
+			.meanNanoseconds = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size()),
+			.medianNanoseconds = Percentile(samples, 50.0),
+			.p90Nanoseconds = Percentile(samples, 90.0),
+			.p99Nanoseconds = Percentile(samples, 99.0),
+			.minNanoseconds = samples.front(),
+		})
+	};
+
+	const auto format{
+		[](const double nanoseconds) {
+			if (nanoseconds >= 1e6)
+				return std::format("{:.2f} ms", nanoseconds / 1e6);
+			if (nanoseconds >= 1e3)
+				return std::format("{:.2f} us", nanoseconds / 1e3);
+			return std::format("{:.1f} ns", nanoseconds);
+		}
+	};
+	std::println("{:<44} {:>12} {:>12} {:>12} {:>12} {:>8}", result.name, format(result.meanNanoseconds),
+	             format(result.medianNanoseconds), format(result.p90Nanoseconds), format(result.p99Nanoseconds),
+	             result.sampleCount);
+}
+
+void BenchmarkRunner::WriteJson(const std::filesystem::path &path) const {
+	std::ofstream file{path};
+	if (!file)
+		throw std::runtime_error{"Couldn't open benchmark results file"};
+
+	file << "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [";
+	for (size_t i{}; i < results.size(); ++i) {
+		const auto &result{results[i]};
+		// Names are chosen by the benchmarks and never need escaping
+		file << std::format(
+			"{}\n    {{\"name\": \"{}\", \"samples\": {}, \"iterations_per_sample\": {}, \"mean\": {:.3f}, "
+			"\"median\": {:.3f}, \"p90\": {:.3f}, \"p99\": {:.3f}, \"min\": {:.3f}}}",
+			i ? "," : "", result.name, result.sampleCount, result.iterationsPerSample, result.meanNanoseconds,
+			result.medianNanoseconds, result.p90Nanoseconds, result.p99Nanoseconds, result.minNanoseconds);
+	}
+	file << "\n  ]\n}\n";
+
+	if (!file)
+		throw std::runtime_error{"Couldn't write benchmark results file"};
+}
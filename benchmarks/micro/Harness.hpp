@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+
+// Statistics of one benchmark, times are per iteration
+struct BenchmarkResult {
+	std::string name;
+	Uint64 sampleCount;
+	Uint64 iterationsPerSample;
+	double meanNanoseconds;
+	double medianNanoseconds;
+	double p90Nanoseconds;
+	double p99Nanoseconds;
+	double minNanoseconds;
+};
+
+namespace BenchmarkDetail {
+	extern const void *volatile sink;
+}
+
+// Keeps the compiler from removing the computation of a value nothing else reads
+template<typename T>
+void DoNotOptimize(const T &value) {
+	BenchmarkDetail::sink = &value;
+}
+
+// Runs every benchmark until a time budget is spent. Iterations are batched so a sample is long enough for the clock,
+// and the first batches double as warm up.
+class BenchmarkRunner {
+public:
+	static constexpr std::chrono::nanoseconds MinSampleTime{std::chrono::microseconds{200}};
+	static constexpr std::chrono::nanoseconds TimeBudget{std::chrono::milliseconds{500}};
+	static constexpr size_t MinSamples{10};
+	static constexpr size_t MaxSamples{2000};
+
+	// Only benchmarks whose name contains the filter run
+	explicit BenchmarkRunner(std::string filter);
+
+	template<typename Function>
+	void Run(const std::string_view name, Function &&function) {
+		if (!name.contains(filter))
+			return;
+		using Clock = std::chrono::steady_clock;
+
+		Uint64 iterations{1};
+		while (true) {
+			const auto start{Clock::now()};
+			for (Uint64 i{}; i < iterations; ++i)
+				function();
+			if (Clock::now() - start >= MinSampleTime)
+				break;
+			iterations *= 2;
+		}
+
+		std::vector<double> samples;
+		const auto runStart{Clock::now()};
+		while (samples.size() < MaxSamples && (samples.size() < MinSamples || Clock::now() - runStart < TimeBudget)) {
+			const auto start{Clock::now()};
+			for (Uint64 i{}; i < iterations; ++i)
+				function();
+			samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+			                  static_cast<double>(iterations));
+		}
+		AddResult(name, samples, iterations);
+	}
+
+	// For benchmarks that can't run, e.g. because of missing content
+	void Skip(std::string_view name, std::string_view reason) const;
+
+	// Reports whether a benchmarked function gives the results it should, a failed check fails the whole run
+	void Check(std::string_view name, bool passed, std::string_view detail = {});
+
+	[[nodiscard]] const std::vector<BenchmarkResult> &GetResults() const { return results; }
+
+	[[nodiscard]] bool HasFailedChecks() const { return hasFailedChecks; }
+
+	void WriteJson(const std::filesystem::path &path) const;
+
+private:
+	void AddResult(std::string_view name, std::vector<double> &samples, Uint64 iterationsPerSample);
+
+	std::string filter;
+	std::vector<BenchmarkResult> results;
+	bool hasFailedChecks{};
+};
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include "Components.hpp"
+#include "Culling.hpp"
+#include "MicroBenchmarks.hpp"
+
+namespace {
+	constexpr size_t TransformCount{1024};
+	constexpr size_t SphereCount{64 * 1024};
+	constexpr size_t SortKeyCount{64 * 1024};
+
+	// Fixed seed so runs on different machines measure the same data
+	std::mt19937 MakeRandom() {
+		return std::mt19937{1234};
+	}
+
+	std::vector<LocalTransform> MakeTransforms() {
+		auto random{MakeRandom()};
+		std::uniform_real_distribution<float> distribution{-10.0f, 10.0f};
+		std::vector<LocalTransform> transforms(TransformCount);
+		for (auto &transform: transforms) {
+			transform.position = glm::vec3{distribution(random), distribution(random), distribution(random)};
+			transform.rotation = normalize(glm::quat{1.0f, distribution(random), distribution(random), distribution(random)});
+		}
+		return transforms;
+	}
+}
+
+void RunMathBenchmarks(BenchmarkRunner &runner) {
+	const auto transforms{MakeTransforms()};
+	std::vector<glm::mat4> matrices(TransformCount);
+
+	runner.Run("math/local transform to matrix x1024", [&] {
+		for (size_t i{}; i < TransformCount; ++i)
+			matrices[i] = ToMatrix(transforms[i]);
+		DoNotOptimize(matrices);
+	});
+
+	std::vector<glm::mat4> worldMatrices(TransformCount);
+	runner.Run("math/mat4 multiply x1024", [&] {
+		const glm::mat4 parent{ToMatrix(transforms[0])};
+		for (size_t i{}; i < TransformCount; ++i)
+			worldMatrices[i] = parent * matrices[i];
+		DoNotOptimize(worldMatrices);
+	});
+
+	auto random{MakeRandom()};
+	std::uniform_real_distribution position{-100.0f, 100.0f};
+	std::uniform_real_distribution radius{0.5f, 2.0f};
+	std::vector<BoundingSphere> spheres(SphereCount);
+	for (auto &sphere: spheres)
+		sphere = {glm::vec3{position(random), position(random), position(random)}, radius(random)};
+	const auto projectionView{
+		glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+		lookAt(glm::vec3{0.0f, 0.0f, 50.0f}, glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f})
+	};
+	std::vector<Uint32> visible;
+	visible.reserve(SphereCount);
+	runner.Run("culling/frustum spheres x65536", [&] {
+		visible.clear();
+		CullSpheres(ExtractFrustum(projectionView), spheres, visible);
+		DoNotOptimize(visible);
+	});
+
+	// Draw sort keys, e.g. pipeline, material and depth packed into 64 bits
+	std::vector<Uint64> keys(SortKeyCount);
+	std::ranges::generate(keys, [&random] { return (Uint64{random()} << 32) | random(); });
+	auto sortedKeys{keys};
+	runner.Run("sort/copy and sort 64 bit keys x65536", [&] {
+		std::ranges::copy(keys, sortedKeys.begin());
+		std::ranges::sort(sortedKeys);
+		DoNotOptimize(sortedKeys);
+	});
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Harness.hpp"
+
+void RunAssetBenchmarks(BenchmarkRunner &runner);
+
+void RunMathBenchmarks(BenchmarkRunner &runner);
+
+void RunAllocatorBenchmarks(BenchmarkRunner &runner);
+
+void RunCaptureBenchmarks(BenchmarkRunner &runner);
+
+void RunToneMappingBenchmarks(BenchmarkRunner &runner);
+
+void RunTextureConversionBenchmarks(BenchmarkRunner &runner);
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEXTURE_CONVERSION_F16C
+#endif
+
+#include "JobSystem.hpp"
+#include "MicroBenchmarks.hpp"
+#include "TextureConversion.hpp"
+
+namespace {
+	// Not a multiple of any vector width, so the scalar tails run too
+	constexpr Uint32 ImageWidth{1021};
+	constexpr Uint32 ImageHeight{1024};
+	constexpr size_t PixelCount{static_cast<size_t>(ImageWidth) * ImageHeight};
+
+	// Rounds through double arithmetic instead of bit tricks: the value is scaled so the half spacing of its binade is
+	// 1, then rounded to the nearest integer with ties to even
+	Uint16 ReferenceHalf(const float value) {
+		const Uint16 sign{static_cast<Uint16>(std::signbit(value) ? 0x8000 : 0)};
+		if (std::isnan(value))
+			return sign | 0x7e00;
+		const auto magnitude{std::fabs(static_cast<double>(value))};
+		// Half way between 65504, the largest half, and 65536
+		if (magnitude >= 65520.0)
+			return sign | 0x7c00;
+		int exponent;
+		std::frexp(magnitude, &exponent);
+		const auto spacing{std::ldexp(1.0, std::max(exponent - 1, -14) - 10)};
+		const auto rounded{std::nearbyint(magnitude / spacing) * spacing};
+		if (rounded < 0x1p-14)
+			return sign | static_cast<Uint16>(rounded / 0x1p-24);
+		const auto fraction{std::frexp(rounded, &exponent)};
+		return sign | static_cast<Uint16>((exponent + 14) << 10 | static_cast<Uint16>((fraction * 2.0 - 1.0) * 1024.0));
+	}
+
+	bool IsHalfNan(const Uint16 half) { return (half & 0x7c00) == 0x7c00 && (half & 0x3ff); }
+
+	struct HalfComparison {
+		size_t mismatchCount;
+		std::string detail;
+	};
+
+	// Every NaN counts as equal, the payloads don't matter to a texture
+	HalfComparison CompareHalves(const std::vector<float> &values, const std::vector<Uint16> &halves,
+	                             const std::vector<Uint16> &expected) {
+		HalfComparison result{};
+		std::string firstMismatch;
+		for (size_t i{}; i < values.size(); ++i)
+			if (halves[i] != expected[i] && !(IsHalfNan(halves[i]) && IsHalfNan(expected[i])) &&
+			    !result.mismatchCount++)
+				firstMismatch = std::format(", {:a} gave {:#06x} instead of {:#06x}", values[i], halves[i], expected[i]);
+		result.detail = std::format("{} of {} values differ{}", result.mismatchCount, values.size(), firstMismatch);
+		return result;
+	}
+
+	// The values where rounding to half changes, each rounding boundary and the floats next to it, the specials and
+	// random bit patterns
+	std::vector<float> CreateHalfTestValues() {
+		std::vector<float> values;
+		for (Uint32 half{}; half < 0x7c00; ++half) {
+			const auto value{static_cast<float>(std::ldexp(half < 0x400 ? half : (0x400 | (half & 0x3ff)),
+			                                               half < 0x400 ? -24 : static_cast<int>(half >> 10) - 25))};
+			const auto spacing{half < 0x400 ? 0x1p-24f : std::ldexp(1.0f, static_cast<int>(half >> 10) - 25)};
+			const auto boundary{value + spacing * 0.5f};
+			for (const auto candidate: {
+				     value, boundary, std::nextafter(boundary, 0.0f), std::nextafter(boundary, 1e30f),
+				     std::nextafter(value, 0.0f), std::nextafter(value, 1e30f)
+			     }) {
+				values.push_back(candidate);
+				values.push_back(-candidate);
+			}
+		}
+		for (const auto special: {
+			     std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(),
+			     std::numeric_limits<float>::max(), std::numeric_limits<float>::min(),
+			     std::numeric_limits<float>::denorm_min(), 65520.0f, std::nextafter(65520.0f, 0.0f), 1e10f
+		     }) {
+			values.push_back(special);
+			values.push_back(-special);
+		}
+		std::mt19937 random{1234};
+		for (size_t i{}; i < 1 << 20; ++i)
+			values.push_back(std::bit_cast<float>(static_cast<Uint32>(random())));
+		return values;
+	}
+
+#if defined(TEXTURE_CONVERSION_F16C)
+	__attribute__((target("f16c"))) void ConvertToHalfF16c(const float *values, const size_t count, Uint16 *output) {
+		size_t i{};
+		for (; i + 8 <= count; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+			                 _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT));
+		for (; i < count; ++i)
+			output[i] = static_cast<Uint16>(_mm_extract_epi16(_mm_cvtps_ph(_mm_set_ss(values[i]), 0), 0));
+	}
+#endif
+
+	template<typename T>
+	std::vector<T> CreateNoise(const size_t count) {
+		std::mt19937 random{1234};
+		std::vector<T> values(count);
+		for (auto &value: values)
+			if constexpr (std::is_floating_point_v<T>)
+				value = std::exp2(static_cast<T>(random() % 4000) / 100 - 20);
+			else
+				value = static_cast<T>(random());
+		return values;
+	}
+
+	SDL_Surface *CreateNoiseSurface(const SDL_PixelFormat format) {
+		const auto surface{SDL_CreateSurface(ImageWidth, ImageHeight, format)};
+		if (!surface)
+			return nullptr;
+		const auto rowSize{static_cast<size_t>(SDL_BYTESPERPIXEL(format)) * ImageWidth};
+		// Floats as positive radiance, every other layout as random bits
+		auto noise{CreateNoise<Uint8>(rowSize * ImageHeight)};
+		if (format == SDL_PIXELFORMAT_RGB96_FLOAT) {
+			const auto radiance{CreateNoise<float>(noise.size() / sizeof(float))};
+			std::memcpy(noise.data(), radiance.data(), noise.size());
+		}
+		for (Uint32 y{}; y < ImageHeight; ++y)
+			std::memcpy(static_cast<Uint8 *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch,
+			            noise.data() + y * rowSize, rowSize);
+		if (format == SDL_PIXELFORMAT_INDEX8) {
+			const auto palette{SDL_CreateSurfacePalette(surface)};
+			std::vector<SDL_Color> grays(256);
+			for (size_t i{}; i < grays.size(); ++i)
+				grays[i] = {static_cast<Uint8>(i), static_cast<Uint8>(i), static_cast<Uint8>(i), 255};
+			if (!palette || !SDL_SetPaletteColors(palette, grays.data(), 0, static_cast<int>(grays.size()))) {
+				SDL_DestroySurface(surface);
+				return nullptr;
+			}
+		}
+		return surface;
+	}
+
+	// One DownscaleImage pass one channel at a time, repeating the last row and column of odd sizes
+	std::vector<Uint8> HalveReference(const std::vector<Uint8> &pixels, const Uint32 width, const Uint32 height) {
+		const auto halfWidth{(width + 1) / 2};
+		const auto halfHeight{(height + 1) / 2};
+		std::vector<Uint8> result(static_cast<size_t>(halfWidth) * halfHeight * 4);
+		const auto at{[&](const Uint32 x, const Uint32 y, const Uint32 channel) -> Uint32 {
+			return pixels[(static_cast<size_t>(std::min(y, height - 1)) * width + std::min(x, width - 1)) * 4 + channel];
+		}};
+		for (Uint32 y{}; y < halfHeight; ++y)
+			for (Uint32 x{}; x < halfWidth; ++x)
+				for (Uint32 channel{}; channel < 4; ++channel)
+					result[(static_cast<size_t>(y) * halfWidth + x) * 4 + channel] = static_cast<Uint8>(
+						(at(x * 2, y * 2, channel) + at(x * 2 + 1, y * 2, channel) + at(x * 2, y * 2 + 1, channel) +
+						 at(x * 2 + 1, y * 2 + 1, channel) + 2) / 4);
+		return result;
+	}
+
+	// Both sides odd, so the SIMD rows end in a scalar tail and the last row and column repeat
+	void CheckDownscale(BenchmarkRunner &runner, JobSystem &jobSystem, const std::vector<Uint8> &pixels) {
+		constexpr Uint32 Width{ImageWidth};
+		constexpr Uint32 Height{ImageHeight - 1};
+		const auto image{SDL_CreateSurface(Width, Height, SDL_PIXELFORMAT_RGBA32)};
+		if (!image) {
+			runner.Skip("check/downscale", SDL_GetError());
+			return;
+		}
+		for (Uint32 y{}; y < Height; ++y)
+			std::memcpy(static_cast<Uint8 *>(image->pixels) + static_cast<size_t>(y) * image->pitch,
+			            pixels.data() + static_cast<size_t>(y) * Width * 4, Width * 4);
+
+		auto expected{std::vector<Uint8>(pixels.begin(), pixels.begin() + static_cast<ptrdiff_t>(Width * Height * 4))};
+		auto width{Width};
+		auto height{Height};
+		for (const auto quality: {TextureQuality::Half, TextureQuality::Quarter}) {
+			expected = HalveReference(expected, width, height);
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+
+			const auto downscaled{DownscaleImage(jobSystem, image, GetHalvingCount(quality))};
+			auto passed{downscaled->w == static_cast<int>(width) && downscaled->h == static_cast<int>(height)};
+			for (Uint32 y{}; passed && y < height; ++y)
+				passed = std::memcmp(static_cast<const Uint8 *>(downscaled->pixels) +
+				                     static_cast<size_t>(y) * downscaled->pitch,
+				                     expected.data() + static_cast<size_t>(y) * width * 4, width * 4) == 0;
+			runner.Check(std::format("check/downscale {}", ToString(quality)), passed, "against a scalar reference");
+			SDL_DestroySurface(downscaled);
+		}
+		SDL_DestroySurface(image);
+	}
+
+	// The layouts CreateTextureImage reads as they are against SDL converting them to the RGBA layout first
+	void CheckDirectReads(BenchmarkRunner &runner, JobSystem &jobSystem) {
+		const struct {
+			SDL_PixelFormat format;
+			SDL_PixelFormat rgbaFormat;
+			std::string_view name;
+			std::vector<TextureUsage> usages;
+		} sources[]{
+			{
+				SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_RGBA32, "rgb24",
+				{TextureUsage::Color, TextureUsage::Mask, TextureUsage::TwoChannel}
+			},
+			// Grayscale, which keeps a single channel for two-channel usages and four once converted
+			{SDL_PIXELFORMAT_INDEX8, SDL_PIXELFORMAT_RGBA32, "index8", {TextureUsage::Color, TextureUsage::Mask}},
+			{SDL_PIXELFORMAT_RGB48, SDL_PIXELFORMAT_RGBA64, "rgb48", {TextureUsage::Height}},
+			{SDL_PIXELFORMAT_RGB96_FLOAT, SDL_PIXELFORMAT_RGBA128_FLOAT, "rgb96f", {TextureUsage::Hdr}},
+		};
+		for (const auto &source: sources) {
+			const auto name{std::format("check/convert {}", source.name)};
+			const auto image{CreateNoiseSurface(source.format)};
+			const auto rgbaImage{image ? SDL_ConvertSurface(image, source.rgbaFormat) : nullptr};
+			if (!rgbaImage) {
+				runner.Skip(name, SDL_GetError());
+				SDL_DestroySurface(image);
+				continue;
+			}
+			for (const auto usage: source.usages) {
+				const auto direct{CreateTextureImage(jobSystem, image, usage, TextureQuality::Full)};
+				const auto converted{CreateTextureImage(jobSystem, rgbaImage, usage, TextureQuality::Full)};
+				runner.Check(std::format("{} {}", name, ToString(usage)),
+				             direct.format == converted.format && direct.pixels == converted.pixels,
+				             "against converting with SDL first");
+			}
+			SDL_DestroySurface(rgbaImage);
+			SDL_DestroySurface(image);
+		}
+	}
+
+	void CheckExtraction(BenchmarkRunner &runner, const std::vector<Uint8> &pixels,
+	                     const std::vector<Uint16> &pixels16) {
+		for (const Uint32 pixelSize: {3u, 4u})
+			for (const Uint32 channelCount: {1u, 2u}) {
+				std::vector<Uint8> output(PixelCount * channelCount);
+				std::vector<Uint8> expected(output.size());
+				ExtractChannels(pixels.data(), PixelCount, pixelSize, channelCount, output.data());
+				for (size_t i{}; i < expected.size(); ++i)
+					expected[i] = pixels[i / channelCount * pixelSize + i % channelCount];
+				runner.Check(
+					std::format("check/extract {} of {} channels", channelCount == 1 ? "r8" : "rg8", pixelSize),
+					output == expected);
+			}
+
+		for (const Uint32 pixelSize: {3u, 4u}) {
+			std::vector<Uint16> output(PixelCount);
+			std::vector<Uint16> expected(PixelCount);
+			ExtractFirstChannel16(pixels16.data(), PixelCount, pixelSize, output.data());
+			for (size_t i{}; i < expected.size(); ++i)
+				expected[i] = pixels16[i * pixelSize];
+			runner.Check(std::format("check/extract r16 of {} channels", pixelSize), output == expected);
+		}
+
+		std::vector<Uint8> output(PixelCount * 4);
+		std::vector<Uint8> expected(PixelCount * 4);
+		ExpandToRgba(pixels.data(), PixelCount, output.data());
+		for (size_t i{}; i < expected.size(); ++i)
+			expected[i] = i % 4 == 3 ? 255 : pixels[i / 4 * 3 + i % 4];
+		runner.Check("check/expand rgb24 to rgba32", output == expected);
+	}
+
+	void CheckHalfConversion(BenchmarkRunner &runner) {
+		const auto values{CreateHalfTestValues()};
+		std::vector<Uint16> halves(values.size());
+		ConvertToHalf(values.data(), values.size(), halves.data());
+
+		std::vector<Uint16> expected(values.size());
+		for (size_t i{}; i < values.size(); ++i)
+			expected[i] = ReferenceHalf(values[i]);
+		const auto reference{CompareHalves(values, halves, expected)};
+		runner.Check("check/half against reference", reference.mismatchCount == 0, reference.detail);
+
+#if defined(TEXTURE_CONVERSION_F16C)
+		if (!__builtin_cpu_supports("f16c")) {
+			runner.Skip("check/half against f16c", "the CPU has no F16C");
+			return;
+		}
+		ConvertToHalfF16c(values.data(), values.size(), expected.data());
+		const auto f16c{CompareHalves(values, halves, expected)};
+		runner.Check("check/half against f16c", f16c.mismatchCount == 0, f16c.detail);
+#else
+		runner.Skip("check/half against f16c", "not an x86 build");
+#endif
+	}
+}
+
+void RunTextureConversionBenchmarks(BenchmarkRunner &runner) {
+	const auto pixels{CreateNoise<Uint8>(PixelCount * 4)};
+	const auto pixels16{CreateNoise<Uint16>(PixelCount * 4)};
+	const auto hdrPixels{CreateNoise<float>(PixelCount * 4)};
+	JobSystem jobSystem{0};
+
+	CheckExtraction(runner, pixels, pixels16);
+	CheckHalfConversion(runner);
+	CheckDirectReads(runner, jobSystem);
+	CheckDownscale(runner, jobSystem, pixels);
+
+	std::vector<Uint8> output(PixelCount * 4);
+	for (const Uint32 pixelSize: {3u, 4u})
+		runner.Run(std::format("convert/extract r8 of {} channels 1MP", pixelSize), [&] {
+			ExtractChannels(pixels.data(), PixelCount, pixelSize, 1, output.data());
+			DoNotOptimize(output);
+		});
+	runner.Run("convert/expand rgb24 to rgba32 1MP", [&] {
+		ExpandToRgba(pixels.data(), PixelCount, output.data());
+		DoNotOptimize(output);
+	});
+
+	std::vector<Uint16> halves(PixelCount * 4);
+	runner.Run("convert/half 1MP", [&] {
+		ConvertToHalf(hdrPixels.data(), hdrPixels.size(), halves.data());
+		DoNotOptimize(halves);
+	});
+#if defined(TEXTURE_CONVERSION_F16C)
+	if (__builtin_cpu_supports("f16c"))
+		runner.Run("convert/half f16c 1MP", [&] {
+			ConvertToHalfF16c(hdrPixels.data(), hdrPixels.size(), halves.data());
+			DoNotOptimize(halves);
+		});
+#endif
+
+	// The direct read against the SDL conversion it replaces
+	if (const auto image{CreateNoiseSurface(SDL_PIXELFORMAT_RGB24)}) {
+		runner.Run("convert/color rgb24 1MP", [&] {
+			DoNotOptimize(CreateTextureImage(jobSystem, image, TextureUsage::Color, TextureQuality::Full));
+		});
+		runner.Run("convert/color rgb24 through sdl 1MP", [&] {
+			const auto converted{SDL_ConvertSurface(image, SDL_PIXELFORMAT_RGBA32)};
+			DoNotOptimize(CreateTextureImage(jobSystem, converted, TextureUsage::Color, TextureQuality::Full));
+			SDL_DestroySurface(converted);
+		});
+		SDL_DestroySurface(image);
+	}
+}
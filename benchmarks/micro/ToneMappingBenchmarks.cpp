@@ -0,0 +1,28 @@
+#include <cmath>
+#include <format>
+#include <random>
+#include <vector>
+
+#include "MicroBenchmarks.hpp"
+#include "ToneMapping.hpp"
+
+namespace {
+	constexpr size_t PixelCount{1920 * 1080};
+}
+
+void RunToneMappingBenchmarks(BenchmarkRunner &runner) {
+	// Log-uniform radiance over a range like memorial.hdr's, so every branchless path sees realistic exponents
+	std::mt19937 random{1234};
+	std::uniform_real_distribution stops{-10.0f, 10.0f};
+	std::vector<float> pixels(PixelCount * 4);
+	for (size_t channel{}; channel < pixels.size(); ++channel)
+		pixels[channel] = channel % 4 == 3 ? 1.0f : std::exp2(stops(random));
+	std::vector<Uint8> output(PixelCount * 4);
+
+	for (const auto toneMapOperator: {ToneMapOperator::Reinhard, ToneMapOperator::Aces})
+		for (const auto transferFunction: {TransferFunction::Srgb, TransferFunction::Pq})
+			runner.Run(std::format("tonemap/{} {} 1080p", ToString(toneMapOperator), ToString(transferFunction)), [&] {
+				ToneMapPixels(pixels.data(), PixelCount, toneMapOperator, transferFunction, output.data());
+				DoNotOptimize(output);
+			});
+}
@@ -0,0 +1,29 @@
+#include <cstdlib>
+#include <print>
+#include <span>
+#include <string>
+#include <SDL3/SDL.h>
+
+#include "Assets.hpp"
+#include "CommandLine.hpp"
+#include "MicroBenchmarks.hpp"
+
+int main(int argc, char **argv) {
+	const auto arguments{std::span{argv, static_cast<size_t>(argc)}.subspan(1)};
+	BasePath = SDL_GetBasePath();
+
+	BenchmarkRunner runner{std::string{FindOption(arguments, "filter").value_or("")}};
+	RunAssetBenchmarks(runner);
+	RunMathBenchmarks(runner);
+	RunAllocatorBenchmarks(runner);
+	RunCaptureBenchmarks(runner);
+	RunToneMappingBenchmarks(runner);
+	RunTextureConversionBenchmarks(runner);
+
+	if (const auto path{FindOption(arguments, "json")}) {
+		runner.WriteJson(*path);
+		std::println("Wrote {}", *path);
+	}
+
+	return runner.HasFailedChecks() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
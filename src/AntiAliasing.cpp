@@ -0,0 +1,376 @@
+#include "AntiAliasing.hpp"
+
+#include <print>
+#include <string>
+#include <glm/ext/matrix_transform.hpp>
+
+#include "Assets.hpp"
+#include "CommandLine.hpp"
+#include "GpuResources.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+
+namespace {
+	Uint32 ToSampleCountValue(const SDL_GPUSampleCount sampleCount) {
+		return 1u << sampleCount;
+	}
+
+	SDL_GPUTexture *CreateRenderTarget(
+		SDL_GPUDevice *device,
+		const char *name,
+		const SDL_GPUTextureFormat format,
+		const SDL_GPUTextureUsageFlags usage,
+		const SDL_GPUSampleCount sampleCount,
+		const Uint32 width,
+		const Uint32 height,
+		Uint64 &sizeInBytes
+	) {
+		const SDL_GPUTextureCreateInfo createInfo{
+			.format = format,
+			.usage = usage,
+			.width = width,
+			.height = height,
+			.layer_count_or_depth = 1,
+			.num_levels = 1,
+			.sample_count = sampleCount,
+		};
+		sizeInBytes += CalculateTextureSize(createInfo);
+		return CreateTrackedTexture(device, createInfo, MemoryTag::Rendering, name);
+	}
+
+	float Halton(Uint64 index, const Uint32 base) {
+		float result{};
+		float fraction{1.0f};
+		while (index > 0) {
+			fraction /= static_cast<float>(base);
+			result += fraction * static_cast<float>(index % base);
+			index /= base;
+		}
+		return result;
+	}
+
+	struct TemporalResolveUniforms {
+		glm::vec2 texelSize;
+		float blendFactor;
+		float resetHistory;
+	};
+
+	struct PostProcessAntiAliasingUniforms {
+		glm::vec2 texelSize;
+		float splitPosition;
+		float padding;
+	};
+
+	SDL_GPUGraphicsPipeline *CreateFullscreenPipeline(
+		SDL_GPUDevice *device,
+		const std::string &fragmentShaderFilename,
+		const Uint32 samplerCount,
+		const SDL_GPUTextureFormat targetFormat
+	) {
+		auto vertexShader{LoadShader(device, "Fullscreen.vert", 0, 0, 0, 0)};
+		if (!vertexShader)
+			throw SDLException{"Couldn't load vertex shader"};
+
+		auto fragmentShader{LoadShader(device, fragmentShaderFilename, samplerCount, 1, 0, 0)};
+		if (!fragmentShader)
+			throw SDLException{"Couldn't load fragment shader"};
+
+		std::array colorTargetDescriptions{
+			SDL_GPUColorTargetDescription{
+				.format = targetFormat,
+			},
+		};
+		SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo{
+			.vertex_shader = vertexShader,
+			.fragment_shader = fragmentShader,
+			.target_info = {
+				.color_target_descriptions = colorTargetDescriptions.data(),
+				.num_color_targets = colorTargetDescriptions.size(),
+			},
+		};
+		auto pipeline{SDL_CreateGPUGraphicsPipeline(device, &pipelineCreateInfo)};
+		if (!pipeline)
+			throw SDLException{"Couldn't create GPU graphics pipeline"};
+
+		SDL_ReleaseGPUShader(device, vertexShader);
+		SDL_ReleaseGPUShader(device, fragmentShader);
+
+		return pipeline;
+	}
+
+	SDL_GPUSampler *CreateLinearClampSampler(SDL_GPUDevice *device) {
+		SDL_GPUSamplerCreateInfo samplerCreateInfo{
+			.min_filter = SDL_GPU_FILTER_LINEAR,
+			.mag_filter = SDL_GPU_FILTER_LINEAR,
+			.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+			.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+			.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+			.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		};
+		auto sampler{SDL_CreateGPUSampler(device, &samplerCreateInfo)};
+		if (!sampler)
+			throw SDLException{"Couldn't create GPU sampler"};
+		return sampler;
+	}
+}
+
+std::string_view ToString(const AntiAliasingMode mode) {
+	switch (mode) {
+		case AntiAliasingMode::None: return "None";
+		case AntiAliasingMode::MSAA: return "MSAA";
+		case AntiAliasingMode::TAA: return "TAA";
+		case AntiAliasingMode::FXAA: return "FXAA";
+	}
+	return "Unknown";
+}
+
+AntiAliasingSettings ParseAntiAliasingSettings(const std::span<char *> arguments) {
+	AntiAliasingSettings settings;
+
+	if (const auto value{FindOption(arguments, "aa")}) {
+		if (value == "none")
+			settings.mode = AntiAliasingMode::None;
+		else if (value == "msaa")
+			settings.mode = AntiAliasingMode::MSAA;
+		else if (value == "taa")
+			settings.mode = AntiAliasingMode::TAA;
+		else if (value == "fxaa")
+			settings.mode = AntiAliasingMode::FXAA;
+		else
+			throw UsageError{"Unknown anti-aliasing mode: " + std::string{*value}};
+	}
+
+	if (const auto value{FindOption(arguments, "msaa")}) {
+		if (value == "1")
+			settings.msaaSampleCount = SDL_GPU_SAMPLECOUNT_1;
+		else if (value == "2")
+			settings.msaaSampleCount = SDL_GPU_SAMPLECOUNT_2;
+		else if (value == "4")
+			settings.msaaSampleCount = SDL_GPU_SAMPLECOUNT_4;
+		else if (value == "8")
+			settings.msaaSampleCount = SDL_GPU_SAMPLECOUNT_8;
+		else
+			throw UsageError{"Unsupported MSAA sample count: " + std::string{*value}};
+	}
+
+	return settings;
+}
+
+AntiAliasingMode NextAntiAliasingMode(const AntiAliasingMode mode) {
+	switch (mode) {
+		case AntiAliasingMode::None: return AntiAliasingMode::MSAA;
+		case AntiAliasingMode::MSAA: return AntiAliasingMode::TAA;
+		case AntiAliasingMode::TAA: return AntiAliasingMode::FXAA;
+		case AntiAliasingMode::FXAA: return AntiAliasingMode::None;
+	}
+	return AntiAliasingMode::None;
+}
+
+SDL_GPUSampleCount NextSampleCount(const SDL_GPUSampleCount sampleCount) {
+	switch (sampleCount) {
+		case SDL_GPU_SAMPLECOUNT_1: return SDL_GPU_SAMPLECOUNT_2;
+		case SDL_GPU_SAMPLECOUNT_2: return SDL_GPU_SAMPLECOUNT_4;
+		case SDL_GPU_SAMPLECOUNT_4: return SDL_GPU_SAMPLECOUNT_8;
+		case SDL_GPU_SAMPLECOUNT_8: return SDL_GPU_SAMPLECOUNT_1;
+	}
+	return SDL_GPU_SAMPLECOUNT_1;
+}
+
+SDL_GPUSampleCount ClampSampleCount(
+	SDL_GPUDevice *device,
+	const SDL_GPUTextureFormat colorFormat,
+	const SDL_GPUTextureFormat depthStencilFormat,
+	SDL_GPUSampleCount sampleCount
+) {
+	while (sampleCount != SDL_GPU_SAMPLECOUNT_1 && !(
+		       SDL_GPUTextureSupportsSampleCount(device, colorFormat, sampleCount) &&
+		       SDL_GPUTextureSupportsSampleCount(device, depthStencilFormat, sampleCount)
+	       ))
+		sampleCount = static_cast<SDL_GPUSampleCount>(sampleCount - 1);
+	return sampleCount;
+}
+
+SDL_GPUSampleCount GetSceneSampleCount(const AntiAliasingSettings &settings) {
+	return settings.mode == AntiAliasingMode::MSAA ? settings.msaaSampleCount : SDL_GPU_SAMPLECOUNT_1;
+}
+
+bool HasSceneColorTarget(const AntiAliasingSettings &settings) {
+	return settings.mode == AntiAliasingMode::TAA || settings.mode == AntiAliasingMode::FXAA ||
+	       GetSceneSampleCount(settings) != SDL_GPU_SAMPLECOUNT_1;
+}
+
+RenderTargets CreateRenderTargets(
+	SDL_GPUDevice *device,
+	const AntiAliasingSettings &settings,
+	const SDL_GPUTextureFormat colorFormat,
+	const SDL_GPUTextureFormat depthStencilFormat,
+	const Uint32 width,
+	const Uint32 height,
+	const bool offscreenSceneColor
+) {
+	PROFILE_ZONE("Create Render Targets");
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	RenderTargets renderTargets{
+		.width = width,
+		.height = height,
+	};
+	const auto sampleCount{GetSceneSampleCount(settings)};
+
+	if (settings.mode == AntiAliasingMode::MSAA && sampleCount != SDL_GPU_SAMPLECOUNT_1)
+		renderTargets.color = CreateRenderTarget(device, "MSAA Texture", colorFormat,
+		                                         SDL_GPU_TEXTUREUSAGE_COLOR_TARGET, sampleCount, width, height,
+		                                         renderTargets.sizeInBytes);
+
+	renderTargets.depthStencil = CreateRenderTarget(device, "Depth Stencil Texture", depthStencilFormat,
+	                                                SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET, sampleCount, width,
+	                                                height, renderTargets.sizeInBytes);
+
+	constexpr SDL_GPUTextureUsageFlags usage{SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER};
+	if (settings.mode == AntiAliasingMode::FXAA || (offscreenSceneColor && !HasSceneColorTarget(settings)))
+		renderTargets.color = CreateRenderTarget(device, "Scene Color Texture", colorFormat, usage,
+		                                         SDL_GPU_SAMPLECOUNT_1, width, height, renderTargets.sizeInBytes);
+
+	if (settings.mode == AntiAliasingMode::TAA) {
+		renderTargets.color = CreateRenderTarget(device, "Scene Color Texture", colorFormat, usage,
+		                                         SDL_GPU_SAMPLECOUNT_1, width, height, renderTargets.sizeInBytes);
+		renderTargets.velocity = CreateRenderTarget(device, "Velocity Texture", VelocityFormat, usage,
+		                                            SDL_GPU_SAMPLECOUNT_1, width, height, renderTargets.sizeInBytes);
+		renderTargets.history[0] = CreateRenderTarget(device, "TAA History Texture 0", colorFormat, usage,
+		                                              SDL_GPU_SAMPLECOUNT_1, width, height,
+		                                              renderTargets.sizeInBytes);
+		renderTargets.history[1] = CreateRenderTarget(device, "TAA History Texture 1", colorFormat, usage,
+		                                              SDL_GPU_SAMPLECOUNT_1, width, height,
+		                                              renderTargets.sizeInBytes);
+	}
+
+	std::println("Render targets: {}x{}, {} x{}, {:.1f} MiB", width, height, ToString(settings.mode),
+	             ToSampleCountValue(sampleCount), static_cast<double>(renderTargets.sizeInBytes) / (1024.0 * 1024.0));
+
+	return renderTargets;
+}
+
+void ReleaseRenderTargets(SDL_GPUDevice *device, RenderTargets &renderTargets) {
+	ReleaseTrackedTexture(device, renderTargets.color);
+	ReleaseTrackedTexture(device, renderTargets.depthStencil);
+	ReleaseTrackedTexture(device, renderTargets.velocity);
+	for (auto texture: renderTargets.history)
+		ReleaseTrackedTexture(device, texture);
+	renderTargets = {};
+}
+
+glm::vec2 GetTemporalJitter(const Uint64 frameIndex, const Uint32 width, const Uint32 height) {
+	constexpr Uint64 sequenceLength{8};
+	const auto index{frameIndex % sequenceLength + 1};
+	const glm::vec2 offset{Halton(index, 2) - 0.5f, Halton(index, 3) - 0.5f};
+	return offset * glm::vec2{2.0f / static_cast<float>(width), 2.0f / static_cast<float>(height)};
+}
+
+glm::mat4 GetJitterMatrix(const glm::vec2 jitter) {
+	return translate(glm::mat4{1.0f}, glm::vec3{jitter.x, jitter.y, 0.0f});
+}
+
+TemporalResolve CreateTemporalResolve(SDL_GPUDevice *device, const SDL_GPUTextureFormat colorFormat) {
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	return {
+		.pipeline = CreateFullscreenPipeline(device, "TemporalAA.frag", 3, colorFormat),
+		.sampler = CreateLinearClampSampler(device),
+	};
+}
+
+void ReleaseTemporalResolve(SDL_GPUDevice *device, TemporalResolve &temporalResolve) {
+	SDL_ReleaseGPUGraphicsPipeline(device, temporalResolve.pipeline);
+	SDL_ReleaseGPUSampler(device, temporalResolve.sampler);
+	temporalResolve = {};
+}
+
+SDL_GPUTexture *RecordTemporalResolve(
+	SDL_GPUCommandBuffer *commandBuffer,
+	TemporalResolve &temporalResolve,
+	const RenderTargets &renderTargets
+) {
+	const auto previousHistory{renderTargets.history[temporalResolve.historyIndex]};
+	temporalResolve.historyIndex ^= 1;
+	const auto nextHistory{renderTargets.history[temporalResolve.historyIndex]};
+
+	std::array colorTargets{
+		SDL_GPUColorTargetInfo{
+			.texture = nextHistory,
+			.load_op = SDL_GPU_LOADOP_DONT_CARE,
+			.store_op = SDL_GPU_STOREOP_STORE,
+		}
+	};
+	auto renderPass{SDL_BeginGPURenderPass(commandBuffer, colorTargets.data(), colorTargets.size(), nullptr)};
+
+	SDL_BindGPUGraphicsPipeline(renderPass, temporalResolve.pipeline);
+
+	std::array<SDL_GPUTextureSamplerBinding, 3> textureSamplerBindings{
+		{
+			{renderTargets.color, temporalResolve.sampler},
+			{previousHistory, temporalResolve.sampler},
+			{renderTargets.velocity, temporalResolve.sampler},
+		}
+	};
+	SDL_BindGPUFragmentSamplers(renderPass, 0, textureSamplerBindings.data(), textureSamplerBindings.size());
+
+	const TemporalResolveUniforms uniforms{
+		.texelSize = glm::vec2{1.0f / static_cast<float>(renderTargets.width), 1.0f / static_cast<float>(renderTargets.height)},
+		.blendFactor = 0.1f,
+		.resetHistory = temporalResolve.historyValid ? 0.0f : 1.0f,
+	};
+	SDL_PushGPUFragmentUniformData(commandBuffer, 0, &uniforms, sizeof(uniforms));
+
+	SDL_DrawGPUPrimitives(renderPass, 3, 1, 0, 0);
+
+	SDL_EndGPURenderPass(renderPass);
+
+	temporalResolve.historyValid = true;
+	return nextHistory;
+}
+
+PostProcessAntiAliasing CreatePostProcessAntiAliasing(SDL_GPUDevice *device, const SDL_GPUTextureFormat targetFormat) {
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	return {
+		.pipeline = CreateFullscreenPipeline(device, "FXAA.frag", 1, targetFormat),
+		.sampler = CreateLinearClampSampler(device),
+	};
+}
+
+void ReleasePostProcessAntiAliasing(SDL_GPUDevice *device, PostProcessAntiAliasing &postProcessAntiAliasing) {
+	SDL_ReleaseGPUGraphicsPipeline(device, postProcessAntiAliasing.pipeline);
+	SDL_ReleaseGPUSampler(device, postProcessAntiAliasing.sampler);
+	postProcessAntiAliasing = {};
+}
+
+void RecordPostProcessAntiAliasing(
+	SDL_GPUCommandBuffer *commandBuffer,
+	const PostProcessAntiAliasing &postProcessAntiAliasing,
+	const RenderTargets &renderTargets,
+	SDL_GPUTexture *target,
+	const float splitPosition
+) {
+	std::array colorTargets{
+		SDL_GPUColorTargetInfo{
+			.texture = target,
+			.load_op = SDL_GPU_LOADOP_DONT_CARE,
+			.store_op = SDL_GPU_STOREOP_STORE,
+		}
+	};
+	auto renderPass{SDL_BeginGPURenderPass(commandBuffer, colorTargets.data(), colorTargets.size(), nullptr)};
+
+	SDL_BindGPUGraphicsPipeline(renderPass, postProcessAntiAliasing.pipeline);
+
+	std::array<SDL_GPUTextureSamplerBinding, 1> textureSamplerBindings{
+		{{renderTargets.color, postProcessAntiAliasing.sampler}}
+	};
+	SDL_BindGPUFragmentSamplers(renderPass, 0, textureSamplerBindings.data(), textureSamplerBindings.size());
+
+	const PostProcessAntiAliasingUniforms uniforms{
+		.texelSize = glm::vec2{1.0f / static_cast<float>(renderTargets.width), 1.0f / static_cast<float>(renderTargets.height)},
+		.splitPosition = splitPosition,
+	};
+	SDL_PushGPUFragmentUniformData(commandBuffer, 0, &uniforms, sizeof(uniforms));
+
+	SDL_DrawGPUPrimitives(renderPass, 3, 1, 0, 0);
+
+	SDL_EndGPURenderPass(renderPass);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <string_view>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+enum class AntiAliasingMode {
+	None,
+	MSAA,
+	TAA,
+	FXAA,
+};
+
+constexpr Uint32 AntiAliasingModeCount{4};
+
+struct AntiAliasingSettings {
+	AntiAliasingMode mode{AntiAliasingMode::MSAA};
+	SDL_GPUSampleCount msaaSampleCount{SDL_GPU_SAMPLECOUNT_4};
+	// Left of this normalized X coordinate FXAA shows the scene unfiltered, for side by side comparisons. Kept here
+	// so it survives the FXAA pipeline being recreated.
+	float fxaaSplitPosition{};
+};
+
+std::string_view ToString(AntiAliasingMode mode);
+
+// Reads --aa=none|msaa|taa|fxaa and --msaa=1|2|4|8 from the command line
+AntiAliasingSettings ParseAntiAliasingSettings(std::span<char *> arguments);
+
+AntiAliasingMode NextAntiAliasingMode(AntiAliasingMode mode);
+
+// 1, 2, 4, 8 and back to 1
+SDL_GPUSampleCount NextSampleCount(SDL_GPUSampleCount sampleCount);
+
+// Highest sample count not above the requested one that both formats support
+SDL_GPUSampleCount ClampSampleCount(
+	SDL_GPUDevice *device,
+	SDL_GPUTextureFormat colorFormat,
+	SDL_GPUTextureFormat depthStencilFormat,
+	SDL_GPUSampleCount sampleCount
+);
+
+// Sample count the scene pipeline and its targets are created with
+SDL_GPUSampleCount GetSceneSampleCount(const AntiAliasingSettings &settings);
+
+// Whether the mode renders the scene into RenderTargets::color rather than straight into the swapchain
+bool HasSceneColorTarget(const AntiAliasingSettings &settings);
+
+struct RenderTargets {
+	// MSAA color in MSAA mode, single sample scene color in TAA and FXAA modes or when an offscreen scene color
+	// is requested for split draw lists, unused otherwise (the scene goes straight to the swapchain)
+	SDL_GPUTexture *color{};
+	SDL_GPUTexture *depthStencil{};
+	// TAA only
+	SDL_GPUTexture *velocity{};
+	std::array<SDL_GPUTexture *, 2> history{};
+
+	Uint32 width{};
+	Uint32 height{};
+	Uint64 sizeInBytes{};
+};
+
+RenderTargets CreateRenderTargets(
+	SDL_GPUDevice *device,
+	const AntiAliasingSettings &settings,
+	SDL_GPUTextureFormat colorFormat,
+	SDL_GPUTextureFormat depthStencilFormat,
+	Uint32 width,
+	Uint32 height,
+	bool offscreenSceneColor
+);
+
+void ReleaseRenderTargets(SDL_GPUDevice *device, RenderTargets &renderTargets);
+
+constexpr SDL_GPUTextureFormat VelocityFormat{SDL_GPU_TEXTUREFORMAT_R16G16_FLOAT};
+
+// Sub-pixel offset in NDC units, cycling through a Halton(2, 3) sequence
+glm::vec2 GetTemporalJitter(Uint64 frameIndex, Uint32 width, Uint32 height);
+
+// Offsets clip space positions by the jitter, to be multiplied on the left of a projection matrix
+glm::mat4 GetJitterMatrix(glm::vec2 jitter);
+
+struct TemporalResolve {
+	SDL_GPUGraphicsPipeline *pipeline{};
+	SDL_GPUSampler *sampler{};
+	Uint32 historyIndex{};
+	bool historyValid{};
+};
+
+TemporalResolve CreateTemporalResolve(SDL_GPUDevice *device, SDL_GPUTextureFormat colorFormat);
+
+void ReleaseTemporalResolve(SDL_GPUDevice *device, TemporalResolve &temporalResolve);
+
+// Blends the current scene color into the history and returns the freshly written history texture
+SDL_GPUTexture *RecordTemporalResolve(
+	SDL_GPUCommandBuffer *commandBuffer,
+	TemporalResolve &temporalResolve,
+	const RenderTargets &renderTargets
+);
+
+struct PostProcessAntiAliasing {
+	SDL_GPUGraphicsPipeline *pipeline{};
+	SDL_GPUSampler *sampler{};
+};
+
+PostProcessAntiAliasing CreatePostProcessAntiAliasing(SDL_GPUDevice *device, SDL_GPUTextureFormat targetFormat);
+
+void ReleasePostProcessAntiAliasing(SDL_GPUDevice *device, PostProcessAntiAliasing &postProcessAntiAliasing);
+
+// Single FXAA pass from the scene color into the target
+void RecordPostProcessAntiAliasing(
+	SDL_GPUCommandBuffer *commandBuffer,
+	const PostProcessAntiAliasing &postProcessAntiAliasing,
+	const RenderTargets &renderTargets,
+	SDL_GPUTexture *target,
+	float splitPosition
+);
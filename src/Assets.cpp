@@ -0,0 +1,245 @@
+#include "Assets.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <SDL3_image/SDL_image.h>
+
+#include "assimp/Importer.hpp"
+#include "assimp/postprocess.h"
+#include "assimp/scene.h"
+
+#include "HdrImage.hpp"
+#include "Memory.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+
+std::filesystem::path BasePath;
+
+namespace {
+	struct ShaderCode {
+		std::vector<Uint8> code;
+		std::string entrypoint;
+		SDL_GPUShaderFormat format;
+		SDL_GPUShaderStage stage;
+	};
+
+	ShaderCode ReadShaderCode(SDL_GPUDevice *device, const std::string &shaderFilename) {
+		PROFILE_ZONE("Read Shader");
+		MemoryScope memoryScope{MemoryTag::Assets};
+		SDL_GPUShaderStage stage;
+		if (shaderFilename.contains(".vert"))
+			stage = SDL_GPU_SHADERSTAGE_VERTEX;
+		else if (shaderFilename.contains(".frag"))
+			stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
+		else
+			throw std::runtime_error{"Unrecognized shader stage!"};
+
+		std::filesystem::path fullPath;
+		const SDL_GPUShaderFormat backendFormats{SDL_GetGPUShaderFormats(device)};
+		SDL_GPUShaderFormat format{};
+		std::string entrypoint{"main"};
+
+		if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV) {
+			fullPath = BasePath / "Content/Shaders/Compiled/SPIRV" / (shaderFilename + ".spv");
+			format = SDL_GPU_SHADERFORMAT_SPIRV;
+		} else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL) {
+			fullPath = BasePath / "Content/Shaders/Compiled/MSL" / (shaderFilename + ".msl");
+			format = SDL_GPU_SHADERFORMAT_MSL;
+			entrypoint = "main0";
+		} else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL) {
+			fullPath = BasePath / "Content/Shaders/Compiled/DXIL" / (shaderFilename + ".dxil");
+			format = SDL_GPU_SHADERFORMAT_DXIL;
+		} else throw std::runtime_error{"No supported shader formats available"};
+
+		std::ifstream file{fullPath, std::ios::binary};
+		if (!file)
+			throw std::runtime_error{"Couldn't open shader file"};
+
+		return {
+			.code = {std::istreambuf_iterator(file), {}},
+			.entrypoint = std::move(entrypoint),
+			.format = format,
+			.stage = stage,
+		};
+	}
+
+	struct VertexHash {
+		size_t operator()(const Vertex &vertex) const {
+			const std::array words{
+				std::bit_cast<Uint32>(vertex.position.x), std::bit_cast<Uint32>(vertex.position.y),
+				std::bit_cast<Uint32>(vertex.position.z), std::bit_cast<Uint32>(vertex.uv.x),
+				std::bit_cast<Uint32>(vertex.uv.y),
+			};
+			size_t hash{14695981039346656037ull};
+			for (const auto word: words)
+				hash = (hash ^ word) * 1099511628211ull;
+			return hash;
+		}
+	};
+
+	struct VertexEqual {
+		bool operator()(const Vertex &a, const Vertex &b) const {
+			return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	SDL_GPUShader *CreateShader(
+		SDL_GPUDevice *device,
+		const ShaderCode &shaderCode,
+		const Uint32 samplerCount,
+		const Uint32 uniformBufferCount,
+		const Uint32 storageBufferCount,
+		const Uint32 storageTextureCount
+	) {
+		PROFILE_ZONE("Create Shader");
+		MemoryScope memoryScope{MemoryTag::Assets};
+		const SDL_GPUShaderCreateInfo shaderInfo{
+			.code_size = shaderCode.code.size(),
+			.code = shaderCode.code.data(),
+			.entrypoint = shaderCode.entrypoint.c_str(),
+			.format = shaderCode.format,
+			.stage = shaderCode.stage,
+			.num_samplers = samplerCount,
+			.num_storage_textures = storageTextureCount,
+			.num_storage_buffers = storageBufferCount,
+			.num_uniform_buffers = uniformBufferCount
+		};
+
+		return SDL_CreateGPUShader(device, &shaderInfo);
+	}
+}
+
+SDL_GPUShader *LoadShader(
+	SDL_GPUDevice *device,
+	const std::string &shaderFilename,
+	const Uint32 samplerCount,
+	const Uint32 uniformBufferCount,
+	const Uint32 storageBufferCount,
+	const Uint32 storageTextureCount
+) {
+	return CreateShader(device, ReadShaderCode(device, shaderFilename), samplerCount, uniformBufferCount,
+	                    storageBufferCount, storageTextureCount);
+}
+
+SDL_Surface *LoadImage(const std::string_view imageFilename) {
+	PROFILE_ZONE("Load Image");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	const auto fullPath{BasePath / "Content/Images" / imageFilename};
+	auto result{IMG_Load(fullPath.string().c_str())};
+	if (!result)
+		throw SDLException{"Couldn't load image"};
+	return result;
+}
+
+TextureImage LoadTexture(JobSystem &jobSystem, const std::string_view imageFilename, const TextureUsage usage,
+                         const TextureQuality quality) {
+	PROFILE_ZONE("Load Texture");
+	if (std::filesystem::path{imageFilename}.extension() == ".hdr") {
+		if (usage != TextureUsage::Hdr)
+			throw std::runtime_error{"HDR images can only be loaded as HDR textures"};
+		return CreateTextureImage(LoadHdrImage(BasePath / "Content/Images" / imageFilename));
+	}
+
+	const auto image{LoadImage(imageFilename)};
+	auto result{CreateTextureImage(jobSystem, image, usage, quality)};
+	SDL_DestroySurface(image);
+	return result;
+}
+
+MeshData LoadMesh(const std::string_view modelFilename) {
+	PROFILE_ZONE("Load Mesh");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	const auto fullPath{BasePath / "Content/Models" / modelFilename};
+
+	Assimp::Importer importer;
+	const auto *scene{importer.ReadFile(fullPath.string(), aiProcess_Triangulate)};
+	if (!scene)
+		throw std::runtime_error{"Couldn't load model"};
+
+	MeshData result;
+	size_t vertexCount{};
+	size_t indexCount{};
+	for (size_t i{}; i < scene->mNumMeshes; ++i) {
+		vertexCount += scene->mMeshes[i]->mNumVertices;
+		for (size_t j{}; j < scene->mMeshes[i]->mNumFaces; ++j)
+			indexCount += scene->mMeshes[i]->mFaces[j].mNumIndices;
+	}
+	result.vertices.reserve(vertexCount);
+	result.indices.reserve(indexCount);
+
+	for (size_t i{}; i < scene->mNumMeshes; ++i) {
+		const auto *mesh{scene->mMeshes[i]};
+		const auto baseVertex{static_cast<Uint32>(result.vertices.size())};
+		for (size_t j{}; j < mesh->mNumVertices; ++j) {
+			const auto &vertex{mesh->mVertices[j]};
+			result.vertices.push_back({
+				.position = glm::vec3{vertex.x, vertex.y, vertex.z},
+				.uv = mesh->mTextureCoords[0]
+					      ? glm::vec2{mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y}
+					      : glm::vec2{0.0f, 0.0f},
+			});
+		}
+		for (size_t j{}; j < mesh->mNumFaces; ++j) {
+			const auto &face{mesh->mFaces[j]};
+			for (size_t k{}; k < face.mNumIndices; ++k)
+				result.indices.push_back(baseVertex + face.mIndices[k]);
+		}
+	}
+
+	OptimizeMesh(result);
+	return result;
+}
+
+void OptimizeMesh(MeshData &mesh) {
+	PROFILE_ZONE("Optimize Mesh");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	std::unordered_map<Vertex, Uint32, VertexHash, VertexEqual> uniqueVertices;
+	uniqueVertices.reserve(mesh.vertices.size());
+	std::vector<Vertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+	for (auto &index: mesh.indices) {
+		const auto &vertex{mesh.vertices[index]};
+		const auto [it, isNew]{uniqueVertices.try_emplace(vertex, static_cast<Uint32>(vertices.size()))};
+		if (isNew)
+			vertices.push_back(vertex);
+		index = it->second;
+	}
+	vertices.shrink_to_fit();
+	mesh.vertices = std::move(vertices);
+}
+
+Task<LoadedShader> LoadShaderAsync(
+	JobSystem &jobSystem,
+	SDL_GPUDevice *device,
+	const std::string shaderFilename,
+	const Uint32 samplerCount,
+	const Uint32 uniformBufferCount,
+	const Uint32 storageBufferCount,
+	const Uint32 storageTextureCount
+) {
+	co_await ScheduleOn{jobSystem};
+	const auto shaderCode{ReadShaderCode(device, shaderFilename)};
+	co_await ResumeOnMainThread{jobSystem};
+	const auto shader{
+		CreateShader(device, shaderCode, samplerCount, uniformBufferCount, storageBufferCount, storageTextureCount)
+	};
+	if (!shader)
+		throw SDLException{"Couldn't create shader " + shaderFilename};
+	co_return LoadedShader{device, shader};
+}
+
+Task<TextureImage> LoadTextureAsync(JobSystem &jobSystem, const std::string imageFilename, const TextureUsage usage,
+                                    const TextureQuality quality) {
+	co_await ScheduleOn{jobSystem};
+	co_return LoadTexture(jobSystem, imageFilename, usage, quality);
+}
+
+Task<MeshData> LoadMeshAsync(JobSystem &jobSystem, const std::string modelFilename) {
+	co_await ScheduleOn{jobSystem};
+	co_return LoadMesh(modelFilename);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+#include "Task.hpp"
+#include "TextureConversion.hpp"
+
+extern std::filesystem::path BasePath;
+
+struct Vertex {
+	glm::vec3 position;
+	glm::vec2 uv;
+};
+
+struct MeshData {
+	std::vector<Vertex> vertices;
+	std::vector<Uint32> indices;
+};
+
+SDL_GPUShader *LoadShader(
+	SDL_GPUDevice *device,
+	const std::string &shaderFilename,
+	Uint32 samplerCount,
+	Uint32 uniformBufferCount,
+	Uint32 storageBufferCount,
+	Uint32 storageTextureCount
+);
+
+// Decoded in the pixel format the file stores, with as many channels and bits as it has
+SDL_Surface *LoadImage(std::string_view imageFilename);
+
+// An image converted to the texture format of its usage, Radiance .hdr images need TextureUsage::Hdr
+TextureImage LoadTexture(JobSystem &jobSystem, std::string_view imageFilename, TextureUsage usage,
+                         TextureQuality quality = TextureQuality::Full);
+
+// All meshes in the file merged into one vertex and index list, optimized with OptimizeMesh
+MeshData LoadMesh(std::string_view modelFilename);
+
+// Merges identical vertices and orders the remaining ones by first use, so the vertex fetches of a draw walk memory
+// forward. Vertices no index refers to are dropped.
+void OptimizeMesh(MeshData &mesh);
+
+// Asynchronous versions of the loaders above, file I/O and decoding run on the job system. Arguments are taken by
+// value since they have to outlive the caller's suspension.
+
+// A shader with the device that created it, so WhenAll can release it when a task awaited along with it fails
+struct LoadedShader {
+	SDL_GPUDevice *device;
+	SDL_GPUShader *shader;
+};
+
+template<>
+struct DiscardTaskResult<LoadedShader> {
+	void operator()(const LoadedShader &loaded) const noexcept { SDL_ReleaseGPUShader(loaded.device, loaded.shader); }
+};
+
+// Reads the shader code on a job system thread and creates the shader back on the main thread, throws when creating it
+// fails
+Task<LoadedShader> LoadShaderAsync(
+	JobSystem &jobSystem,
+	SDL_GPUDevice *device,
+	std::string shaderFilename,
+	Uint32 samplerCount,
+	Uint32 uniformBufferCount,
+	Uint32 storageBufferCount,
+	Uint32 storageTextureCount
+);
+
+Task<TextureImage> LoadTextureAsync(JobSystem &jobSystem, std::string imageFilename, TextureUsage usage,
+                                    TextureQuality quality = TextureQuality::Full);
+
+Task<MeshData> LoadMeshAsync(JobSystem &jobSystem, std::string modelFilename);
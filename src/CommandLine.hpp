@@ -0,0 +1,56 @@
+#pragma once
+
+#include <charconv>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <SDL3/SDL.h>
+
+// A malformed command line option, main reports it and exits instead of crashing
+class UsageError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+// Value of the last --name=value argument, if any
+inline std::optional<std::string_view> FindOption(const std::span<char *> arguments, const std::string_view name) {
+	std::optional<std::string_view> result;
+	for (const std::string_view argument: arguments)
+		if (argument.starts_with("--") && argument.substr(2).starts_with(name) &&
+		    argument.substr(2 + name.size()).starts_with('='))
+			result = argument.substr(3 + name.size());
+	return result;
+}
+
+// Whether a bare --name flag was passed
+inline bool HasFlag(const std::span<char *> arguments, const std::string_view name) {
+	for (const std::string_view argument: arguments)
+		if (argument.starts_with("--") && argument.substr(2) == name)
+			return true;
+	return false;
+}
+
+// The whole value as a decimal number in [min, max], throws a UsageError naming the option otherwise
+inline Uint64 ParseUnsigned(const std::string_view name, const std::string_view value, const Uint64 min = 0,
+                            const Uint64 max = std::numeric_limits<Uint64>::max()) {
+	Uint64 result{};
+	const auto [end, error]{std::from_chars(value.data(), value.data() + value.size(), result)};
+	if (error != std::errc{} || end != value.data() + value.size() || result < min || result > max)
+		throw UsageError{
+			"--" + std::string{name} + " expects a number from " + std::to_string(min) + " to " + std::to_string(max) +
+			", got: " + std::string{value}
+		};
+	return result;
+}
+
+// Value of --name=N as a number in [min, max], if passed
+template<typename T = Uint32>
+std::optional<T> FindUnsignedOption(const std::span<char *> arguments, const std::string_view name, const T min = 0,
+                                    const T max = std::numeric_limits<T>::max()) {
+	if (const auto value{FindOption(arguments, name)})
+		return static_cast<T>(ParseUnsigned(name, *value, min, max));
+	return std::nullopt;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+struct LocalTransform {
+	glm::vec3 position{0.0f};
+	glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+	glm::vec3 scale{1.0f};
+};
+
+// Last frame's matrix is kept for motion vectors
+struct WorldTransform {
+	glm::mat4 matrix{1.0f};
+	glm::mat4 previousMatrix{1.0f};
+};
+
+// Node in the TransformHierarchy holding the entity's local transform. Systems changing the local transform through
+// it declare write access to this component.
+struct TransformNode {
+	Uint32 node;
+};
+
+struct Spin {
+	glm::vec3 axis;
+	float radiansPerSecond;
+};
+
+struct MeshInstance {
+	Uint32 indexCount;
+	Uint32 firstIndex;
+	Sint32 vertexOffset;
+};
+
+inline glm::mat4 ToMatrix(const LocalTransform &transform) {
+	return scale(translate(glm::mat4{1.0f}, transform.position) * mat4_cast(transform.rotation), transform.scale);
+}
@@ -0,0 +1,30 @@
+#include "Culling.hpp"
+
+Frustum ExtractFrustum(const glm::mat4 &projectionView) {
+	const auto row{
+		[&projectionView](const int i) {
+			return glm::vec4{projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]};
+		}
+	};
+
+	// The near plane is the one of a -1 to 1 depth range, which contains the 0 to 1 one
+	Frustum frustum{
+		.planes = {
+			row(3) + row(0),
+			row(3) - row(0),
+			row(3) + row(1),
+			row(3) - row(1),
+			row(3) + row(2),
+			row(3) - row(2),
+		},
+	};
+	for (auto &plane: frustum.planes)
+		plane /= length(glm::vec3{plane});
+	return frustum;
+}
+
+void CullSpheres(const Frustum &frustum, const std::span<const BoundingSphere> spheres, std::vector<Uint32> &visible) {
+	for (size_t i{}; i < spheres.size(); ++i)
+		if (IsVisible(frustum, spheres[i]))
+			visible.push_back(static_cast<Uint32>(i));
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+struct BoundingSphere {
+	glm::vec3 center;
+	float radius;
+};
+
+// Planes as (normal, distance) with the normals pointing inside
+struct Frustum {
+	std::array<glm::vec4, 6> planes;
+};
+
+Frustum ExtractFrustum(const glm::mat4 &projectionView);
+
+inline bool IsVisible(const Frustum &frustum, const BoundingSphere &sphere) {
+	for (const auto &plane: frustum.planes)
+		if (dot(glm::vec3{plane}, sphere.center) + plane.w < -sphere.radius)
+			return false;
+	return true;
+}
+
+// Appends the indices of the spheres at least partly inside the frustum
+void CullSpheres(const Frustum &frustum, std::span<const BoundingSphere> spheres, std::vector<Uint32> &visible);
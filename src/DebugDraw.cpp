@@ -0,0 +1,191 @@
+#include "DebugDraw.hpp"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <numbers>
+
+#include "Memory.hpp"
+#include "Profiler.hpp"
+
+namespace {
+	constexpr Uint32 SphereSegmentCount{24};
+	constexpr Uint32 MinVertexCapacity{1024};
+
+	std::atomic_bool isDebugDrawEnabled;
+
+	// Only appended to by its own thread, only read and cleared by Record
+	struct DebugDrawThreadBuffer {
+		std::vector<DebugVertex> vertices;
+	};
+
+	struct DebugDrawRegistry {
+		std::mutex mutex;
+		std::vector<std::unique_ptr<DebugDrawThreadBuffer>> buffers;
+	};
+
+	// Never destroyed, like the profiler's registry
+	DebugDrawRegistry &GetRegistry() {
+		static const auto registry{new DebugDrawRegistry};
+		return *registry;
+	}
+
+	std::vector<DebugVertex> &GetThreadVertices() {
+		thread_local const auto buffer{
+			[] {
+				MemoryScope memoryScope{MemoryTag::General};
+				auto &registry{GetRegistry()};
+				std::lock_guard lock{registry.mutex};
+				return registry.buffers.emplace_back(std::make_unique<DebugDrawThreadBuffer>()).get();
+			}()
+		};
+		return buffer->vertices;
+	}
+
+	void AppendLine(std::vector<DebugVertex> &vertices, const glm::vec3 from, const glm::vec3 to, const Uint32 color) {
+		vertices.push_back({from, color});
+		vertices.push_back({to, color});
+	}
+}
+
+void SetDebugDrawEnabled(const bool isEnabled) {
+	isDebugDrawEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+bool IsDebugDrawEnabled() {
+	return isDebugDrawEnabled.load(std::memory_order_relaxed);
+}
+
+void DebugDrawLine(const glm::vec3 from, const glm::vec3 to, const Uint32 color) {
+	if (!IsDebugDrawEnabled())
+		return;
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	AppendLine(GetThreadVertices(), from, to, color);
+}
+
+void DebugDrawAabb(const glm::vec3 min, const glm::vec3 max, const Uint32 color) {
+	if (!IsDebugDrawEnabled())
+		return;
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	auto &vertices{GetThreadVertices()};
+	// Corner i takes x from bit 0, y from bit 1 and z from bit 2
+	auto corner{
+		[&](const int index) {
+			return glm::vec3{index & 1 ? max.x : min.x, index & 2 ? max.y : min.y, index & 4 ? max.z : min.z};
+		}
+	};
+	for (auto index{0}; index < 8; ++index)
+		for (const auto axis: {1, 2, 4})
+			if (!(index & axis))
+				AppendLine(vertices, corner(index), corner(index | axis), color);
+}
+
+void DebugDrawSphere(const BoundingSphere &sphere, const Uint32 color) {
+	if (!IsDebugDrawEnabled())
+		return;
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	auto &vertices{GetThreadVertices()};
+	std::array<glm::vec2, SphereSegmentCount + 1> circle;
+	for (Uint32 segment{}; segment <= SphereSegmentCount; ++segment) {
+		const auto angle{2.0f * std::numbers::pi_v<float> * static_cast<float>(segment) / SphereSegmentCount};
+		circle[segment] = glm::vec2{std::cos(angle), std::sin(angle)} * sphere.radius;
+	}
+	for (Uint32 segment{}; segment < SphereSegmentCount; ++segment) {
+		const auto from{circle[segment]};
+		const auto to{circle[segment + 1]};
+		AppendLine(vertices, sphere.center + glm::vec3{from, 0.0f}, sphere.center + glm::vec3{to, 0.0f}, color);
+		AppendLine(vertices, sphere.center + glm::vec3{from.x, 0.0f, from.y}, sphere.center + glm::vec3{to.x, 0.0f, to.y},
+		           color);
+		AppendLine(vertices, sphere.center + glm::vec3{0.0f, from}, sphere.center + glm::vec3{0.0f, to}, color);
+	}
+}
+
+void DebugDrawFrustum(const glm::mat4 &projectionView, const Uint32 color) {
+	if (!IsDebugDrawEnabled())
+		return;
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	auto &vertices{GetThreadVertices()};
+	const auto inverseProjectionView{inverse(projectionView)};
+	std::array<glm::vec3, 8> corners;
+	for (auto index{0}; index < 8; ++index) {
+		const glm::vec4 clip{index & 1 ? 1.0f : -1.0f, index & 2 ? 1.0f : -1.0f, index & 4 ? 1.0f : -1.0f, 1.0f};
+		const auto world{inverseProjectionView * clip};
+		corners[index] = glm::vec3{world} / world.w;
+	}
+	for (auto index{0}; index < 8; ++index)
+		for (const auto axis: {1, 2, 4})
+			if (!(index & axis))
+				AppendLine(vertices, corners[index], corners[index | axis], color);
+}
+
+void DebugDrawAxes(const glm::mat4 &transform, const float size) {
+	if (!IsDebugDrawEnabled())
+		return;
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	auto &vertices{GetThreadVertices()};
+	const glm::vec3 origin{transform[3]};
+	AppendLine(vertices, origin, origin + glm::vec3{transform[0]} * size, DebugColor::Red);
+	AppendLine(vertices, origin, origin + glm::vec3{transform[1]} * size, DebugColor::Green);
+	AppendLine(vertices, origin, origin + glm::vec3{transform[2]} * size, DebugColor::Blue);
+}
+
+DebugDrawRenderer::DebugDrawRenderer(SDL_GPUDevice *device, const SDL_GPUTextureFormat targetFormat)
+	: device{device}, vertexBuffer{device, sizeof(DebugVertex), MinVertexCapacity, "Debug Draw Vertices"} {
+	constexpr SDL_GPUVertexBufferDescription vertexBufferDescription{
+		.slot = 0,
+		.pitch = sizeof(DebugVertex),
+		.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+	};
+	constexpr std::array<SDL_GPUVertexAttribute, 2> vertexAttributes{
+		{
+			{0, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, offsetof(DebugVertex, position)},
+			{1, 0, SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM, offsetof(DebugVertex, color)},
+		}
+	};
+	pipeline = CreateOverlayPipeline(device, targetFormat, "PositionColorTransform.vert", "SolidColor.frag", 0,
+	                                 vertexBufferDescription, vertexAttributes, SDL_GPU_PRIMITIVETYPE_LINELIST);
+}
+
+DebugDrawRenderer::~DebugDrawRenderer() {
+	Release();
+}
+
+void DebugDrawRenderer::Record(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target,
+                               const glm::mat4 &projectionView) {
+	PROFILE_ZONE("Record Debug Draw");
+	vertices.clear();
+	{
+		auto &registry{GetRegistry()};
+		std::lock_guard lock{registry.mutex};
+		for (const auto &buffer: registry.buffers) {
+			vertices.insert(vertices.end(), buffer->vertices.begin(), buffer->vertices.end());
+			buffer->vertices.clear();
+		}
+	}
+	const auto vertexCount{static_cast<Uint32>(vertices.size())};
+	lineCount = vertexCount / 2;
+	if (!vertexCount)
+		return;
+
+	vertexBuffer.Reserve(vertexCount);
+	// Both buffers are cycled, earlier frames may still read last frame's lines
+	vertexBuffer.Upload(commandBuffer, vertices.data(), 0, vertexCount, true);
+
+	auto renderPass{BeginOverlayPass(commandBuffer, target, pipeline, vertexBuffer.Get())};
+	SDL_PushGPUVertexUniformData(commandBuffer, 0, &projectionView, sizeof(projectionView));
+	SDL_DrawGPUPrimitives(renderPass, vertexCount, 1, 0, 0);
+	SDL_EndGPURenderPass(renderPass);
+}
+
+Uint32 DebugDrawRenderer::GetLineCount() const {
+	return lineCount;
+}
+
+void DebugDrawRenderer::Release() {
+	SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+	vertexBuffer.Release();
+	pipeline = nullptr;
+	lineCount = 0;
+}
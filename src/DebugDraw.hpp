@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+#include "Culling.hpp"
+#include "OverlayRendering.hpp"
+
+// Immediate-mode debug lines in world space, callable from any thread. Every thread appends to its own buffer without
+// locking, the buffers are gathered once per frame by DebugDrawRenderer::Record and drawn in a single draw call. All
+// calls cost one branch while debug drawing is disabled.
+void SetDebugDrawEnabled(bool isEnabled);
+
+[[nodiscard]] bool IsDebugDrawEnabled();
+
+// Colors are RGBA with red in the lowest byte
+namespace DebugColor {
+	constexpr Uint32 Red{0xff0000ff};
+	constexpr Uint32 Green{0xff00ff00};
+	constexpr Uint32 Blue{0xffff0000};
+	constexpr Uint32 Yellow{0xff00ffff};
+	constexpr Uint32 White{0xffffffff};
+}
+
+void DebugDrawLine(glm::vec3 from, glm::vec3 to, Uint32 color);
+
+void DebugDrawAabb(glm::vec3 min, glm::vec3 max, Uint32 color);
+
+// Three circles around the axes
+void DebugDrawSphere(const BoundingSphere &sphere, Uint32 color);
+
+// Edges of the volume the projection view matrix maps into clip space
+void DebugDrawFrustum(const glm::mat4 &projectionView, Uint32 color);
+
+// The transform's x, y and z axes in red, green and blue
+void DebugDrawAxes(const glm::mat4 &transform, float size);
+
+struct DebugVertex {
+	glm::vec3 position;
+	Uint32 color;
+};
+
+class DebugDrawRenderer {
+public:
+	DebugDrawRenderer(SDL_GPUDevice *device, SDL_GPUTextureFormat targetFormat);
+
+	~DebugDrawRenderer();
+
+	DebugDrawRenderer(const DebugDrawRenderer &) = delete;
+
+	DebugDrawRenderer &operator=(const DebugDrawRenderer &) = delete;
+
+	// Takes the lines of every thread and draws them over the target's content without depth testing. No other thread
+	// may draw at the same time, lines drawn by jobs have to be waited for first.
+	void Record(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target, const glm::mat4 &projectionView);
+
+	[[nodiscard]] Uint32 GetLineCount() const;
+
+	// Has to happen before the device is destroyed
+	void Release();
+
+private:
+	SDL_GPUDevice *device;
+	SDL_GPUGraphicsPipeline *pipeline{};
+
+	std::vector<DebugVertex> vertices;
+	OverlayVertexBuffer vertexBuffer;
+	Uint32 lineCount{};
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+// The printable ASCII characters of SDL's built-in debug font, each Size pixels square. RasterizeDebugFont draws them in
+// this order.
+namespace DebugFont {
+	constexpr char FirstCharacter{' '};
+	constexpr char LastCharacter{'~'};
+	constexpr Uint32 GlyphCount{LastCharacter - FirstCharacter + 1};
+	constexpr int Size{SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE};
+}
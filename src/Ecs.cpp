@@ -0,0 +1,217 @@
+#include "Ecs.hpp"
+
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#include "Memory.hpp"
+#include "Profiler.hpp"
+
+namespace {
+	// Registration is serialized, a slot is written once before its id is handed out through GetComponentId's static,
+	// whose initialization every other thread synchronizes with
+	std::mutex registrationMutex;
+	std::array<ComponentInfo, MaxComponentTypes> componentTypes{};
+	Uint32 componentTypeCount{};
+
+	size_t AlignUp(const size_t value, const size_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+Uint32 RegisterComponentType(const ComponentInfo info) {
+	std::lock_guard lock{registrationMutex};
+	if (componentTypeCount == MaxComponentTypes)
+		throw std::runtime_error{"Too many component types"};
+	componentTypes[componentTypeCount] = info;
+	return componentTypeCount++;
+}
+
+const ComponentInfo &GetComponentInfo(const Uint32 componentId) {
+	return componentTypes[componentId];
+}
+
+Archetype::Archetype(const ComponentMask mask) : mask{mask} {
+	auto rowSize{sizeof(Entity)};
+	for (auto bits{mask}; bits; bits &= bits - 1)
+		rowSize += GetComponentInfo(std::countr_zero(bits)).size;
+
+	// Start from the unpadded estimate and shrink until the arrays fit with their alignment padding
+	for (capacity = static_cast<Uint32>(ChunkSize / rowSize); capacity > 0; --capacity) {
+		size_t offset{capacity * sizeof(Entity)};
+		for (auto bits{mask}; bits; bits &= bits - 1) {
+			const auto componentId{static_cast<Uint32>(std::countr_zero(bits))};
+			const auto &info{GetComponentInfo(componentId)};
+			offset = AlignUp(offset, info.alignment);
+			offsets[componentId] = static_cast<Uint32>(offset);
+			offset += capacity * info.size;
+		}
+		if (offset <= ChunkSize)
+			break;
+	}
+	if (capacity == 0)
+		throw std::runtime_error{"Components don't fit in a chunk"};
+}
+
+std::pair<Uint32, Uint32> Archetype::Allocate(const Entity entity) {
+	MemoryScope memoryScope{MemoryTag::Ecs};
+	if (chunks.empty() || chunks.back().count == capacity)
+		chunks.push_back({.storage = std::make_unique<ChunkStorage>(), .count = 0});
+
+	auto &chunk{chunks.back()};
+	const auto row{chunk.count++};
+	GetEntities(chunk)[row] = entity;
+	return {static_cast<Uint32>(chunks.size() - 1), row};
+}
+
+std::optional<Entity> Archetype::Remove(const Uint32 chunkIndex, const Uint32 row) {
+	auto &last{chunks.back()};
+	const auto lastRow{last.count - 1};
+	auto &chunk{chunks[chunkIndex]};
+
+	std::optional<Entity> moved;
+	if (&chunk != &last || row != lastRow) {
+		moved = GetEntities(last)[lastRow];
+		GetEntities(chunk)[row] = *moved;
+		for (auto bits{mask}; bits; bits &= bits - 1) {
+			const auto componentId{static_cast<Uint32>(std::countr_zero(bits))};
+			const auto size{GetComponentInfo(componentId).size};
+			std::memcpy(GetComponents(chunk, componentId) + row * size,
+			            GetComponents(last, componentId) + lastRow * size, size);
+		}
+	}
+
+	if (--last.count == 0)
+		chunks.pop_back();
+	return moved;
+}
+
+void World::Destroy(const Entity entity) {
+	if (!IsAlive(entity))
+		return;
+
+	auto &record{records[entity.index]};
+	RemoveRow(*record.archetype, record.chunk, record.row);
+	record.archetype = nullptr;
+	++record.generation;
+	freeIndices.push_back(entity.index);
+	--entityCount;
+}
+
+bool World::IsAlive(const Entity entity) const {
+	return entity.index < records.size() && records[entity.index].archetype &&
+	       records[entity.index].generation == entity.generation;
+}
+
+World::EntityRecord &World::GetRecord(const Entity entity) {
+	if (!IsAlive(entity))
+		throw std::runtime_error{"Entity isn't alive"};
+	return records[entity.index];
+}
+
+Archetype &World::GetArchetype(const ComponentMask mask) {
+	MemoryScope memoryScope{MemoryTag::Ecs};
+	auto &archetype{archetypes[mask]};
+	if (!archetype)
+		archetype = std::make_unique<Archetype>(mask);
+	return *archetype;
+}
+
+Entity World::CreateEntity(Archetype &archetype) {
+	MemoryScope memoryScope{MemoryTag::Ecs};
+	Uint32 index;
+	if (freeIndices.empty()) {
+		index = static_cast<Uint32>(records.size());
+		records.push_back({});
+	} else {
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+
+	auto &record{records[index]};
+	const Entity entity{index, record.generation};
+	const auto [chunk, row]{archetype.Allocate(entity)};
+	record.archetype = &archetype;
+	record.chunk = chunk;
+	record.row = row;
+	++entityCount;
+	return entity;
+}
+
+void *World::GetComponent(const Entity entity, const Uint32 componentId) {
+	const auto &record{GetRecord(entity)};
+	if (!(record.archetype->GetMask() & ComponentMask{1} << componentId))
+		throw std::runtime_error{"Entity doesn't have the component"};
+
+	const auto &chunk{record.archetype->GetChunks()[record.chunk]};
+	return record.archetype->GetComponents(chunk, componentId) + record.row * GetComponentInfo(componentId).size;
+}
+
+void World::MoveToArchetype(const Entity entity, Archetype &target) {
+	auto &record{records[entity.index]};
+	auto &source{*record.archetype};
+	const auto &sourceChunk{source.GetChunks()[record.chunk]};
+
+	const auto [chunk, row]{target.Allocate(entity)};
+	const auto &targetChunk{target.GetChunks()[chunk]};
+	for (auto bits{source.GetMask() & target.GetMask()}; bits; bits &= bits - 1) {
+		const auto componentId{static_cast<Uint32>(std::countr_zero(bits))};
+		const auto size{GetComponentInfo(componentId).size};
+		std::memcpy(target.GetComponents(targetChunk, componentId) + row * size,
+		            source.GetComponents(sourceChunk, componentId) + record.row * size, size);
+	}
+
+	RemoveRow(source, record.chunk, record.row);
+	record.archetype = &target;
+	record.chunk = chunk;
+	record.row = row;
+}
+
+void World::RemoveRow(Archetype &archetype, const Uint32 chunk, const Uint32 row) {
+	if (const auto moved{archetype.Remove(chunk, row)}) {
+		records[moved->index].chunk = chunk;
+		records[moved->index].row = row;
+	}
+}
+
+void SystemSchedule::Add(std::string name, const SystemAccess access, System system) {
+	MemoryScope memoryScope{MemoryTag::Ecs};
+	// Run after the last stage holding a conflicting system, so conflicting systems keep the order they were added in
+	Uint32 stage{};
+	for (const auto &scheduled: systems)
+		if (scheduled.access.ConflictsWith(access))
+			stage = std::max(stage, scheduled.stage + 1);
+
+	systems.push_back({
+		.name = std::move(name),
+		.access = access,
+		.system = std::move(system),
+		.stage = stage,
+	});
+	stageCount = std::max(stageCount, stage + 1);
+}
+
+void SystemSchedule::Run(World &world, JobSystem &jobSystem) {
+	for (Uint32 stage{}; stage < stageCount; ++stage) {
+		JobCounter counter;
+		ScheduledSystem *inlineSystem{};
+		for (auto &scheduled: systems) {
+			if (scheduled.stage != stage)
+				continue;
+			// The calling thread runs one system of the stage itself
+			if (!inlineSystem)
+				inlineSystem = &scheduled;
+			else
+				jobSystem.Run([&scheduled, &world, &jobSystem] {
+					PROFILE_ZONE(scheduled.name.c_str());
+					scheduled.system(world, jobSystem);
+				}, &counter);
+		}
+		if (inlineSystem) {
+			PROFILE_ZONE(inlineSystem->name.c_str());
+			inlineSystem->system(world, jobSystem);
+		}
+		jobSystem.Wait(counter);
+	}
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "JobSystem.hpp"
+
+using ComponentMask = Uint64;
+
+constexpr Uint32 MaxComponentTypes{64};
+
+struct Entity {
+	Uint32 index;
+	Uint32 generation;
+
+	bool operator==(const Entity &) const = default;
+};
+
+struct ComponentInfo {
+	size_t size;
+	size_t alignment;
+};
+
+Uint32 RegisterComponentType(ComponentInfo info);
+
+// Infos sit in a fixed array that registering never moves, so looking one up takes no lock
+const ComponentInfo &GetComponentInfo(Uint32 componentId);
+
+// Components are plain data, they're relocated with memcpy when an entity changes archetype
+template<typename T>
+Uint32 GetComponentId() {
+	// Const only marks read access in queries, it's the same component
+	if constexpr (std::is_const_v<T>)
+		return GetComponentId<std::remove_const_t<T>>();
+	else {
+		static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+		              "Components must be trivially copyable and destructible");
+		static const Uint32 id{RegisterComponentType({sizeof(T), alignof(T)})};
+		return id;
+	}
+}
+
+template<typename... Ts>
+ComponentMask GetComponentMask() {
+	return ((ComponentMask{1} << GetComponentId<Ts>()) | ... | ComponentMask{});
+}
+
+// All entities with exactly the same set of component types. They're stored in fixed size chunks holding one array
+// per component type, so iterating a component touches contiguous memory only.
+class Archetype {
+public:
+	static constexpr size_t ChunkSize{16 * 1024};
+
+	struct alignas(64) ChunkStorage {
+		std::byte bytes[ChunkSize];
+	};
+
+	struct Chunk {
+		std::unique_ptr<ChunkStorage> storage;
+		Uint32 count;
+	};
+
+	explicit Archetype(ComponentMask mask);
+
+	[[nodiscard]] ComponentMask GetMask() const { return mask; }
+
+	[[nodiscard]] Uint32 GetChunkCapacity() const { return capacity; }
+
+	[[nodiscard]] std::span<Chunk> GetChunks() { return chunks; }
+
+	[[nodiscard]] Entity *GetEntities(const Chunk &chunk) const {
+		return reinterpret_cast<Entity *>(chunk.storage->bytes);
+	}
+
+	[[nodiscard]] std::byte *GetComponents(const Chunk &chunk, const Uint32 componentId) const {
+		return chunk.storage->bytes + offsets[componentId];
+	}
+
+	template<typename T>
+	[[nodiscard]] T *GetComponents(const Chunk &chunk) const {
+		return reinterpret_cast<T *>(GetComponents(chunk, GetComponentId<T>()));
+	}
+
+	// Appends a row with uninitialized components, returns its chunk and row
+	std::pair<Uint32, Uint32> Allocate(Entity entity);
+
+	// Fills the hole with the last row, returns the entity that moved into it (if any)
+	std::optional<Entity> Remove(Uint32 chunkIndex, Uint32 row);
+
+private:
+	ComponentMask mask;
+	Uint32 capacity{};
+	std::array<Uint32, MaxComponentTypes> offsets{};
+	std::vector<Chunk> chunks;
+};
+
+class World {
+public:
+	template<typename... Ts>
+	Entity Create(const Ts &... components) {
+		const auto entity{CreateEntity(GetArchetype(GetComponentMask<Ts...>()))};
+		(Set(entity, components), ...);
+		return entity;
+	}
+
+	void Destroy(Entity entity);
+
+	[[nodiscard]] bool IsAlive(Entity entity) const;
+
+	[[nodiscard]] Uint32 GetEntityCount() const { return entityCount; }
+
+	// False for destroyed entities
+	template<typename T>
+	[[nodiscard]] bool Has(const Entity entity) const {
+		return IsAlive(entity) && records[entity.index].archetype->GetMask() & GetComponentMask<T>();
+	}
+
+	template<typename T>
+	[[nodiscard]] T &Get(const Entity entity) {
+		return *static_cast<T *>(GetComponent(entity, GetComponentId<T>()));
+	}
+
+	// Adds the component or overwrites the existing one, throws for destroyed entities
+	template<typename T>
+	void Set(const Entity entity, const T &component) {
+		const auto mask{GetRecord(entity).archetype->GetMask()};
+		if (!(mask & GetComponentMask<T>()))
+			MoveToArchetype(entity, GetArchetype(mask | GetComponentMask<T>()));
+		Get<T>(entity) = component;
+	}
+
+	// Does nothing for destroyed entities, like Destroy
+	template<typename T>
+	void Remove(const Entity entity) {
+		if (!IsAlive(entity))
+			return;
+		const auto mask{records[entity.index].archetype->GetMask()};
+		if (mask & GetComponentMask<T>())
+			MoveToArchetype(entity, GetArchetype(mask & ~GetComponentMask<T>()));
+	}
+
+	// Calls function(std::span<Ts>...) once per chunk of every archetype having all of Ts, const types are read only.
+	// Entities can't be created, destroyed or change components while iterating.
+	template<typename... Ts, typename Function>
+	void ForEachChunk(Function &&function) {
+		const auto mask{GetComponentMask<Ts...>()};
+		for (auto &[archetypeMask, archetype]: archetypes) {
+			if ((archetypeMask & mask) != mask)
+				continue;
+			for (auto &chunk: archetype->GetChunks())
+				function(std::span<Ts>{archetype->template GetComponents<Ts>(chunk), chunk.count}...);
+		}
+	}
+
+	template<typename... Ts, typename Function>
+	void ForEach(Function &&function) {
+		ForEachChunk<Ts...>([&function](std::span<Ts>... components) {
+			const auto count{std::get<0>(std::tie(components...)).size()};
+			for (size_t i{}; i < count; ++i)
+				function(components[i]...);
+		});
+	}
+
+	// Like ForEach with chunks spread over the job system
+	template<typename... Ts, typename Function>
+	void ParallelForEach(JobSystem &jobSystem, Function &&function) {
+		const auto mask{GetComponentMask<Ts...>()};
+		size_t chunkCount{};
+		for (auto &[archetypeMask, archetype]: archetypes)
+			if ((archetypeMask & mask) == mask)
+				chunkCount += archetype->GetChunks().size();
+
+		// A few ranges per thread balances the load without paying for a job per chunk
+		const auto grainSize{std::max<size_t>(1, chunkCount / (jobSystem.GetThreadCount() * 8))};
+		JobCounter counter;
+		for (auto &[archetypeMask, archetype]: archetypes) {
+			if ((archetypeMask & mask) != mask)
+				continue;
+			const auto chunkTotal{static_cast<Uint32>(archetype->GetChunks().size())};
+			for (Uint32 begin{}; begin < chunkTotal; begin += static_cast<Uint32>(grainSize)) {
+				const auto end{std::min(begin + static_cast<Uint32>(grainSize), chunkTotal)};
+				// Small enough for the inline storage of JobSystem::Function, so scheduling doesn't allocate
+				jobSystem.Run([archetype = archetype.get(), &function, begin, end] {
+					for (const auto &chunk: archetype->GetChunks().subspan(begin, end - begin)) {
+						auto components{std::tuple{archetype->template GetComponents<Ts>(chunk)...}};
+						for (Uint32 row{}; row < chunk.count; ++row)
+							std::apply([&function, row](auto *... arrays) { function(arrays[row]...); }, components);
+					}
+				}, &counter);
+			}
+		}
+		jobSystem.Wait(counter);
+	}
+
+private:
+	struct EntityRecord {
+		Archetype *archetype;
+		Uint32 chunk;
+		Uint32 row;
+		Uint32 generation;
+	};
+
+	// Throws for destroyed entities instead of following their null archetype
+	EntityRecord &GetRecord(Entity entity);
+
+	Archetype &GetArchetype(ComponentMask mask);
+
+	Entity CreateEntity(Archetype &archetype);
+
+	void *GetComponent(Entity entity, Uint32 componentId);
+
+	// Copies the components both archetypes have, components only the target has are left uninitialized
+	void MoveToArchetype(Entity entity, Archetype &target);
+
+	void RemoveRow(Archetype &archetype, Uint32 chunk, Uint32 row);
+
+	std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> archetypes;
+	std::vector<EntityRecord> records;
+	std::vector<Uint32> freeIndices;
+	Uint32 entityCount{};
+};
+
+// Components a system reads and writes, used to find systems that can run at the same time
+struct SystemAccess {
+	ComponentMask reads;
+	ComponentMask writes;
+
+	// Const component types are read, the others written
+	template<typename... Ts>
+	static SystemAccess Of() {
+		return {
+			.reads = ((std::is_const_v<Ts> ? GetComponentMask<Ts>() : ComponentMask{}) | ... | ComponentMask{}),
+			.writes = ((std::is_const_v<Ts> ? ComponentMask{} : GetComponentMask<Ts>()) | ... | ComponentMask{}),
+		};
+	}
+
+	[[nodiscard]] bool ConflictsWith(const SystemAccess &other) const {
+		return (writes & (other.reads | other.writes)) || (reads & other.writes);
+	}
+};
+
+// Systems behave as if they ran in the order they were added, but each one is placed in the earliest stage after all
+// the systems it conflicts with, and the systems of a stage run concurrently on the job system
+class SystemSchedule {
+public:
+	using System = std::move_only_function<void(World &, JobSystem &)>;
+
+	void Add(std::string name, SystemAccess access, System system);
+
+	// Adds a system calling function(Ts &...) for every entity having all of Ts
+	template<typename... Ts, typename Function>
+	void AddForEach(std::string name, Function function) {
+		Add(std::move(name), SystemAccess::Of<Ts...>(),
+		    [function = std::move(function)](World &world, JobSystem &jobSystem) {
+			    world.ParallelForEach<Ts...>(jobSystem, function);
+		    });
+	}
+
+	void Run(World &world, JobSystem &jobSystem);
+
+private:
+	struct ScheduledSystem {
+		std::string name;
+		SystemAccess access;
+		System system;
+		Uint32 stage;
+	};
+
+	std::vector<ScheduledSystem> systems;
+	Uint32 stageCount{};
+};
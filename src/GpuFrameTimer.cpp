@@ -0,0 +1,113 @@
+#include "GpuFrameTimer.hpp"
+
+#include <algorithm>
+
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+
+GpuFrameTimer::GpuFrameTimer(SDL_GPUDevice *device, const Uint32 statsCount) : device{device}, stats(statsCount) {
+	thread = std::thread{&GpuFrameTimer::WaitLoop, this};
+}
+
+GpuFrameTimer::~GpuFrameTimer() {
+	Stop();
+}
+
+void GpuFrameTimer::Submit(SDL_GPUCommandBuffer *commandBuffer, const Uint64 frameBegin,
+                           CompletionCallback onComplete, const Uint32 statsMask) {
+	const auto fence{SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer)};
+	if (!fence)
+		throw SDLException{"Couldn't submit GPU command buffer"};
+
+	{
+		std::lock_guard lock{mutex};
+		pendingFrames.push_back({fence, frameBegin, SDL_GetPerformanceCounter(), statsMask, std::move(onComplete)});
+	}
+	frameSubmitted.notify_one();
+}
+
+GpuFrameStats GpuFrameTimer::TakeStats(const Uint32 statsIndex) {
+	std::lock_guard lock{mutex};
+	auto result{stats.at(statsIndex)};
+	result.latest = latest;
+	stats[statsIndex] = {};
+	return result;
+}
+
+GpuFrameStats GpuFrameTimer::GetStats(const Uint32 statsIndex) {
+	std::lock_guard lock{mutex};
+	auto result{stats.at(statsIndex)};
+	result.latest = latest;
+	return result;
+}
+
+GpuFrameTiming GpuFrameTimer::GetLatestTiming() {
+	std::lock_guard lock{mutex};
+	return latest;
+}
+
+void GpuFrameTimer::Stop() {
+	{
+		std::lock_guard lock{mutex};
+		stopping = true;
+	}
+	frameSubmitted.notify_one();
+	if (thread.joinable())
+		thread.join();
+}
+
+void GpuFrameTimer::WaitLoop() {
+	SetProfilerThreadName("GPU");
+	const auto ticksPerMillisecond{static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0};
+	const auto toMilliseconds{
+		[ticksPerMillisecond](const Uint64 ticks) { return static_cast<double>(ticks) / ticksPerMillisecond; }
+	};
+
+	std::unique_lock lock{mutex};
+	while (true) {
+		frameSubmitted.wait(lock, [this] { return stopping || !pendingFrames.empty(); });
+		// Frames still in flight are waited for even when stopping, their fences have to be released
+		if (pendingFrames.empty())
+			return;
+		auto frame{std::move(pendingFrames.front())};
+		lock.unlock();
+
+		// Frames complete in submission order, so waiting for the oldest one is enough
+		const auto isSignaled{SDL_WaitForGPUFences(device, true, &frame.fence, 1)};
+		const auto completion{SDL_GetPerformanceCounter()};
+		SDL_ReleaseGPUFence(device, frame.fence);
+
+		const auto gpuStart{std::max(frame.submitted, previousCompletion)};
+		const auto busyUntil{std::clamp(previousCompletion, frame.frameBegin, frame.submitted)};
+		const GpuFrameTiming timing{
+			.cpuTime = toMilliseconds(frame.submitted - frame.frameBegin),
+			.gpuTime = toMilliseconds(completion - gpuStart),
+			.submitToComplete = toMilliseconds(completion - frame.submitted),
+			.overlap = toMilliseconds(busyUntil - frame.frameBegin),
+			.isGpuBound = previousCompletion > frame.submitted,
+		};
+		previousCompletion = completion;
+		if (isSignaled)
+			GetProfilerThreadBuffer().Record("GPU Frame", gpuStart, completion);
+		if (frame.onComplete)
+			frame.onComplete(isSignaled);
+
+		lock.lock();
+		pendingFrames.pop_front();
+		if (!isSignaled)
+			continue;
+		latest = timing;
+		for (Uint32 i{}; i < stats.size(); ++i) {
+			if (!(frame.statsMask >> i & 1))
+				continue;
+			auto &sums{stats[i]};
+			++sums.frameCount;
+			sums.gpuBoundFrameCount += timing.isGpuBound;
+			sums.cpuTime += timing.cpuTime;
+			sums.gpuTime += timing.gpuTime;
+			sums.maxGpuTime = std::max(sums.maxGpuTime, timing.gpuTime);
+			sums.submitToComplete += timing.submitToComplete;
+			sums.overlap += timing.overlap;
+		}
+	}
+}
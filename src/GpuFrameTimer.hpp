@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+
+// Timings of one frame, in milliseconds
+struct GpuFrameTiming {
+	// From the start of the frame on the CPU to its submission
+	double cpuTime;
+	// From when the GPU could start the frame, its submission or the previous frame's completion, to its completion
+	double gpuTime;
+	double submitToComplete;
+	// Part of the CPU time during which the GPU was still busy with the previous frame
+	double overlap;
+	// Submitted while the previous frame was still running, so the GPU and not the CPU set the pace
+	bool isGpuBound;
+};
+
+// Sums over the frames completed since the previous TakeStats
+struct GpuFrameStats {
+	Uint32 frameCount;
+	Uint32 gpuBoundFrameCount;
+	double cpuTime;
+	double gpuTime;
+	double maxGpuTime;
+	double submitToComplete;
+	double overlap;
+	GpuFrameTiming latest;
+};
+
+constexpr Uint32 AllGpuFrameStats{~0u};
+
+// Submits each frame's last command buffer with a fence and waits for the fences on a background thread, so frame
+// completion is timed without ever blocking the main loop. GPU frames also show up on their own track in traces.
+// Completed frames are summed into statsCount independent stats, so reports taking their stats at different times don't
+// reset each other's.
+class GpuFrameTimer {
+public:
+	// Runs on the timer's thread once the frame completed, or with false if waiting for it failed
+	using CompletionCallback = std::move_only_function<void(bool completed)>;
+
+	explicit GpuFrameTimer(SDL_GPUDevice *device, Uint32 statsCount = 1);
+
+	~GpuFrameTimer();
+
+	GpuFrameTimer(const GpuFrameTimer &) = delete;
+
+	GpuFrameTimer &operator=(const GpuFrameTimer &) = delete;
+
+	// frameBegin is the SDL_GetPerformanceCounter value when the frame's CPU work started, the frame is only summed into
+	// the stats whose bit is set in statsMask
+	void Submit(SDL_GPUCommandBuffer *commandBuffer, Uint64 frameBegin, CompletionCallback onComplete = {},
+	            Uint32 statsMask = AllGpuFrameStats);
+
+	GpuFrameStats TakeStats(Uint32 statsIndex = 0);
+
+	// Leaves the stats alone
+	GpuFrameStats GetStats(Uint32 statsIndex = 0);
+
+	// The most recently completed frame, leaves the stats alone
+	GpuFrameTiming GetLatestTiming();
+
+	// Waits for the submitted frames, runs their callbacks and releases their fences, has to happen before the device is
+	// destroyed
+	void Stop();
+
+private:
+	struct PendingFrame {
+		SDL_GPUFence *fence;
+		Uint64 frameBegin;
+		Uint64 submitted;
+		Uint32 statsMask;
+		CompletionCallback onComplete;
+	};
+
+	void WaitLoop();
+
+	SDL_GPUDevice *device;
+	std::thread thread;
+
+	std::mutex mutex;
+	std::condition_variable frameSubmitted;
+	std::deque<PendingFrame> pendingFrames;
+	bool stopping{};
+
+	Uint64 previousCompletion{};
+	std::vector<GpuFrameStats> stats;
+	GpuFrameTiming latest{};
+};
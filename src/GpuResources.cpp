@@ -0,0 +1,192 @@
+#include "GpuResources.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "SDLException.hpp"
+
+Uint64 CalculateTextureSize(const SDL_GPUTextureCreateInfo &createInfo) {
+	const auto isVolume{createInfo.type == SDL_GPU_TEXTURETYPE_3D};
+	Uint64 size{};
+	for (Uint32 level{}; level < createInfo.num_levels; ++level) {
+		const auto width{std::max(createInfo.width >> level, 1u)};
+		const auto height{std::max(createInfo.height >> level, 1u)};
+		const auto depth{isVolume ? std::max(createInfo.layer_count_or_depth >> level, 1u) : 1u};
+		size += SDL_CalculateGPUTextureFormatSize(createInfo.format, width, height, depth);
+	}
+	if (!isVolume)
+		size *= createInfo.layer_count_or_depth;
+	return size * (Uint64{1} << createInfo.sample_count);
+}
+
+SDL_GPUTexture *CreateTrackedTexture(SDL_GPUDevice *device, const SDL_GPUTextureCreateInfo &createInfo,
+                                     const MemoryTag tag, const char *name) {
+	auto texture{SDL_CreateGPUTexture(device, &createInfo)};
+	if (!texture)
+		throw SDLException{"Couldn't create GPU texture"};
+	SDL_SetGPUTextureName(device, texture, name);
+	TrackGpuResource(texture, {
+		                 .name = name,
+		                 .tag = tag,
+		                 .kind = GpuResourceKind::Texture,
+		                 .sizeInBytes = CalculateTextureSize(createInfo),
+		                 .format = createInfo.format,
+		                 .width = createInfo.width,
+		                 .height = createInfo.height,
+		                 .layerCountOrDepth = createInfo.layer_count_or_depth,
+		                 .levelCount = createInfo.num_levels,
+		                 .sampleCount = createInfo.sample_count,
+	                 });
+	return texture;
+}
+
+void ReleaseTrackedTexture(SDL_GPUDevice *device, SDL_GPUTexture *texture) {
+	UntrackGpuResource(texture);
+	SDL_ReleaseGPUTexture(device, texture);
+}
+
+SDL_GPUBuffer *CreateTrackedBuffer(SDL_GPUDevice *device, const SDL_GPUBufferCreateInfo &createInfo,
+                                   const MemoryTag tag, const char *name) {
+	auto buffer{SDL_CreateGPUBuffer(device, &createInfo)};
+	if (!buffer)
+		throw SDLException{"Couldn't create GPU buffer"};
+	SDL_SetGPUBufferName(device, buffer, name);
+	TrackGpuResource(buffer, {
+		                 .name = name,
+		                 .tag = tag,
+		                 .kind = GpuResourceKind::Buffer,
+		                 .sizeInBytes = createInfo.size,
+	                 });
+	return buffer;
+}
+
+void ReleaseTrackedBuffer(SDL_GPUDevice *device, SDL_GPUBuffer *buffer) {
+	UntrackGpuResource(buffer);
+	SDL_ReleaseGPUBuffer(device, buffer);
+}
+
+SDL_GPUTransferBuffer *CreateTrackedTransferBuffer(SDL_GPUDevice *device,
+                                                   const SDL_GPUTransferBufferCreateInfo &createInfo,
+                                                   const MemoryTag tag, const char *name) {
+	auto transferBuffer{SDL_CreateGPUTransferBuffer(device, &createInfo)};
+	if (!transferBuffer)
+		throw SDLException{"Couldn't create GPU transfer buffer"};
+	TrackGpuResource(transferBuffer, {
+		                 .name = name,
+		                 .tag = tag,
+		                 .kind = GpuResourceKind::TransferBuffer,
+		                 .sizeInBytes = createInfo.size,
+	                 });
+	return transferBuffer;
+}
+
+void ReleaseTrackedTransferBuffer(SDL_GPUDevice *device, SDL_GPUTransferBuffer *transferBuffer) {
+	UntrackGpuResource(transferBuffer);
+	SDL_ReleaseGPUTransferBuffer(device, transferBuffer);
+}
+
+std::string_view ToString(const SDL_GPUTextureFormat format) {
+	switch (format) {
+		case SDL_GPU_TEXTUREFORMAT_A8_UNORM: return "A8";
+		case SDL_GPU_TEXTUREFORMAT_R8_UNORM: return "R8";
+		case SDL_GPU_TEXTUREFORMAT_R8G8_UNORM: return "RG8";
+		case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM: return "RGBA8";
+		case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM: return "BGRA8";
+		case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB: return "RGBA8 sRGB";
+		case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB: return "BGRA8 sRGB";
+		case SDL_GPU_TEXTUREFORMAT_R10G10B10A2_UNORM: return "RGB10A2";
+		case SDL_GPU_TEXTUREFORMAT_R16_UNORM: return "R16";
+		case SDL_GPU_TEXTUREFORMAT_R16G16_FLOAT: return "RG16F";
+		case SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT: return "RGBA16F";
+		case SDL_GPU_TEXTUREFORMAT_R11G11B10_UFLOAT: return "R11G11B10F";
+		case SDL_GPU_TEXTUREFORMAT_R32_FLOAT: return "R32F";
+		case SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT: return "RGBA32F";
+		case SDL_GPU_TEXTUREFORMAT_D16_UNORM: return "D16";
+		case SDL_GPU_TEXTUREFORMAT_D24_UNORM: return "D24";
+		case SDL_GPU_TEXTUREFORMAT_D32_FLOAT: return "D32F";
+		case SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT: return "D24S8";
+		case SDL_GPU_TEXTUREFORMAT_D32_FLOAT_S8_UINT: return "D32FS8";
+		default: return "Other";
+	}
+}
+
+std::vector<GpuMemoryGroup> GetGpuMemoryGroups() {
+	std::vector<GpuMemoryGroup> groups;
+	std::unordered_map<std::string_view, size_t> groupIndices;
+	const auto resources{GetGpuResources()};
+	for (const auto &resource: resources) {
+		const auto [it, isNew]{groupIndices.try_emplace(resource.name, groups.size())};
+		if (isNew)
+			groups.push_back({.name = resource.name});
+		auto &group{groups[it->second]};
+		++group.resourceCount;
+		group.sizeInBytes += resource.sizeInBytes;
+		if (resource.sizeInBytes >= group.largest.sizeInBytes)
+			group.largest = resource;
+	}
+	std::ranges::sort(groups, std::ranges::greater{}, &GpuMemoryGroup::sizeInBytes);
+	return groups;
+}
+
+std::string DescribeGpuResource(const GpuResourceInfo &info) {
+	if (info.kind != GpuResourceKind::Texture)
+		return std::string{ToString(info.kind)};
+	auto description{std::format("{}x{}", info.width, info.height)};
+	if (info.layerCountOrDepth > 1)
+		description += std::format("x{}", info.layerCountOrDepth);
+	description += std::format(" {}", ToString(info.format));
+	if (info.levelCount > 1)
+		description += std::format(" {} mips", info.levelCount);
+	if (info.sampleCount != SDL_GPU_SAMPLECOUNT_1)
+		description += std::format(" {}x MSAA", 1u << info.sampleCount);
+	return description;
+}
+
+void WriteGpuMemoryCsv(const std::filesystem::path &path) {
+	std::ofstream file{path};
+	if (!file)
+		throw std::runtime_error{"Couldn't open " + path.string()};
+	file << "name,kind,tag,count,bytes,format,width,height,layers_or_depth,levels,samples\n";
+	for (const auto &[name, resourceCount, sizeInBytes, largest]: GetGpuMemoryGroups()) {
+		std::string quotedName;
+		for (const auto character: name)
+			quotedName += character == '"' ? std::string{"\"\""} : std::string{character};
+		file << std::format("\"{}\",{},{},{},{}", quotedName, ToString(largest.kind), ToString(largest.tag),
+		                    resourceCount, sizeInBytes);
+		if (largest.kind == GpuResourceKind::Texture)
+			file << std::format(",{},{},{},{},{},{}\n", ToString(largest.format), largest.width, largest.height,
+			                    largest.layerCountOrDepth, largest.levelCount, 1u << largest.sampleCount);
+		else
+			file << ",,,,,,\n";
+	}
+	if (!file)
+		throw std::runtime_error{"Couldn't write " + path.string()};
+}
+
+std::string FormatGpuMemoryReport(const size_t lineCount) {
+	const auto groups{GetGpuMemoryGroups()};
+	Uint64 totalBytes{};
+	Uint32 resourceCount{};
+	for (const auto &group: groups) {
+		totalBytes += group.sizeInBytes;
+		resourceCount += group.resourceCount;
+	}
+
+	auto report{std::format("GPU memory {} in {} resources\n", FormatBytes(totalBytes), resourceCount)};
+	for (size_t i{}; i < std::min(lineCount, groups.size()); ++i) {
+		const auto &group{groups[i]};
+		const auto name{group.resourceCount > 1 ? std::format("{} x{}", group.name, group.resourceCount) : group.name};
+		report += std::format("{:>10} {:<28} {}\n", FormatBytes(group.sizeInBytes), name,
+		                      DescribeGpuResource(group.largest));
+	}
+	if (groups.size() > lineCount) {
+		Uint64 restBytes{};
+		for (auto i{lineCount}; i < groups.size(); ++i)
+			restBytes += groups[i].sizeInBytes;
+		report += std::format("{:>10} {} more\n", FormatBytes(restBytes), groups.size() - lineCount);
+	}
+	return report;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "Memory.hpp"
+
+// GPU resource creation that names the resource and registers its size with the memory tracking. Resources created
+// this way have to be released with the matching function, releasing null is fine.
+
+SDL_GPUTexture *CreateTrackedTexture(SDL_GPUDevice *device, const SDL_GPUTextureCreateInfo &createInfo, MemoryTag tag,
+                                     const char *name);
+
+void ReleaseTrackedTexture(SDL_GPUDevice *device, SDL_GPUTexture *texture);
+
+SDL_GPUBuffer *CreateTrackedBuffer(SDL_GPUDevice *device, const SDL_GPUBufferCreateInfo &createInfo, MemoryTag tag,
+                                   const char *name);
+
+void ReleaseTrackedBuffer(SDL_GPUDevice *device, SDL_GPUBuffer *buffer);
+
+SDL_GPUTransferBuffer *CreateTrackedTransferBuffer(SDL_GPUDevice *device,
+                                                   const SDL_GPUTransferBufferCreateInfo &createInfo, MemoryTag tag,
+                                                   const char *name);
+
+void ReleaseTrackedTransferBuffer(SDL_GPUDevice *device, SDL_GPUTransferBuffer *transferBuffer);
+
+// Size of a texture with all of its layers, mip levels and samples
+Uint64 CalculateTextureSize(const SDL_GPUTextureCreateInfo &createInfo);
+
+// Short names like "RGBA8" or "D24S8"
+std::string_view ToString(SDL_GPUTextureFormat format);
+
+// Live GPU resources sharing a name, like the lifetimes of a buffer that grew
+struct GpuMemoryGroup {
+	std::string name;
+	Uint32 resourceCount{};
+	Uint64 sizeInBytes{};
+	// The largest resource of the group
+	GpuResourceInfo largest;
+};
+
+// Grouped by name, the largest total first
+std::vector<GpuMemoryGroup> GetGpuMemoryGroups();
+
+// Dimensions, format, mips and samples of a texture, e.g. "3840x2160 BGRA8 4x MSAA", or the kind of a buffer
+std::string DescribeGpuResource(const GpuResourceInfo &info);
+
+// One row per group with its total and the shape of its largest resource
+void WriteGpuMemoryCsv(const std::filesystem::path &path);
+
+// The total and the lineCount largest groups as aligned text, for an overlay
+std::string FormatGpuMemoryReport(size_t lineCount);
@@ -0,0 +1,144 @@
+#include "HdrImage.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Profiler.hpp"
+
+namespace {
+	using Rgbe = std::array<Uint8, 4>;
+
+	class Reader {
+	public:
+		Reader(const std::vector<Uint8> &data, const std::string &name) : data{data}, name{name} {
+		}
+
+		std::string_view ReadLine() {
+			const auto begin{position};
+			while (position < data.size() && data[position] != '\n')
+				++position;
+			if (position == data.size())
+				Fail("header ends early");
+			return {reinterpret_cast<const char *>(data.data()) + begin, position++ - begin};
+		}
+
+		Uint8 ReadByte() {
+			if (position == data.size())
+				Fail("pixels end early");
+			return data[position++];
+		}
+
+		Rgbe ReadRgbe() {
+			return {ReadByte(), ReadByte(), ReadByte(), ReadByte()};
+		}
+
+		[[noreturn]] void Fail(const std::string_view reason) const {
+			throw std::runtime_error{"Couldn't read " + name + ": " + std::string{reason}};
+		}
+
+	private:
+		const std::vector<Uint8> &data;
+		const std::string &name;
+		size_t position{};
+	};
+
+	// Scanlines of 8 to 32767 pixels may store each channel run-length encoded, starting with 2, 2 and the width
+	void ReadScanline(Reader &reader, std::vector<Rgbe> &scanline) {
+		const auto width{static_cast<Uint32>(scanline.size())};
+		const auto first{reader.ReadRgbe()};
+		if (width < 8 || width > 0x7fff || first[0] != 2 || first[1] != 2 || first[2] & 0x80) {
+			// Flat pixels, where 1, 1, 1 repeats the previous pixel in the old run-length encoding
+			auto pixel{first};
+			Uint32 shift{};
+			for (Uint32 x{};;) {
+				if (pixel[0] == 1 && pixel[1] == 1 && pixel[2] == 1) {
+					const auto count{static_cast<Uint32>(pixel[3]) << shift};
+					if (x == 0 || count > width - x)
+						reader.Fail("run outside a scanline");
+					for (Uint32 i{}; i < count; ++i, ++x)
+						scanline[x] = scanline[x - 1];
+					// Longer chains can't fit in a scanline anyway
+					shift = std::min(shift + 8, 24u);
+				} else {
+					scanline[x++] = pixel;
+					shift = 0;
+				}
+				if (x == width)
+					return;
+				pixel = reader.ReadRgbe();
+			}
+		}
+
+		if ((static_cast<Uint32>(first[2]) << 8 | first[3]) != width)
+			reader.Fail("scanline width doesn't match the image");
+		for (Uint32 channel{}; channel < 4; ++channel)
+			for (Uint32 x{}; x < width;) {
+				auto count{static_cast<Uint32>(reader.ReadByte())};
+				const auto isRun{count > 128};
+				if (isRun)
+					count -= 128;
+				if (count == 0 || count > width - x)
+					reader.Fail("run past the end of a scanline");
+				if (isRun) {
+					const auto value{reader.ReadByte()};
+					for (Uint32 i{}; i < count; ++i)
+						scanline[x++][channel] = value;
+				} else
+					for (Uint32 i{}; i < count; ++i)
+						scanline[x++][channel] = reader.ReadByte();
+			}
+	}
+}
+
+HdrImage LoadHdrImage(const std::filesystem::path &path) {
+	PROFILE_ZONE("Load HDR Image");
+	const auto name{path.string()};
+	std::ifstream file{path, std::ios::binary};
+	if (!file)
+		throw std::runtime_error{"Couldn't open " + name};
+	const std::vector<Uint8> data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+	Reader reader{data, name};
+
+	const auto signature{reader.ReadLine()};
+	if (signature != "#?RADIANCE" && signature != "#?RGBE")
+		reader.Fail("not a Radiance image");
+	while (true) {
+		const auto line{reader.ReadLine()};
+		if (line.empty())
+			break;
+		if (line.starts_with("FORMAT=") && line != "FORMAT=32-bit_rle_rgbe")
+			reader.Fail("only RGBE pixels are supported, not " + std::string{line.substr(7)});
+	}
+
+	HdrImage image;
+	const std::string resolution{reader.ReadLine()};
+	char heightAxis[3]{}, widthAxis[3]{};
+	if (std::sscanf(resolution.c_str(), "%2s %u %2s %u", heightAxis, &image.height, widthAxis, &image.width) != 4 ||
+	    std::string_view{heightAxis} != "-Y" || std::string_view{widthAxis} != "+X")
+		reader.Fail("only top to bottom, left to right images are supported");
+	if (!image.width || !image.height)
+		reader.Fail("empty image");
+
+	image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+	std::vector<Rgbe> scanline(image.width);
+	auto pixel{image.pixels.data()};
+	for (Uint32 y{}; y < image.height; ++y) {
+		ReadScanline(reader, scanline);
+		for (const auto &[r, g, b, exponent]: scanline) {
+			// The mantissas share the exponent, offset by 128 and the 8 bits of the mantissa
+			const auto scale{exponent ? std::ldexp(1.0f, exponent - 136) : 0.0f};
+			*pixel++ = static_cast<float>(r) * scale;
+			*pixel++ = static_cast<float>(g) * scale;
+			*pixel++ = static_cast<float>(b) * scale;
+			*pixel++ = 1.0f;
+		}
+	}
+	return image;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <SDL3/SDL.h>
+
+// Linear RGBA floats, alpha is always 1. The same layout as an R32G32B32A32_FLOAT texture.
+struct HdrImage {
+	std::vector<float> pixels;
+	Uint32 width{};
+	Uint32 height{};
+};
+
+// Reads a Radiance RGBE image (.hdr) with flat or run-length encoded scanlines, stored top to bottom
+HdrImage LoadHdrImage(const std::filesystem::path &path);
@@ -0,0 +1,53 @@
+#include "Headless.hpp"
+
+#include <string>
+
+#include "CommandLine.hpp"
+#include "GpuResources.hpp"
+#include "SDLException.hpp"
+
+std::optional<HeadlessSettings> ParseHeadlessSettings(const std::span<char *> arguments) {
+	if (!HasFlag(arguments, "headless"))
+		return std::nullopt;
+
+	HeadlessSettings settings;
+	if (const auto value{FindOption(arguments, "headless-size")}) {
+		const auto separator{value->find('x')};
+		if (separator == std::string_view::npos)
+			throw UsageError{"--headless-size must be WIDTHxHEIGHT: " + std::string{*value}};
+		constexpr Uint32 MaxSize{16384};
+		settings.width = static_cast<Uint32>(ParseUnsigned("headless-size", value->substr(0, separator), 1, MaxSize));
+		settings.height = static_cast<Uint32>(ParseUnsigned("headless-size", value->substr(separator + 1), 1, MaxSize));
+	}
+	if (const auto value{FindUnsignedOption(arguments, "headless-frames", 1u)})
+		settings.frameCount = *value;
+	if (const auto value{FindOption(arguments, "headless-output")})
+		settings.outputDirectory = std::filesystem::path{*value};
+	return settings;
+}
+
+OffscreenTarget CreateOffscreenTarget(SDL_GPUDevice *device, const Uint32 width, const Uint32 height,
+                                      const SDL_GPUTextureFormat format) {
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	const SDL_GPUTextureCreateInfo textureCreateInfo{
+		.format = format,
+		.usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		.width = width,
+		.height = height,
+		.layer_count_or_depth = 1,
+		.num_levels = 1,
+	};
+	OffscreenTarget target{
+		.texture = CreateTrackedTexture(device, textureCreateInfo, MemoryTag::Rendering, "Offscreen Target"),
+		.width = width,
+		.height = height,
+	};
+	if (!target.texture)
+		throw SDLException{"Couldn't create offscreen target"};
+	return target;
+}
+
+void ReleaseOffscreenTarget(SDL_GPUDevice *device, OffscreenTarget &target) {
+	ReleaseTrackedTexture(device, target.texture);
+	target = {};
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <SDL3/SDL.h>
+
+constexpr SDL_GPUTextureFormat OffscreenFormat{SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM};
+
+struct HeadlessSettings {
+	Uint32 width{800};
+	Uint32 height{600};
+	// Frames rendered before exiting, unless a stress scene decides
+	Uint32 frameCount{1};
+	// Every frame is read back and written there as frame-N.png when set
+	std::optional<std::filesystem::path> outputDirectory;
+};
+
+// Set when --headless was passed, --headless-size=WxH, --headless-frames=N and --headless-output=directory override the
+// defaults
+std::optional<HeadlessSettings> ParseHeadlessSettings(std::span<char *> arguments);
+
+// Stands in for the swapchain when rendering without a window, or when a frame is read back since swapchain textures
+// aren't guaranteed to support downloads
+struct OffscreenTarget {
+	SDL_GPUTexture *texture{};
+	Uint32 width{};
+	Uint32 height{};
+};
+
+OffscreenTarget CreateOffscreenTarget(SDL_GPUDevice *device, Uint32 width, Uint32 height,
+                                      SDL_GPUTextureFormat format = OffscreenFormat);
+
+void ReleaseOffscreenTarget(SDL_GPUDevice *device, OffscreenTarget &target);
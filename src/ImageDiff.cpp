@@ -0,0 +1,117 @@
+#include "ImageDiff.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "Simd.hpp"
+
+namespace {
+	constexpr int DiffScaleShift{3};
+
+	struct RowDiff {
+		Uint64 squaredError;
+		Uint8 maxError;
+	};
+
+	void DiffPixelsScalar(const Uint8 *a, const Uint8 *b, Uint8 *diff, const size_t byteCount, RowDiff &result) {
+		for (size_t i{}; i < byteCount; ++i) {
+			const auto isAlpha{i % 4 == 3};
+			const auto error{isAlpha ? 0 : std::abs(a[i] - b[i])};
+			result.squaredError += static_cast<Uint64>(error * error);
+			result.maxError = std::max(result.maxError, static_cast<Uint8>(error));
+			if (diff)
+				diff[i] = isAlpha ? 255 : static_cast<Uint8>(std::min(error << DiffScaleShift, 255));
+		}
+	}
+
+	// 16 bytes, four pixels, per iteration. The rest goes through the scalar loop.
+	void DiffPixels(const Uint8 *a, const Uint8 *b, Uint8 *diff, const size_t byteCount, RowDiff &result) {
+		size_t i{};
+#if defined(ENGINE_SSE2)
+		const auto colorMask{_mm_set1_epi32(0x00FFFFFF)};
+		const auto alpha{_mm_set1_epi32(static_cast<int>(0xFF000000))};
+		const auto zero{_mm_setzero_si128()};
+		auto maxError{zero};
+		auto squaredError{zero};
+		for (; i + 16 <= byteCount; i += 16) {
+			const auto va{_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i))};
+			const auto vb{_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))};
+			// Unsigned absolute difference, one of the saturating subtractions is zero
+			const auto error{_mm_and_si128(_mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va)), colorMask)};
+			maxError = _mm_max_epu8(maxError, error);
+
+			const auto low{_mm_unpacklo_epi8(error, zero)};
+			const auto high{_mm_unpackhi_epi8(error, zero)};
+			// Two squares of at most 255 each per 32-bit lane, widened before they can add up to an overflow
+			const auto sums{_mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high))};
+			squaredError = _mm_add_epi64(squaredError, _mm_unpacklo_epi32(sums, zero));
+			squaredError = _mm_add_epi64(squaredError, _mm_unpackhi_epi32(sums, zero));
+
+			if (diff) {
+				auto scaled{error};
+				for (int shift{}; shift < DiffScaleShift; ++shift)
+					scaled = _mm_adds_epu8(scaled, scaled);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(diff + i), _mm_or_si128(scaled, alpha));
+			}
+		}
+
+		alignas(16) Uint8 maxErrors[16];
+		_mm_store_si128(reinterpret_cast<__m128i *>(maxErrors), maxError);
+		result.maxError = std::max(result.maxError, *std::ranges::max_element(maxErrors));
+		alignas(16) Uint64 squaredErrors[2];
+		_mm_store_si128(reinterpret_cast<__m128i *>(squaredErrors), squaredError);
+		result.squaredError += squaredErrors[0] + squaredErrors[1];
+#elif defined(ENGINE_NEON)
+		const auto colorMask{vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF))};
+		const auto alpha{vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000))};
+		auto maxError{vdupq_n_u8(0)};
+		auto squaredError{vdupq_n_u64(0)};
+		for (; i + 16 <= byteCount; i += 16) {
+			const auto error{vandq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i)), colorMask)};
+			maxError = vmaxq_u8(maxError, error);
+
+			// Pairwise widening adds keep the sums from overflowing
+			squaredError = vpadalq_u32(squaredError, vpaddlq_u16(vmull_u8(vget_low_u8(error), vget_low_u8(error))));
+			squaredError = vpadalq_u32(squaredError, vpaddlq_u16(vmull_high_u8(error, error)));
+
+			if (diff) {
+				auto scaled{error};
+				for (int shift{}; shift < DiffScaleShift; ++shift)
+					scaled = vqaddq_u8(scaled, scaled);
+				vst1q_u8(diff + i, vorrq_u8(scaled, alpha));
+			}
+		}
+		result.maxError = std::max(result.maxError, vmaxvq_u8(maxError));
+		result.squaredError += vaddvq_u64(squaredError);
+#endif
+		DiffPixelsScalar(a + i, b + i, diff ? diff + i : nullptr, byteCount - i, result);
+	}
+}
+
+ImageDiffResult DiffImages(const SDL_Surface *a, const SDL_Surface *b, SDL_Surface *diff) {
+	if (a->w != b->w || a->h != b->h || (diff && (diff->w != a->w || diff->h != a->h)))
+		throw std::runtime_error{"Compared images have different sizes"};
+	if (a->format != SDL_PIXELFORMAT_RGBA32 || b->format != SDL_PIXELFORMAT_RGBA32 ||
+	    (diff && diff->format != SDL_PIXELFORMAT_RGBA32))
+		throw std::runtime_error{"Compared images have to be RGBA32"};
+
+	RowDiff total{};
+	const auto rowBytes{static_cast<size_t>(a->w) * 4};
+	for (int y{}; y < a->h; ++y)
+		DiffPixels(static_cast<const Uint8 *>(a->pixels) + static_cast<size_t>(y) * a->pitch,
+		           static_cast<const Uint8 *>(b->pixels) + static_cast<size_t>(y) * b->pitch,
+		           diff ? static_cast<Uint8 *>(diff->pixels) + static_cast<size_t>(y) * diff->pitch : nullptr,
+		           rowBytes, total);
+
+	const auto channelCount{static_cast<double>(a->w) * static_cast<double>(a->h) * 3.0};
+	const auto meanSquaredError{channelCount > 0.0 ? static_cast<double>(total.squaredError) / channelCount : 0.0};
+	return {
+		.maxError = total.maxError,
+		.meanSquaredError = meanSquaredError,
+		.psnr = meanSquaredError > 0.0
+			        ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError)
+			        : std::numeric_limits<double>::infinity(),
+	};
+}
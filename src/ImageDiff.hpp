@@ -0,0 +1,15 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+struct ImageDiffResult {
+	// Largest difference of any color channel, 0 to 255
+	Uint8 maxError;
+	double meanSquaredError;
+	// Peak signal to noise ratio in dB, infinite for identical images
+	double psnr;
+};
+
+// Compares the color channels of two images of the same size, alpha is ignored. When diff is given it receives the
+// differences amplified eight times, fully opaque. All surfaces have to be SDL_PIXELFORMAT_RGBA32.
+ImageDiffResult DiffImages(const SDL_Surface *a, const SDL_Surface *b, SDL_Surface *diff = nullptr);
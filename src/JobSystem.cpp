@@ -0,0 +1,356 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <utility>
+
+#include "Memory.hpp"
+#include "Profiler.hpp"
+
+struct Job {
+	JobSystem::Function function;
+	JobCounter *counter;
+	bool isMainThreadOnly;
+};
+
+namespace {
+	constexpr Uint32 NotAJobSystemThread{~0u};
+	thread_local Uint32 CurrentThreadIndex{NotAJobSystemThread};
+	// Rounds of stealing before an idle worker goes to sleep
+	constexpr int SpinCount{64};
+	// Finished jobs a thread keeps for reuse before handing a batch back to the shared list
+	constexpr size_t LocalFreeJobLimit{256};
+	constexpr size_t FreeJobBatchSize{128};
+}
+
+bool JobCounter::IsDone() const {
+	return pending.load(std::memory_order_acquire) == 0;
+}
+
+bool WorkStealingDeque::Push(Job *job) {
+	const auto currentBottom{bottom.load(std::memory_order_relaxed)};
+	const auto currentTop{top.load(std::memory_order_acquire)};
+	if (currentBottom - currentTop >= Capacity)
+		return false;
+
+	buffer[currentBottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(currentBottom + 1, std::memory_order_release);
+	return true;
+}
+
+Job *WorkStealingDeque::Pop() {
+	const auto currentBottom{bottom.load(std::memory_order_relaxed) - 1};
+	bottom.store(currentBottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto currentTop{top.load(std::memory_order_relaxed)};
+
+	if (currentTop > currentBottom) {
+		bottom.store(currentBottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	auto job{buffer[currentBottom & (Capacity - 1)].load(std::memory_order_relaxed)};
+	if (currentTop == currentBottom) {
+		// Last job, race the thieves for it
+		if (!top.compare_exchange_strong(currentTop, currentTop + 1, std::memory_order_seq_cst,
+		                                 std::memory_order_relaxed))
+			job = nullptr;
+		bottom.store(currentBottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job *WorkStealingDeque::Steal() {
+	auto currentTop{top.load(std::memory_order_acquire)};
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const auto currentBottom{bottom.load(std::memory_order_acquire)};
+	if (currentTop >= currentBottom)
+		return nullptr;
+
+	auto job{buffer[currentTop & (Capacity - 1)].load(std::memory_order_relaxed)};
+	if (!top.compare_exchange_strong(currentTop, currentTop + 1, std::memory_order_seq_cst,
+	                                 std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+JobSystem::JobSystem(const Uint32 workerCount) : mainThreadId{std::this_thread::get_id()} {
+	MemoryScope memoryScope{MemoryTag::Jobs};
+	deques.reserve(workerCount + 1);
+	for (Uint32 i{}; i <= workerCount; ++i)
+		deques.push_back(std::make_unique<WorkStealingDeque>());
+	localFreeJobs.resize(workerCount + 1);
+	for (auto &freeJobs: localFreeJobs) {
+		freeJobs.reserve(LocalFreeJobLimit + FreeJobBatchSize);
+		for (size_t i{}; i < FreeJobBatchSize; ++i)
+			freeJobs.push_back(new Job{});
+	}
+
+	CurrentThreadIndex = 0;
+	workers.reserve(workerCount);
+	for (Uint32 i{1}; i <= workerCount; ++i)
+		workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+	stopping.store(true);
+	wakeGeneration.fetch_add(1);
+	wakeGeneration.notify_all();
+	for (auto &worker: workers)
+		worker.join();
+	CurrentThreadIndex = NotAJobSystemThread;
+
+	for (const auto &freeJobs: localFreeJobs)
+		for (auto job: freeJobs)
+			delete job;
+	for (auto job: sharedFreeJobs)
+		delete job;
+}
+
+Uint32 JobSystem::GetWorkerCount() const {
+	return static_cast<Uint32>(workers.size());
+}
+
+Uint32 JobSystem::GetThreadCount() const {
+	return GetWorkerCount() + 1;
+}
+
+bool JobSystem::IsMainThread() const {
+	return std::this_thread::get_id() == mainThreadId;
+}
+
+void JobSystem::Run(Function function, JobCounter *counter) {
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	Schedule(AllocateJob(std::move(function), counter, false));
+}
+
+void JobSystem::RunAfter(JobCounter &dependency, Function function, JobCounter *counter) {
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	auto job{AllocateJob(std::move(function), counter, false)};
+
+	{
+		std::lock_guard lock{dependency.continuationsMutex};
+		if (!dependency.IsDone()) {
+			dependency.continuations.push_back(job);
+			return;
+		}
+	}
+	Schedule(job);
+}
+
+void JobSystem::RunOnMainThread(Function function, JobCounter *counter) {
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	if (IsMainThread()) {
+		Execute(AllocateJob(std::move(function), counter, true));
+		return;
+	}
+
+	auto job{AllocateJob(std::move(function), counter, true)};
+	std::lock_guard lock{mainThreadMutex};
+	mainThreadJobs.push_back(job);
+	hasMainThreadJobs.store(true, std::memory_order_release);
+}
+
+void JobSystem::ExecuteMainThreadJobs() {
+	if (!hasMainThreadJobs.load(std::memory_order_acquire))
+		return;
+
+	std::deque<Job *> jobs;
+	{
+		std::lock_guard lock{mainThreadMutex};
+		jobs.swap(mainThreadJobs);
+		hasMainThreadJobs.store(false, std::memory_order_relaxed);
+	}
+	for (auto job: jobs)
+		Execute(job);
+}
+
+void JobSystem::Acquire(JobCounter &counter) {
+	counter.pending.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::Release(JobCounter &counter) {
+	Finish(&counter);
+}
+
+void JobSystem::Wait(JobCounter &counter) {
+	const auto threadIndex{CurrentThreadIndex};
+	auto idleRounds{0};
+	while (!counter.IsDone()) {
+		if (threadIndex == 0)
+			ExecuteMainThreadJobs();
+		// Threads outside the job system can't steal, they only wait
+		if (threadIndex != NotAJobSystemThread && ExecuteOne(threadIndex)) {
+			idleRounds = 0;
+			continue;
+		}
+		if (++idleRounds > SpinCount)
+			std::this_thread::yield();
+	}
+
+	// The last job drops the counter to zero while holding the lock, so taking it ensures that job is done with the
+	// counter before the caller can destroy it
+	std::lock_guard lock{counter.continuationsMutex};
+	if (counter.error)
+		std::rethrow_exception(std::exchange(counter.error, nullptr));
+}
+
+void JobSystem::WorkerLoop(const Uint32 threadIndex) {
+	CurrentThreadIndex = threadIndex;
+	SetProfilerThreadName(std::format("Job Worker {}", threadIndex));
+
+	while (!stopping.load(std::memory_order_relaxed)) {
+		// Read before looking for work so a job scheduled in between wakes this thread back up
+		const auto generation{wakeGeneration.load(std::memory_order_acquire)};
+
+		auto foundWork{false};
+		for (auto i{0}; i < SpinCount && !foundWork; ++i)
+			foundWork = ExecuteOne(threadIndex);
+		if (foundWork)
+			continue;
+
+		sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+		if (wakeGeneration.load(std::memory_order_seq_cst) == generation)
+			wakeGeneration.wait(generation, std::memory_order_acquire);
+		sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void JobSystem::Schedule(Job *job) {
+	const auto threadIndex{CurrentThreadIndex};
+	if (threadIndex == NotAJobSystemThread || !deques[threadIndex]->Push(job)) {
+		std::lock_guard lock{injectedMutex};
+		injectedJobs.push_back(job);
+		hasInjectedJobs.store(true, std::memory_order_release);
+	}
+
+	wakeGeneration.fetch_add(1, std::memory_order_seq_cst);
+	if (sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+		wakeGeneration.notify_one();
+}
+
+bool JobSystem::ExecuteOne(const Uint32 threadIndex) {
+	auto job{FindJob(threadIndex)};
+	if (!job)
+		return false;
+	Execute(job);
+	return true;
+}
+
+Job *JobSystem::FindJob(const Uint32 threadIndex) {
+	if (auto job{deques[threadIndex]->Pop()})
+		return job;
+
+	if (hasInjectedJobs.load(std::memory_order_acquire)) {
+		std::lock_guard lock{injectedMutex};
+		if (!injectedJobs.empty()) {
+			auto job{injectedJobs.front()};
+			injectedJobs.pop_front();
+			hasInjectedJobs.store(!injectedJobs.empty(), std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	// Start at a different victim per thread so thieves don't all hammer the same deque
+	const auto dequeCount{static_cast<Uint32>(deques.size())};
+	for (Uint32 i{1}; i < dequeCount; ++i)
+		if (auto job{deques[(threadIndex + i) % dequeCount]->Steal()})
+			return job;
+
+	return nullptr;
+}
+
+void JobSystem::Execute(Job *job) {
+	try {
+		PROFILE_ZONE("Job");
+		job->function();
+	} catch (...) {
+		if (!job->counter)
+			throw;
+		std::lock_guard lock{job->counter->continuationsMutex};
+		if (!job->counter->error)
+			job->counter->error = std::current_exception();
+	}
+	auto counter{job->counter};
+	FreeJob(job);
+	Finish(counter);
+}
+
+Job *JobSystem::AllocateJob(Function function, JobCounter *counter, const bool isMainThreadOnly) {
+	MemoryScope memoryScope{MemoryTag::Jobs};
+	Job *job{};
+	const auto threadIndex{CurrentThreadIndex};
+	if (threadIndex != NotAJobSystemThread) {
+		auto &freeJobs{localFreeJobs[threadIndex]};
+		if (freeJobs.empty()) {
+			std::lock_guard lock{freeJobsMutex};
+			const auto count{std::min(sharedFreeJobs.size(), FreeJobBatchSize)};
+			freeJobs.insert(freeJobs.end(), sharedFreeJobs.end() - static_cast<std::ptrdiff_t>(count),
+			                sharedFreeJobs.end());
+			sharedFreeJobs.resize(sharedFreeJobs.size() - count);
+		}
+		if (!freeJobs.empty()) {
+			job = freeJobs.back();
+			freeJobs.pop_back();
+		}
+	} else {
+		std::lock_guard lock{freeJobsMutex};
+		if (!sharedFreeJobs.empty()) {
+			job = sharedFreeJobs.back();
+			sharedFreeJobs.pop_back();
+		}
+	}
+
+	if (!job)
+		return new Job{std::move(function), counter, isMainThreadOnly};
+	job->function = std::move(function);
+	job->counter = counter;
+	job->isMainThreadOnly = isMainThreadOnly;
+	return job;
+}
+
+void JobSystem::FreeJob(Job *job) {
+	// Drop the captures now rather than whenever the job gets reused
+	job->function = nullptr;
+
+	const auto threadIndex{CurrentThreadIndex};
+	if (threadIndex == NotAJobSystemThread) {
+		std::lock_guard lock{freeJobsMutex};
+		sharedFreeJobs.push_back(job);
+		return;
+	}
+
+	// Jobs tend to be created on one thread and finished on others, the shared list evens that out
+	auto &freeJobs{localFreeJobs[threadIndex]};
+	freeJobs.push_back(job);
+	if (freeJobs.size() > LocalFreeJobLimit) {
+		std::lock_guard lock{freeJobsMutex};
+		sharedFreeJobs.insert(sharedFreeJobs.end(), freeJobs.end() - FreeJobBatchSize, freeJobs.end());
+		freeJobs.resize(freeJobs.size() - FreeJobBatchSize);
+	}
+}
+
+void JobSystem::Finish(JobCounter *counter) {
+	if (!counter)
+		return;
+
+	// Lock-free unless this is the last job, which has to release the continuations
+	auto pending{counter->pending.load(std::memory_order_relaxed)};
+	while (pending > 1)
+		if (counter->pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel,
+		                                           std::memory_order_relaxed))
+			return;
+
+	std::vector<Job *> continuations;
+	{
+		std::lock_guard lock{counter->continuationsMutex};
+		counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+		continuations.swap(counter->continuations);
+	}
+	for (auto job: continuations)
+		Schedule(job);
+}
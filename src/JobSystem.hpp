@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+
+struct Job;
+
+// Counts unfinished jobs. Jobs can be scheduled to start once a counter drops to zero, which is how dependencies
+// between jobs are expressed. The first exception thrown by a counted job is rethrown by JobSystem::Wait.
+class JobCounter {
+public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter &) = delete;
+
+	JobCounter &operator=(const JobCounter &) = delete;
+
+	[[nodiscard]] bool IsDone() const;
+
+private:
+	friend class JobSystem;
+
+	std::atomic<Uint32> pending{};
+	std::mutex continuationsMutex;
+	std::vector<Job *> continuations;
+	std::exception_ptr error;
+};
+
+// Chase-Lev work-stealing deque: the owning thread pushes and pops at the bottom, other threads steal from the top
+class WorkStealingDeque {
+public:
+	static constexpr Sint64 Capacity{4096};
+
+	bool Push(Job *job);
+
+	Job *Pop();
+
+	Job *Steal();
+
+private:
+	alignas(64) std::atomic<Sint64> top{};
+	alignas(64) std::atomic<Sint64> bottom{};
+	std::array<std::atomic<Job *>, Capacity> buffer{};
+};
+
+// The thread constructing the job system is the main thread: it owns the first deque, runs main thread jobs and
+// helps with other jobs while it waits on counters.
+class JobSystem {
+public:
+	using Function = std::move_only_function<void()>;
+
+	explicit JobSystem(Uint32 workerCount);
+
+	~JobSystem();
+
+	JobSystem(const JobSystem &) = delete;
+
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	[[nodiscard]] Uint32 GetWorkerCount() const;
+
+	// Worker threads plus the main thread
+	[[nodiscard]] Uint32 GetThreadCount() const;
+
+	// Runs the function on any job system thread, counter (if any) stays above zero until it returns
+	void Run(Function function, JobCounter *counter = nullptr);
+
+	// Like Run but the job only starts once dependency reaches zero
+	void RunAfter(JobCounter &dependency, Function function, JobCounter *counter = nullptr);
+
+	// For SDL calls that must happen on the main thread, executed by ExecuteMainThreadJobs or while the main thread waits
+	void RunOnMainThread(Function function, JobCounter *counter = nullptr);
+
+	// Called once per frame by the main loop
+	void ExecuteMainThreadJobs();
+
+	// Keeps the counter above zero without a job, for work that completes elsewhere such as a suspended coroutine
+	void Acquire(JobCounter &counter);
+
+	// Balances Acquire, releasing dependent jobs and waiters once the counter reaches zero
+	void Release(JobCounter &counter);
+
+	// Executes other jobs until the counter reaches zero
+	void Wait(JobCounter &counter);
+
+	[[nodiscard]] bool IsMainThread() const;
+
+private:
+	void WorkerLoop(Uint32 threadIndex);
+
+	void Schedule(Job *job);
+
+	bool ExecuteOne(Uint32 threadIndex);
+
+	void Execute(Job *job);
+
+	Job *FindJob(Uint32 threadIndex);
+
+	void Finish(JobCounter *counter);
+
+	Job *AllocateJob(Function function, JobCounter *counter, bool isMainThreadOnly);
+
+	void FreeJob(Job *job);
+
+	std::thread::id mainThreadId;
+	// Index 0 belongs to the main thread, the rest to the workers
+	std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+	std::vector<std::thread> workers;
+
+	// Jobs submitted from threads the job system doesn't own
+	std::mutex injectedMutex;
+	std::deque<Job *> injectedJobs;
+	std::atomic<bool> hasInjectedJobs{};
+
+	// Finished jobs kept for reuse, indexed like the deques
+	std::vector<std::vector<Job *>> localFreeJobs;
+	std::mutex freeJobsMutex;
+	std::vector<Job *> sharedFreeJobs;
+
+	std::mutex mainThreadMutex;
+	std::deque<Job *> mainThreadJobs;
+	std::atomic<bool> hasMainThreadJobs{};
+
+	std::atomic<Uint64> wakeGeneration{};
+	std::atomic<Uint32> sleepingWorkers{};
+	std::atomic<bool> stopping{};
+};
+
+// Splits [0, count) in ranges of at most grainSize elements and calls function(begin, end) on each from the job system
+template<typename Function>
+void ParallelFor(JobSystem &jobSystem, const size_t count, const size_t grainSize, Function &&function) {
+	if (count == 0)
+		return;
+	if (count <= grainSize) {
+		function(size_t{}, count);
+		return;
+	}
+
+	JobCounter counter;
+	// The calling thread takes the first range itself instead of waiting idle
+	for (auto begin{grainSize}; begin < count; begin += grainSize) {
+		const auto end{std::min(begin + grainSize, count)};
+		jobSystem.Run([&function, begin, end] { function(begin, end); }, &counter);
+	}
+	function(size_t{}, grainSize);
+	jobSystem.Wait(counter);
+}
@@ -0,0 +1,429 @@
+#include "Memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <print>
+#include <string>
+#include <unordered_map>
+
+namespace {
+	// Every tracked allocation is preceded by this header, the tag sits in the top byte of the size
+	struct alignas(16) AllocationHeader {
+		Uint64 sizeAndTag;
+		void *base;
+	};
+
+	constexpr Uint64 SizeMask{(Uint64{1} << 56) - 1};
+	constexpr auto TagCount{static_cast<size_t>(MemoryTag::Count)};
+
+	struct alignas(64) TagCounters {
+		std::atomic<Uint64> liveBytes;
+		std::atomic<Uint64> peakBytes;
+		std::atomic<Uint64> liveAllocations;
+		std::atomic<Uint64> totalAllocations;
+		std::atomic<Uint64> totalBytes;
+
+		void Add(const Uint64 size) {
+			const auto live{liveBytes.fetch_add(size, std::memory_order_relaxed) + size};
+			auto peak{peakBytes.load(std::memory_order_relaxed)};
+			while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+			liveAllocations.fetch_add(1, std::memory_order_relaxed);
+			totalAllocations.fetch_add(1, std::memory_order_relaxed);
+			totalBytes.fetch_add(size, std::memory_order_relaxed);
+		}
+
+		void Remove(const Uint64 size) {
+			liveBytes.fetch_sub(size, std::memory_order_relaxed);
+			liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] MemoryTagStats Load() const {
+			return {
+				.liveBytes = liveBytes.load(std::memory_order_relaxed),
+				.peakBytes = peakBytes.load(std::memory_order_relaxed),
+				.liveAllocations = liveAllocations.load(std::memory_order_relaxed),
+				.totalAllocations = totalAllocations.load(std::memory_order_relaxed),
+				.totalBytes = totalBytes.load(std::memory_order_relaxed),
+			};
+		}
+	};
+
+	std::array<TagCounters, TagCount> heapCounters;
+	std::array<TagCounters, TagCount> gpuCounters;
+	thread_local auto currentTag{MemoryTag::General};
+
+	struct GpuRegistry {
+		std::mutex mutex;
+		std::unordered_map<const void *, GpuResourceInfo> resources;
+	};
+
+	// Never destroyed, so the leak report at exit and resources released by static destructors can still use it
+	GpuRegistry &GetGpuRegistry() {
+		static const auto registry{new GpuRegistry};
+		return *registry;
+	}
+
+	AllocationHeader *GetHeader(void *pointer) {
+		return static_cast<AllocationHeader *>(pointer) - 1;
+	}
+
+	void *HeapAllocate(const size_t size, const size_t alignment) {
+		// Over-aligned blocks get room to slide the header and the pointer up to the alignment
+		const auto padding{alignment > alignof(AllocationHeader) ? alignment : 0};
+		const auto base{std::malloc(sizeof(AllocationHeader) + padding + size)};
+		if (!base)
+			return nullptr;
+
+		auto pointer{static_cast<std::byte *>(base) + sizeof(AllocationHeader)};
+		if (padding)
+			pointer = reinterpret_cast<std::byte *>(
+				(reinterpret_cast<uintptr_t>(pointer) + alignment - 1) & ~(uintptr_t{alignment} - 1));
+
+		const auto tag{currentTag};
+		*GetHeader(pointer) = {
+			.sizeAndTag = size | static_cast<Uint64>(tag) << 56,
+			.base = base,
+		};
+		heapCounters[static_cast<size_t>(tag)].Add(size);
+		return pointer;
+	}
+
+	void HeapFree(void *pointer) noexcept {
+		if (!pointer)
+			return;
+
+		const auto header{GetHeader(pointer)};
+		heapCounters[header->sizeAndTag >> 56].Remove(header->sizeAndTag & SizeMask);
+		std::free(header->base);
+	}
+
+	void *HeapAllocateOrThrow(const size_t size, const size_t alignment) {
+		if (const auto pointer{HeapAllocate(size, alignment)})
+			return pointer;
+		throw std::bad_alloc{};
+	}
+
+	void *SDLCALL TrackedMalloc(const size_t size) {
+		return HeapAllocate(size, alignof(AllocationHeader));
+	}
+
+	void *SDLCALL TrackedCalloc(const size_t count, const size_t size) {
+		const auto pointer{HeapAllocate(count * size, alignof(AllocationHeader))};
+		if (pointer)
+			std::memset(pointer, 0, count * size);
+		return pointer;
+	}
+
+	void *SDLCALL TrackedRealloc(void *pointer, const size_t size) {
+		if (!pointer)
+			return TrackedMalloc(size);
+
+		// SDL's blocks are never over-aligned, so the header is at the start of the block and realloc can move it
+		auto header{GetHeader(pointer)};
+		const auto oldSizeAndTag{header->sizeAndTag};
+		const auto base{std::realloc(header->base, sizeof(AllocationHeader) + size)};
+		if (!base)
+			return nullptr;
+
+		auto &counters{heapCounters[oldSizeAndTag >> 56]};
+		counters.Remove(oldSizeAndTag & SizeMask);
+		counters.Add(size);
+		header = static_cast<AllocationHeader *>(base);
+		*header = {
+			.sizeAndTag = size | (oldSizeAndTag & ~SizeMask),
+			.base = base,
+		};
+		return header + 1;
+	}
+
+	void SDLCALL TrackedFree(void *pointer) {
+		HeapFree(pointer);
+	}
+
+	constexpr size_t AlignUp(const size_t value, const size_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+}
+
+std::string FormatBytes(const Uint64 bytes) {
+	if (bytes >= 1024 * 1024)
+		return std::format("{:.1f} MiB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+	if (bytes >= 1024)
+		return std::format("{:.1f} KiB", static_cast<double>(bytes) / 1024.0);
+	return std::format("{} B", bytes);
+}
+
+std::string_view ToString(const MemoryTag tag) {
+	switch (tag) {
+		case MemoryTag::General: return "General";
+		case MemoryTag::Assets: return "Assets";
+		case MemoryTag::Rendering: return "Rendering";
+		case MemoryTag::Ecs: return "ECS";
+		case MemoryTag::Jobs: return "Jobs";
+		default: return "Unknown";
+	}
+}
+
+MemoryScope::MemoryScope(const MemoryTag tag) : previousTag{currentTag} {
+	currentTag = tag;
+}
+
+MemoryScope::~MemoryScope() {
+	currentTag = previousTag;
+}
+
+MemoryTagStats GetHeapStats(const MemoryTag tag) {
+	return heapCounters[static_cast<size_t>(tag)].Load();
+}
+
+MemoryTagStats GetGpuStats(const MemoryTag tag) {
+	return gpuCounters[static_cast<size_t>(tag)].Load();
+}
+
+HeapAllocationStats GetHeapAllocationStats() {
+	HeapAllocationStats result{};
+	for (const auto &counters: heapCounters) {
+		result.allocationCount += counters.totalAllocations.load(std::memory_order_relaxed);
+		result.allocatedBytes += counters.totalBytes.load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+void InstallSdlMemoryTracking() {
+	SDL_SetMemoryFunctions(TrackedMalloc, TrackedCalloc, TrackedRealloc, TrackedFree);
+}
+
+std::string_view ToString(const GpuResourceKind kind) {
+	switch (kind) {
+		case GpuResourceKind::Texture: return "Texture";
+		case GpuResourceKind::Buffer: return "Buffer";
+		case GpuResourceKind::TransferBuffer: return "Transfer Buffer";
+	}
+	return "Unknown";
+}
+
+void TrackGpuResource(const void *resource, GpuResourceInfo info) {
+	// The registry's own bookkeeping isn't charged to the subsystem creating the resource
+	MemoryScope memoryScope{MemoryTag::General};
+	gpuCounters[static_cast<size_t>(info.tag)].Add(info.sizeInBytes);
+	auto &registry{GetGpuRegistry()};
+	std::lock_guard lock{registry.mutex};
+	registry.resources[resource] = std::move(info);
+}
+
+void UntrackGpuResource(const void *resource) {
+	if (!resource)
+		return;
+
+	auto &registry{GetGpuRegistry()};
+	std::lock_guard lock{registry.mutex};
+	if (const auto it{registry.resources.find(resource)}; it != registry.resources.end()) {
+		gpuCounters[static_cast<size_t>(it->second.tag)].Remove(it->second.sizeInBytes);
+		registry.resources.erase(it);
+	}
+}
+
+std::vector<GpuResourceInfo> GetGpuResources() {
+	auto &registry{GetGpuRegistry()};
+	std::lock_guard lock{registry.mutex};
+	std::vector<GpuResourceInfo> result;
+	result.reserve(registry.resources.size());
+	for (const auto &[resource, info]: registry.resources)
+		result.push_back(info);
+	return result;
+}
+
+void PrintMemoryReport() {
+	static std::array<Uint64, TagCount> previousAllocations{};
+	static Uint64 previousTicks{};
+
+	const auto ticks{SDL_GetTicksNS()};
+	const auto seconds{static_cast<double>(ticks - previousTicks) / 1e9};
+	previousTicks = ticks;
+
+	std::println("{:<10} {:>12} {:>12} {:>14} {:>12} {:>12}", "Memory", "heap live", "heap peak", "allocations/s",
+	             "GPU live", "GPU peak");
+	for (size_t i{}; i < TagCount; ++i) {
+		const auto tag{static_cast<MemoryTag>(i)};
+		const auto heap{GetHeapStats(tag)};
+		const auto gpu{GetGpuStats(tag)};
+		const auto rate{static_cast<double>(heap.totalAllocations - previousAllocations[i]) / seconds};
+		previousAllocations[i] = heap.totalAllocations;
+		std::println("{:<10} {:>12} {:>12} {:>14.0f} {:>12} {:>12}", ToString(tag), FormatBytes(heap.liveBytes),
+		             FormatBytes(heap.peakBytes), rate, FormatBytes(gpu.liveBytes), FormatBytes(gpu.peakBytes));
+	}
+}
+
+void PrintMemoryLeaks() {
+	auto leaked{false};
+	// Untagged memory also holds the C++ and SDL runtimes' own allocations, so only subsystems are checked
+	for (size_t i{1}; i < TagCount; ++i) {
+		const auto tag{static_cast<MemoryTag>(i)};
+		const auto heap{GetHeapStats(tag)};
+		if (heap.liveAllocations == 0)
+			continue;
+		std::println("Leak: {} heap memory, {} in {} allocations", ToString(tag), FormatBytes(heap.liveBytes),
+		             heap.liveAllocations);
+		leaked = true;
+	}
+
+	auto &registry{GetGpuRegistry()};
+	std::lock_guard lock{registry.mutex};
+	for (const auto &[resource, gpuResource]: registry.resources) {
+		std::println("Leak: {} GPU resource \"{}\", {}", ToString(gpuResource.tag), gpuResource.name,
+		             FormatBytes(gpuResource.sizeInBytes));
+		leaked = true;
+	}
+
+	if (!leaked)
+		std::println("No memory leaks");
+}
+
+void *operator new(const size_t size) {
+	return HeapAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new[](const size_t size) {
+	return HeapAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new(const size_t size, const std::align_val_t alignment) {
+	return HeapAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](const size_t size, const std::align_val_t alignment) {
+	return HeapAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(const size_t size, const std::nothrow_t &) noexcept {
+	return HeapAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new[](const size_t size, const std::nothrow_t &) noexcept {
+	return HeapAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new(const size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return HeapAllocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](const size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return HeapAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+	HeapFree(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+	HeapFree(pointer);
+}
+
+LinearArena::LinearArena(const size_t capacity)
+	: buffer{static_cast<std::byte *>(::operator new(capacity, std::align_val_t{64}))}, capacity{capacity} {}
+
+LinearArena::~LinearArena() {
+	ReleaseOverflow();
+	::operator delete(buffer, std::align_val_t{64});
+}
+
+void LinearArena::Reset() {
+	const auto used{std::min(offset.load(std::memory_order_relaxed), capacity) + overflowBytes};
+	peak = std::max(peak, used);
+	if (!overflow.empty()) {
+		ReleaseOverflow();
+		::operator delete(buffer, std::align_val_t{64});
+		capacity = std::max(capacity * 2, AlignUp(used, 64));
+		buffer = static_cast<std::byte *>(::operator new(capacity, std::align_val_t{64}));
+	}
+	offset.store(0, std::memory_order_relaxed);
+}
+
+void *LinearArena::do_allocate(const size_t bytes, const size_t alignment) {
+	auto current{offset.load(std::memory_order_relaxed)};
+	while (true) {
+		const auto start{AlignUp(current, alignment)};
+		const auto end{start + bytes};
+		if (end > capacity)
+			break;
+		if (offset.compare_exchange_weak(current, end, std::memory_order_relaxed))
+			return buffer + start;
+	}
+
+	// Past the end for this frame; the offset is pushed beyond capacity so later allocations skip the CAS loop
+	offset.store(capacity + 1, std::memory_order_relaxed);
+	const auto pointer{::operator new(bytes, std::align_val_t{alignment})};
+	std::lock_guard lock{overflowMutex};
+	overflow.push_back({pointer, alignment});
+	overflowBytes += bytes;
+	return pointer;
+}
+
+void LinearArena::ReleaseOverflow() {
+	for (const auto [pointer, alignment]: overflow)
+		::operator delete(pointer, std::align_val_t{alignment});
+	overflow.clear();
+	overflowBytes = 0;
+}
+
+FrameAllocator::FrameAllocator(const Uint32 frameCount, const size_t capacityPerFrame) {
+	for (Uint32 i{}; i < frameCount; ++i)
+		arenas.push_back(std::make_unique<LinearArena>(capacityPerFrame));
+}
+
+void FrameAllocator::BeginFrame() {
+	frameIndex = (frameIndex + 1) % static_cast<Uint32>(arenas.size());
+	arenas[frameIndex]->Reset();
+}
+
+size_t FrameAllocator::GetPeak() const {
+	size_t peak{};
+	for (const auto &arena: arenas)
+		peak = std::max(peak, arena->GetPeak());
+	return peak;
+}
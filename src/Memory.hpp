@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <SDL3/SDL.h>
+
+// Subsystem owning an allocation
+enum class MemoryTag : Uint8 {
+	General,
+	Assets,
+	Rendering,
+	Ecs,
+	Jobs,
+	Count,
+};
+
+std::string_view ToString(MemoryTag tag);
+
+// e.g. "1.5 MiB"
+std::string FormatBytes(Uint64 bytes);
+
+// Heap allocations made by this thread are tagged with the given subsystem until the scope ends
+class MemoryScope {
+public:
+	explicit MemoryScope(MemoryTag tag);
+
+	~MemoryScope();
+
+	MemoryScope(const MemoryScope &) = delete;
+
+	MemoryScope &operator=(const MemoryScope &) = delete;
+
+private:
+	MemoryTag previousTag;
+};
+
+struct MemoryTagStats {
+	Uint64 liveBytes;
+	Uint64 peakBytes;
+	Uint64 liveAllocations;
+	// Since startup, differences between two snapshots give the allocation rate
+	Uint64 totalAllocations;
+	Uint64 totalBytes;
+};
+
+// Covers the global operator new and, once InstallSdlMemoryTracking was called, SDL's allocator
+MemoryTagStats GetHeapStats(MemoryTag tag);
+
+// Covers the GPU resources registered with TrackGpuResource
+MemoryTagStats GetGpuStats(MemoryTag tag);
+
+// Totals of all tags
+struct HeapAllocationStats {
+	Uint64 allocationCount;
+	Uint64 allocatedBytes;
+};
+
+HeapAllocationStats GetHeapAllocationStats();
+
+// Routes SDL_malloc and friends through the tracked heap, has to happen before SDL allocates anything
+void InstallSdlMemoryTracking();
+
+enum class GpuResourceKind : Uint8 {
+	Texture,
+	Buffer,
+	TransferBuffer,
+};
+
+std::string_view ToString(GpuResourceKind kind);
+
+// A tracked GPU resource and what its size was computed from, the texture fields stay empty for buffers
+struct GpuResourceInfo {
+	std::string name;
+	MemoryTag tag{};
+	GpuResourceKind kind{};
+	Uint64 sizeInBytes{};
+	SDL_GPUTextureFormat format{SDL_GPU_TEXTUREFORMAT_INVALID};
+	Uint32 width{};
+	Uint32 height{};
+	Uint32 layerCountOrDepth{};
+	Uint32 levelCount{};
+	SDL_GPUSampleCount sampleCount{SDL_GPU_SAMPLECOUNT_1};
+};
+
+// SDL doesn't expose driver allocations, so GPU memory is accounted by whoever creates the resource
+void TrackGpuResource(const void *resource, GpuResourceInfo info);
+
+void UntrackGpuResource(const void *resource);
+
+// A copy of every GPU resource alive right now
+std::vector<GpuResourceInfo> GetGpuResources();
+
+// Live bytes, peaks and allocation rates since the previous report, per tag
+void PrintMemoryReport();
+
+// Tagged heap memory and GPU resources still alive, meant to run once everything was released
+void PrintMemoryLeaks();
+
+// Bump allocator over a single block where everything is freed at once by Reset. Allocation is lock-free, so jobs on
+// any thread can share an arena. Allocations past the end fall back to the heap and the block grows to the high water
+// mark on the next Reset, after which the arena no longer touches the heap.
+class LinearArena final : public std::pmr::memory_resource {
+public:
+	explicit LinearArena(size_t capacity);
+
+	~LinearArena() override;
+
+	LinearArena(const LinearArena &) = delete;
+
+	LinearArena &operator=(const LinearArena &) = delete;
+
+	void Reset();
+
+	[[nodiscard]] size_t GetCapacity() const { return capacity; }
+
+	[[nodiscard]] size_t GetUsed() const { return std::min(offset.load(std::memory_order_relaxed), capacity); }
+
+	// The most bytes any cycle before the last Reset requested, including heap fallbacks
+	[[nodiscard]] size_t GetPeak() const { return peak; }
+
+private:
+	void *do_allocate(size_t bytes, size_t alignment) override;
+
+	// Individual allocations are only released by Reset
+	void do_deallocate(void *, size_t, size_t) override {}
+
+	bool do_is_equal(const memory_resource &other) const noexcept override { return this == &other; }
+
+	struct Overflow {
+		void *pointer;
+		size_t alignment;
+	};
+
+	void ReleaseOverflow();
+
+	std::byte *buffer;
+	size_t capacity;
+	std::atomic<size_t> offset{};
+	size_t peak{};
+
+	std::mutex overflowMutex;
+	std::vector<Overflow> overflow;
+	size_t overflowBytes{};
+};
+
+// One arena per frame that can be in flight, so data the GPU may still read from stays valid until its frame's arena
+// comes around again
+class FrameAllocator {
+public:
+	FrameAllocator(Uint32 frameCount, size_t capacityPerFrame);
+
+	// Resets the arena of the oldest frame and makes it current
+	void BeginFrame();
+
+	[[nodiscard]] LinearArena &GetCurrent() { return *arenas[frameIndex]; }
+
+	// The most any frame before the current one allocated
+	[[nodiscard]] size_t GetPeak() const;
+
+private:
+	std::vector<std::unique_ptr<LinearArena>> arenas;
+	Uint32 frameIndex{};
+};
+
+// Fixed size slots carved from pages of PageSize objects, destroyed objects' slots are reused before a new page is
+// allocated. Not thread-safe, objects still alive when the pool is destroyed aren't destructed.
+template<typename T, size_t PageSize = 256>
+class ObjectPool {
+public:
+	ObjectPool() = default;
+
+	ObjectPool(const ObjectPool &) = delete;
+
+	ObjectPool &operator=(const ObjectPool &) = delete;
+
+	template<typename... Args>
+	T *Create(Args &&... args) {
+		if (!freeSlots)
+			AddPage();
+		auto slot{freeSlots};
+		freeSlots = slot->next;
+		auto object{new(slot->storage) T{std::forward<Args>(args)...}};
+		++liveCount;
+		return object;
+	}
+
+	void Destroy(T *object) {
+		object->~T();
+		auto slot{reinterpret_cast<Slot *>(object)};
+		slot->next = freeSlots;
+		freeSlots = slot;
+		--liveCount;
+	}
+
+	[[nodiscard]] size_t GetLiveCount() const { return liveCount; }
+
+	[[nodiscard]] size_t GetCapacity() const { return pages.size() * PageSize; }
+
+private:
+	union Slot {
+		Slot *next;
+		alignas(T) std::byte storage[sizeof(T)];
+	};
+
+	void AddPage() {
+		auto &page{pages.emplace_back(std::make_unique<Slot[]>(PageSize))};
+		for (auto i{PageSize}; i > 0; --i) {
+			page[i - 1].next = freeSlots;
+			freeSlots = &page[i - 1];
+		}
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> pages;
+	Slot *freeSlots{};
+	size_t liveCount{};
+};
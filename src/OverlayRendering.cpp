@@ -0,0 +1,204 @@
+#include "OverlayRendering.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <utility>
+
+#include "Assets.hpp"
+#include "GpuResources.hpp"
+#include "Memory.hpp"
+#include "SDLException.hpp"
+
+SDL_GPUGraphicsPipeline *CreateOverlayPipeline(SDL_GPUDevice *device, const SDL_GPUTextureFormat targetFormat,
+                                               const std::string &vertexShaderFilename,
+                                               const std::string &fragmentShaderFilename, const Uint32 samplerCount,
+                                               const SDL_GPUVertexBufferDescription &vertexBuffer,
+                                               const std::span<const SDL_GPUVertexAttribute> vertexAttributes,
+                                               const SDL_GPUPrimitiveType primitiveType) {
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	auto vertexShader{LoadShader(device, vertexShaderFilename, 0, 1, 0, 0)};
+	if (!vertexShader)
+		throw SDLException{"Couldn't load vertex shader"};
+	auto fragmentShader{LoadShader(device, fragmentShaderFilename, samplerCount, 0, 0, 0)};
+	if (!fragmentShader) {
+		SDL_ReleaseGPUShader(device, vertexShader);
+		throw SDLException{"Couldn't load fragment shader"};
+	}
+
+	std::array colorTargetDescriptions{
+		SDL_GPUColorTargetDescription{
+			.format = targetFormat,
+			.blend_state = {
+				.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+				.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+				.color_blend_op = SDL_GPU_BLENDOP_ADD,
+				.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+				.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+				.alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+				.enable_blend = true,
+			},
+		},
+	};
+	SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo{
+		.vertex_shader = vertexShader,
+		.fragment_shader = fragmentShader,
+		.vertex_input_state = {
+			.vertex_buffer_descriptions = &vertexBuffer,
+			.num_vertex_buffers = 1,
+			.vertex_attributes = vertexAttributes.data(),
+			.num_vertex_attributes = static_cast<Uint32>(vertexAttributes.size()),
+		},
+		.primitive_type = primitiveType,
+		.target_info = {
+			.color_target_descriptions = colorTargetDescriptions.data(),
+			.num_color_targets = colorTargetDescriptions.size(),
+		},
+	};
+	auto pipeline{SDL_CreateGPUGraphicsPipeline(device, &pipelineCreateInfo)};
+	SDL_ReleaseGPUShader(device, vertexShader);
+	SDL_ReleaseGPUShader(device, fragmentShader);
+	if (!pipeline)
+		throw SDLException{"Couldn't create GPU graphics pipeline"};
+	return pipeline;
+}
+
+SDL_GPUSampler *CreateOverlaySampler(SDL_GPUDevice *device, const SDL_GPUFilter filter) {
+	const SDL_GPUSamplerCreateInfo samplerCreateInfo{
+		.min_filter = filter,
+		.mag_filter = filter,
+		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+	};
+	auto sampler{SDL_CreateGPUSampler(device, &samplerCreateInfo)};
+	if (!sampler)
+		throw SDLException{"Couldn't create GPU sampler"};
+	return sampler;
+}
+
+SDL_GPUTexture *CreateOverlayAtlas(SDL_GPUDevice *device, const SDL_GPUTextureFormat format, const Uint32 width,
+                                   const Uint32 height, const std::span<const std::byte> pixels, const char *name) {
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	const SDL_GPUTextureCreateInfo textureCreateInfo{
+		.format = format,
+		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		.width = width,
+		.height = height,
+		.layer_count_or_depth = 1,
+		.num_levels = 1,
+	};
+	auto texture{CreateTrackedTexture(device, textureCreateInfo, MemoryTag::Rendering, name)};
+
+	const SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo{
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = static_cast<Uint32>(pixels.size()),
+	};
+	auto transferBuffer{
+		CreateTrackedTransferBuffer(device, transferBufferCreateInfo, MemoryTag::Rendering,
+		                            (std::string{name} + " Upload Buffer").c_str())
+	};
+	auto transferBufferData{static_cast<std::byte *>(SDL_MapGPUTransferBuffer(device, transferBuffer, false))};
+	if (!transferBufferData)
+		throw SDLException{"Couldn't map transfer buffer"};
+	std::ranges::copy(pixels, transferBufferData);
+	SDL_UnmapGPUTransferBuffer(device, transferBuffer);
+
+	auto commandBuffer{SDL_AcquireGPUCommandBuffer(device)};
+	if (!commandBuffer)
+		throw SDLException{"Couldn't acquire GPU command buffer"};
+	auto copyPass{SDL_BeginGPUCopyPass(commandBuffer)};
+	const SDL_GPUTextureTransferInfo source{
+		.transfer_buffer = transferBuffer,
+	};
+	const SDL_GPUTextureRegion destination{
+		.texture = texture,
+		.w = width,
+		.h = height,
+		.d = 1,
+	};
+	SDL_UploadToGPUTexture(copyPass, &source, &destination, false);
+	SDL_EndGPUCopyPass(copyPass);
+	if (!SDL_SubmitGPUCommandBuffer(commandBuffer))
+		throw SDLException{"Couldn't submit GPU command buffer"};
+	ReleaseTrackedTransferBuffer(device, transferBuffer);
+	return texture;
+}
+
+SDL_GPURenderPass *BeginOverlayPass(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target,
+                                    SDL_GPUGraphicsPipeline *pipeline, SDL_GPUBuffer *vertexBuffer) {
+	std::array colorTargets{
+		SDL_GPUColorTargetInfo{
+			.texture = target,
+			.load_op = SDL_GPU_LOADOP_LOAD,
+			.store_op = SDL_GPU_STOREOP_STORE,
+		}
+	};
+	auto renderPass{SDL_BeginGPURenderPass(commandBuffer, colorTargets.data(), colorTargets.size(), nullptr)};
+	SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+	const SDL_GPUBufferBinding vertexBinding{
+		.buffer = vertexBuffer,
+	};
+	SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBinding, 1);
+	return renderPass;
+}
+
+OverlayVertexBuffer::OverlayVertexBuffer(SDL_GPUDevice *device, const Uint32 elementSize, const Uint32 minCapacity,
+                                         std::string name)
+	: device{device}, elementSize{elementSize}, minCapacity{minCapacity}, name{std::move(name)} {}
+
+OverlayVertexBuffer::~OverlayVertexBuffer() {
+	Release();
+}
+
+bool OverlayVertexBuffer::Reserve(const Uint32 count) {
+	if (count <= capacity)
+		return false;
+
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	Release();
+	capacity = std::max(minCapacity, std::bit_ceil(count));
+	const SDL_GPUBufferCreateInfo bufferCreateInfo{
+		.usage = SDL_GPU_BUFFERUSAGE_VERTEX,
+		.size = capacity * elementSize,
+	};
+	buffer = CreateTrackedBuffer(device, bufferCreateInfo, MemoryTag::Rendering, name.c_str());
+	const SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo{
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = bufferCreateInfo.size,
+	};
+	transferBuffer = CreateTrackedTransferBuffer(device, transferBufferCreateInfo, MemoryTag::Rendering,
+	                                             (name + " Upload Buffer").c_str());
+	return true;
+}
+
+void OverlayVertexBuffer::Upload(SDL_GPUCommandBuffer *commandBuffer, const void *elements, const Uint32 first,
+                                 const Uint32 count, const bool cycle) {
+	const auto size{count * elementSize};
+	auto data{SDL_MapGPUTransferBuffer(device, transferBuffer, true)};
+	if (!data)
+		throw SDLException{"Couldn't map " + name + " upload buffer"};
+	std::copy_n(static_cast<const Uint8 *>(elements), size, static_cast<Uint8 *>(data));
+	SDL_UnmapGPUTransferBuffer(device, transferBuffer);
+
+	auto copyPass{SDL_BeginGPUCopyPass(commandBuffer)};
+	const SDL_GPUTransferBufferLocation source{
+		.transfer_buffer = transferBuffer,
+	};
+	const SDL_GPUBufferRegion destination{
+		.buffer = buffer,
+		.offset = first * elementSize,
+		.size = size,
+	};
+	SDL_UploadToGPUBuffer(copyPass, &source, &destination, cycle);
+	SDL_EndGPUCopyPass(copyPass);
+}
+
+void OverlayVertexBuffer::Release() {
+	ReleaseTrackedBuffer(device, buffer);
+	ReleaseTrackedTransferBuffer(device, transferBuffer);
+	buffer = nullptr;
+	transferBuffer = nullptr;
+	capacity = 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <SDL3/SDL.h>
+
+// Shared by the renderers drawing over a finished frame, the text, debug draw and UI overlays
+
+// Alpha blended over the target's content without depth testing. The vertex shader takes one uniform buffer and the
+// fragment shader samplerCount samplers.
+SDL_GPUGraphicsPipeline *CreateOverlayPipeline(SDL_GPUDevice *device, SDL_GPUTextureFormat targetFormat,
+                                               const std::string &vertexShaderFilename,
+                                               const std::string &fragmentShaderFilename, Uint32 samplerCount,
+                                               const SDL_GPUVertexBufferDescription &vertexBuffer,
+                                               std::span<const SDL_GPUVertexAttribute> vertexAttributes,
+                                               SDL_GPUPrimitiveType primitiveType);
+
+// Clamps to the edge
+SDL_GPUSampler *CreateOverlaySampler(SDL_GPUDevice *device, SDL_GPUFilter filter);
+
+// A sampled texture holding the pixels, uploaded on a command buffer of its own
+SDL_GPUTexture *CreateOverlayAtlas(SDL_GPUDevice *device, SDL_GPUTextureFormat format, Uint32 width, Uint32 height,
+                                   std::span<const std::byte> pixels, const char *name);
+
+// Loads the target's content and binds the pipeline and the vertex buffer to slot 0
+SDL_GPURenderPass *BeginOverlayPass(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target,
+                                    SDL_GPUGraphicsPipeline *pipeline, SDL_GPUBuffer *vertexBuffer);
+
+// A vertex buffer and the upload buffer filling it, both recreated with the next power of two elements when too small
+class OverlayVertexBuffer {
+public:
+	// The buffers are named name and name followed by " Upload Buffer"
+	OverlayVertexBuffer(SDL_GPUDevice *device, Uint32 elementSize, Uint32 minCapacity, std::string name);
+
+	~OverlayVertexBuffer();
+
+	OverlayVertexBuffer(const OverlayVertexBuffer &) = delete;
+
+	OverlayVertexBuffer &operator=(const OverlayVertexBuffer &) = delete;
+
+	// Returns whether the buffers were recreated, which loses their content
+	bool Reserve(Uint32 count);
+
+	// Copies count elements to the buffer starting at element first. The upload buffer is cycled as earlier uploads
+	// may still be pending, cycling the vertex buffer as well is only allowed when all of its content is replaced.
+	void Upload(SDL_GPUCommandBuffer *commandBuffer, const void *elements, Uint32 first, Uint32 count, bool cycle);
+
+	[[nodiscard]] SDL_GPUBuffer *Get() const { return buffer; }
+
+	[[nodiscard]] Uint32 GetCapacity() const { return capacity; }
+
+	// Has to happen before the device is destroyed
+	void Release();
+
+private:
+	SDL_GPUDevice *device;
+	Uint32 elementSize;
+	Uint32 minCapacity;
+	std::string name;
+	SDL_GPUBuffer *buffer{};
+	SDL_GPUTransferBuffer *transferBuffer{};
+	Uint32 capacity{};
+};
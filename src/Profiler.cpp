@@ -0,0 +1,113 @@
+#include "Profiler.hpp"
+
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "Memory.hpp"
+
+namespace {
+	struct ProfilerRegistry {
+		std::mutex mutex;
+		// Buffers outlive their threads, so zones of finished threads still end up in traces
+		std::vector<std::unique_ptr<ProfilerThreadBuffer>> buffers;
+	};
+
+	// Never destroyed, threads may still record while static objects are destroyed
+	ProfilerRegistry &GetRegistry() {
+		static const auto registry{new ProfilerRegistry};
+		return *registry;
+	}
+
+	void WriteJsonString(std::ofstream &file, const std::string_view text) {
+		file << '"';
+		for (const auto character: text) {
+			if (character == '"' || character == '\\')
+				file << '\\' << character;
+			else if (static_cast<unsigned char>(character) < 0x20)
+				file << std::format("\\u{:04x}", character);
+			else
+				file << character;
+		}
+		file << '"';
+	}
+}
+
+ProfilerThreadBuffer &RegisterProfilerThread() {
+	// Lives until exit whichever subsystem's zone the thread recorded first
+	MemoryScope memoryScope{MemoryTag::General};
+	auto &registry{GetRegistry()};
+	std::lock_guard lock{registry.mutex};
+	auto &buffer{*registry.buffers.emplace_back(std::make_unique<ProfilerThreadBuffer>())};
+	buffer.threadName = std::format("Thread {}", SDL_GetCurrentThreadID());
+	return buffer;
+}
+
+void SetProfilerThreadName(std::string name) {
+	auto &buffer{GetProfilerThreadBuffer()};
+	MemoryScope memoryScope{MemoryTag::General};
+	std::lock_guard lock{GetRegistry().mutex};
+	buffer.threadName = std::move(name);
+}
+
+void ProfilerFrameMark() {
+	thread_local Uint64 previousMark{};
+	const auto now{SDL_GetPerformanceCounter()};
+	if (previousMark)
+		GetProfilerThreadBuffer().Record("Frame", previousMark, now);
+	previousMark = now;
+}
+
+void WriteChromeTrace(const std::filesystem::path &path) {
+	std::ofstream file{path};
+	if (!file)
+		throw std::runtime_error{"Couldn't open trace file"};
+
+	const auto ticksPerMicrosecond{static_cast<double>(SDL_GetPerformanceFrequency()) / 1e6};
+	std::vector<ProfilerThreadBuffer::Snapshot> events;
+	events.reserve(ProfilerThreadBuffer::Capacity);
+
+	auto &registry{GetRegistry()};
+	std::lock_guard lock{registry.mutex};
+	// Timestamps start at the oldest event, Chrome's viewer loses precision on large values
+	Uint64 origin{~Uint64{}};
+	for (const auto &buffer: registry.buffers) {
+		events.clear();
+		buffer->Read(events);
+		for (const auto &event: events)
+			origin = std::min(origin, event.begin);
+	}
+
+	file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+	auto isFirst{true};
+	for (size_t threadIndex{}; threadIndex < registry.buffers.size(); ++threadIndex) {
+		const auto &buffer{*registry.buffers[threadIndex]};
+		if (!isFirst)
+			file << ',';
+		isFirst = false;
+		file << std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":)", threadIndex);
+		WriteJsonString(file, buffer.threadName);
+		file << std::format(R"(}}}},{{"name":"thread_sort_index","ph":"M","pid":1,"tid":{},"args":{{"sort_index":{}}}}})",
+		                    threadIndex, threadIndex);
+
+		events.clear();
+		buffer.Read(events);
+		for (const auto &[name, begin, end]: events) {
+			if (begin < origin)
+				continue;
+			file << R"(,{"name":)";
+			WriteJsonString(file, name);
+			file << std::format(R"(,"ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})", threadIndex,
+			                    static_cast<double>(begin - origin) / ticksPerMicrosecond,
+			                    static_cast<double>(end - begin) / ticksPerMicrosecond);
+		}
+	}
+	file << "]}\n";
+
+	if (!file)
+		throw std::runtime_error{"Couldn't write trace file"};
+}
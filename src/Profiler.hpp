@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <SDL3/SDL.h>
+
+// Zones are recorded into a ring buffer owned by the recording thread, so recording takes no lock and the newest
+// events of every thread are always available. Only zones that ended are recorded.
+class ProfilerThreadBuffer {
+public:
+	static constexpr Uint64 Capacity{16 * 1024};
+
+	struct Event {
+		std::atomic<const char *> name;
+		std::atomic<Uint64> begin;
+		std::atomic<Uint64> end;
+	};
+
+	struct Snapshot {
+		const char *name;
+		Uint64 begin;
+		Uint64 end;
+	};
+
+	void Record(const char *name, const Uint64 begin, const Uint64 end) {
+		const auto index{head.load(std::memory_order_relaxed)};
+		// Announces the slot before touching it, so a reader can tell which of its copies may be torn
+		writing.store(index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		auto &event{events[index & (Capacity - 1)]};
+		event.name.store(name, std::memory_order_relaxed);
+		event.begin.store(begin, std::memory_order_relaxed);
+		event.end.store(end, std::memory_order_relaxed);
+		head.store(index + 1, std::memory_order_release);
+	}
+
+	// Copies the events still in the buffer, oldest first, while the owning thread keeps recording
+	template<typename Output>
+	void Read(Output &output) const {
+		const auto end{head.load(std::memory_order_acquire)};
+		const auto begin{end > Capacity ? end - Capacity : 0};
+		const auto first{output.size()};
+		for (auto index{begin}; index < end; ++index) {
+			const auto &event{events[index & (Capacity - 1)]};
+			output.push_back({
+				event.name.load(std::memory_order_relaxed),
+				event.begin.load(std::memory_order_relaxed),
+				event.end.load(std::memory_order_relaxed),
+			});
+		}
+
+		// Slots the owner started overwriting during the copy are dropped
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const auto written{writing.load(std::memory_order_relaxed)};
+		const auto validBegin{written > Capacity ? written - Capacity : 0};
+		if (validBegin > begin)
+			output.erase(output.begin() + static_cast<std::ptrdiff_t>(first),
+			             output.begin() + static_cast<std::ptrdiff_t>(first + std::min(validBegin, end) - begin));
+	}
+
+	// Guarded by the registry's mutex
+	std::string threadName;
+
+private:
+	std::atomic<Uint64> head{};
+	std::atomic<Uint64> writing{};
+	Event events[Capacity];
+};
+
+// Registers the calling thread on first use
+ProfilerThreadBuffer &RegisterProfilerThread();
+
+inline ProfilerThreadBuffer &GetProfilerThreadBuffer() {
+	thread_local auto buffer{&RegisterProfilerThread()};
+	return *buffer;
+}
+
+// Shown instead of the thread id in traces
+void SetProfilerThreadName(std::string name);
+
+// Records the time since the previous mark as a "Frame" zone, called at the top of the main loop
+void ProfilerFrameMark();
+
+// Writes the buffered zones of all threads in the Chrome trace event format, which Perfetto opens as well
+void WriteChromeTrace(const std::filesystem::path &path);
+
+class ProfileZone {
+public:
+	// The name has to outlive the trace, string literals are
+	explicit ProfileZone(const char *name) : name{name}, begin{SDL_GetPerformanceCounter()} {}
+
+	~ProfileZone() {
+		GetProfilerThreadBuffer().Record(name, begin, SDL_GetPerformanceCounter());
+	}
+
+	ProfileZone(const ProfileZone &) = delete;
+
+	ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+	const char *name;
+	Uint64 begin;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// Profiles the rest of the enclosing scope
+#define PROFILE_ZONE(name) const ProfileZone PROFILE_CONCAT(profileZone, __LINE__){name}
@@ -0,0 +1,172 @@
+#include "SceneRecording.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+
+namespace {
+	struct TemporalUniforms {
+		glm::mat4 jitteredModelViewProjection;
+		glm::mat4 modelViewProjection;
+		glm::mat4 previousModelViewProjection;
+	};
+
+	void RecordDraws(
+		SDL_GPUCommandBuffer *commandBuffer,
+		SDL_GPURenderPass *renderPass,
+		const FrameView &view,
+		const std::span<const DrawCommand> draws
+	) {
+		for (const auto &draw: draws) {
+			const auto modelViewProjectionMatrix{view.projectionView * draw.modelMatrix};
+			if (view.isTemporal) {
+				const TemporalUniforms temporalUniforms{
+					.jitteredModelViewProjection = view.jitter * modelViewProjectionMatrix,
+					.modelViewProjection = modelViewProjectionMatrix,
+					.previousModelViewProjection = view.previousProjectionView * draw.previousModelMatrix,
+				};
+				SDL_PushGPUVertexUniformData(commandBuffer, 0, &temporalUniforms, sizeof(temporalUniforms));
+			} else
+				SDL_PushGPUVertexUniformData(commandBuffer, 0, &modelViewProjectionMatrix,
+				                             sizeof(modelViewProjectionMatrix));
+
+			SDL_DrawGPUIndexedPrimitives(renderPass, draw.indexCount, 1, draw.firstIndex, draw.vertexOffset, 0);
+		}
+	}
+}
+
+void RecordScenePass(
+	SDL_GPUCommandBuffer *commandBuffer,
+	const ScenePass &pass,
+	const SceneBindings &bindings,
+	const FrameView &view,
+	const std::span<const DrawCommand> draws
+) {
+	PROFILE_ZONE("Record Scene Pass");
+	auto renderPass{
+		SDL_BeginGPURenderPass(commandBuffer, pass.colorTargets.data(), pass.colorTargetCount,
+		                       &pass.depthStencilTarget)
+	};
+	if (!renderPass)
+		throw SDLException{"Couldn't begin GPU render pass"};
+
+	SDL_BindGPUGraphicsPipeline(renderPass, bindings.pipeline);
+
+	std::array<SDL_GPUBufferBinding, 1> vertexBufferBindings{{bindings.vertexBuffer, 0}};
+	SDL_BindGPUVertexBuffers(renderPass, 0, vertexBufferBindings.data(), vertexBufferBindings.size());
+
+	SDL_GPUBufferBinding indexBufferBinding{bindings.indexBuffer, 0};
+	SDL_BindGPUIndexBuffer(renderPass, &indexBufferBinding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+
+	std::array<SDL_GPUTextureSamplerBinding, 1> textureSamplerBindings{{bindings.texture, bindings.sampler}};
+	SDL_BindGPUFragmentSamplers(renderPass, 0, textureSamplerBindings.data(), textureSamplerBindings.size());
+
+	RecordDraws(commandBuffer, renderPass, view, draws);
+
+	SDL_EndGPURenderPass(renderPass);
+}
+
+ParallelRecorder::ParallelRecorder(SDL_GPUDevice *device, JobSystem &jobSystem, const Uint32 maxChunkCount)
+	: device{device}, jobSystem{jobSystem}, maxChunkCount{std::min(maxChunkCount, jobSystem.GetThreadCount())} {
+}
+
+Uint32 ParallelRecorder::GetMaxChunkCount() const {
+	return maxChunkCount;
+}
+
+Uint32 ParallelRecorder::GetChunkCount(const size_t drawCount) const {
+	const auto chunks{std::min(static_cast<size_t>(maxChunkCount), drawCount / MinDrawsPerChunk)};
+	return chunks < 2 ? 0 : static_cast<Uint32>(chunks);
+}
+
+Uint32 ParallelRecorder::RecordAndSubmit(
+	const ScenePass &pass,
+	const SceneBindings &bindings,
+	const FrameView &view,
+	const std::span<const DrawCommand> draws
+) {
+	const auto chunkCount{GetChunkCount(draws.size())};
+	if (chunkCount == 0)
+		return 0;
+
+	{
+		PROFILE_ZONE("Clear Scene Targets");
+		auto commandBuffer{SDL_AcquireGPUCommandBuffer(device)};
+		if (!commandBuffer)
+			throw SDLException{"Couldn't acquire GPU command buffer"};
+		auto renderPass{
+			SDL_BeginGPURenderPass(commandBuffer, pass.colorTargets.data(), pass.colorTargetCount,
+			                       &pass.depthStencilTarget)
+		};
+		if (!renderPass) {
+			SDL_CancelGPUCommandBuffer(commandBuffer);
+			throw SDLException{"Couldn't begin GPU render pass"};
+		}
+		SDL_EndGPURenderPass(renderPass);
+		if (!SDL_SubmitGPUCommandBuffer(commandBuffer))
+			throw SDLException{"Couldn't submit GPU command buffer"};
+	}
+
+	auto chunkPass{pass};
+	for (auto &colorTarget: chunkPass.colorTargets)
+		colorTarget.load_op = SDL_GPU_LOADOP_LOAD;
+	chunkPass.depthStencilTarget.load_op = SDL_GPU_LOADOP_LOAD;
+
+	// Kept until every chunk finished, a chunk's exception must not leave the others recording
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	const auto setError{[&](std::exception_ptr chunkError) {
+		std::lock_guard lock{errorMutex};
+		if (!error)
+			error = std::move(chunkError);
+	}};
+	// Index of the chunk whose turn it is to submit. A job only waits on lower chunks and there are no more chunks than
+	// job system threads, so the lowest chunk not submitted yet always finds a thread to run on.
+	std::atomic<size_t> submitTurn{};
+	const auto chunkSize{(draws.size() + chunkCount - 1) / chunkCount};
+	ParallelFor(jobSystem, draws.size(), chunkSize, [&](const size_t begin, const size_t end) {
+		PROFILE_ZONE("Record Chunk");
+		const auto chunk{begin / chunkSize};
+		SDL_GPUCommandBuffer *commandBuffer{};
+		try {
+			commandBuffer = SDL_AcquireGPUCommandBuffer(device);
+			if (!commandBuffer)
+				throw SDLException{"Couldn't acquire GPU command buffer"};
+			RecordScenePass(commandBuffer, chunkPass, bindings, view, draws.subspan(begin, end - begin));
+		} catch (...) {
+			if (commandBuffer)
+				SDL_CancelGPUCommandBuffer(std::exchange(commandBuffer, nullptr));
+			setError(std::current_exception());
+		}
+
+		{
+			PROFILE_ZONE("Wait For Submit Turn");
+			for (auto turn{submitTurn.load()}; turn != chunk; turn = submitTurn.load())
+				submitTurn.wait(turn);
+		}
+		if (commandBuffer) {
+			bool hasFailed;
+			{
+				std::lock_guard lock{errorMutex};
+				hasFailed = error != nullptr;
+			}
+			// Later chunks are dropped once one failed, they would draw over a partial image
+			if (hasFailed)
+				SDL_CancelGPUCommandBuffer(commandBuffer);
+			else if (!SDL_SubmitGPUCommandBuffer(commandBuffer))
+				setError(std::make_exception_ptr(SDLException{"Couldn't submit GPU command buffer"}));
+		}
+		submitTurn.store(chunk + 1);
+		submitTurn.notify_all();
+	});
+	if (error)
+		std::rethrow_exception(error);
+
+	return chunkCount;
+}
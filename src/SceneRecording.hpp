@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+class JobSystem;
+
+struct DrawCommand {
+	glm::mat4 modelMatrix;
+	glm::mat4 previousModelMatrix;
+	Uint32 indexCount;
+	Uint32 firstIndex;
+	Sint32 vertexOffset;
+};
+
+struct SceneBindings {
+	SDL_GPUGraphicsPipeline *pipeline;
+	SDL_GPUBuffer *vertexBuffer;
+	SDL_GPUBuffer *indexBuffer;
+	SDL_GPUTexture *texture;
+	SDL_GPUSampler *sampler;
+};
+
+struct FrameView {
+	glm::mat4 projectionView;
+	glm::mat4 previousProjectionView;
+	// Sub-pixel TAA offset, identity otherwise
+	glm::mat4 jitter;
+	// Pushes current, previous and jittered transforms for the velocity pipeline instead of a single one
+	bool isTemporal;
+};
+
+struct ScenePass {
+	std::array<SDL_GPUColorTargetInfo, 2> colorTargets;
+	Uint32 colorTargetCount;
+	SDL_GPUDepthStencilTargetInfo depthStencilTarget;
+};
+
+void RecordScenePass(
+	SDL_GPUCommandBuffer *commandBuffer,
+	const ScenePass &pass,
+	const SceneBindings &bindings,
+	const FrameView &view,
+	std::span<const DrawCommand> draws
+);
+
+// Records large draw lists on the job system, each chunk into its own command buffer.
+// SDL GPU command buffers must stay on the thread that acquired them, so every job acquires, records and submits its
+// chunk. Chunks record in parallel but submit in list order, each job waiting for the previous chunk's submission:
+// the depth test keeps the first of equal depths, so any other order could change the image.
+class ParallelRecorder {
+public:
+	static constexpr size_t MinDrawsPerChunk{256};
+
+	// maxChunkCount caps the job system threads recording at once, 1 records every list inline
+	ParallelRecorder(SDL_GPUDevice *device, JobSystem &jobSystem, Uint32 maxChunkCount);
+
+	[[nodiscard]] Uint32 GetMaxChunkCount() const;
+
+	// Chunks a list of drawCount draws is split into, 0 when it's too small to split and should be recorded inline
+	[[nodiscard]] Uint32 GetChunkCount(size_t drawCount) const;
+
+	// Submits all chunks before returning so the caller's command buffer is queued after them, returns the chunk count
+	// and records nothing when it's 0.
+	// The pass must not resolve: resolving into the swapchain is left to the caller's command buffer.
+	Uint32 RecordAndSubmit(
+		const ScenePass &pass,
+		const SceneBindings &bindings,
+		const FrameView &view,
+		std::span<const DrawCommand> draws
+	);
+
+private:
+	SDL_GPUDevice *device;
+	JobSystem &jobSystem;
+	Uint32 maxChunkCount;
+};
@@ -0,0 +1,144 @@
+#include "ScreenshotCapture.hpp"
+
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <SDL3_image/SDL_image.h>
+
+#include "GpuResources.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+
+namespace {
+	SDL_PixelFormat GetPixelFormat(const SDL_GPUTextureFormat format) {
+		switch (format) {
+			case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+			case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB: return SDL_PIXELFORMAT_RGBA32;
+			case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+			case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB: return SDL_PIXELFORMAT_BGRA32;
+			case SDL_GPU_TEXTUREFORMAT_R10G10B10A2_UNORM: return SDL_PIXELFORMAT_ABGR2101010;
+			default: return SDL_PIXELFORMAT_UNKNOWN;
+		}
+	}
+}
+
+ScreenshotCapture::ScreenshotCapture(SDL_GPUDevice *device, JobSystem &jobSystem)
+	: device{device}, jobSystem{jobSystem} {}
+
+ScreenshotCapture::~ScreenshotCapture() {
+	Stop();
+}
+
+GpuFrameTimer::CompletionCallback ScreenshotCapture::Capture(SDL_GPUCommandBuffer *commandBuffer,
+                                                             SDL_GPUTexture *texture,
+                                                             const SDL_GPUTextureFormat format, const Uint32 width,
+                                                             const Uint32 height, std::filesystem::path path) {
+	const auto pixelFormat{GetPixelFormat(format)};
+	if (pixelFormat == SDL_PIXELFORMAT_UNKNOWN)
+		throw std::runtime_error{"Can't capture textures of format " + std::to_string(format)};
+
+	const auto pitch{width * SDL_GPUTextureFormatTexelBlockSize(format)};
+	PendingCapture capture{
+		.buffer = AcquireBuffer(pitch * height),
+		.pixelFormat = pixelFormat,
+		.width = width,
+		.height = height,
+		.pitch = pitch,
+		.path = std::move(path),
+	};
+
+	const SDL_GPUTextureRegion source{
+		.texture = texture,
+		.w = width,
+		.h = height,
+		.d = 1,
+	};
+	const SDL_GPUTextureTransferInfo destination{
+		.transfer_buffer = capture.buffer.transferBuffer,
+	};
+	auto copyPass{SDL_BeginGPUCopyPass(commandBuffer)};
+	SDL_DownloadFromGPUTexture(copyPass, &source, &destination);
+	SDL_EndGPUCopyPass(copyPass);
+
+	jobSystem.Acquire(pendingCaptures);
+	return [this, capture = std::move(capture)](const bool completed) mutable {
+		// The fence thread only hands the capture over, encoding takes longer than a frame
+		jobSystem.Run([this, capture = std::move(capture), completed] {
+			if (completed) {
+				try {
+					Save(capture);
+				} catch (const std::exception &exception) {
+					std::println("Couldn't save {}: {}", capture.path.string(), exception.what());
+				}
+			}
+			{
+				std::lock_guard lock{freeBuffersMutex};
+				freeBuffers.push_back(capture.buffer);
+			}
+			jobSystem.Release(pendingCaptures);
+		});
+	};
+}
+
+void ScreenshotCapture::Stop() {
+	jobSystem.Wait(pendingCaptures);
+	std::lock_guard lock{freeBuffersMutex};
+	for (const auto &buffer: freeBuffers)
+		ReleaseTrackedTransferBuffer(device, buffer.transferBuffer);
+	freeBuffers.clear();
+}
+
+ScreenshotCapture::DownloadBuffer ScreenshotCapture::AcquireBuffer(const Uint32 size) {
+	{
+		std::lock_guard lock{freeBuffersMutex};
+		for (auto buffer{freeBuffers.begin()}; buffer != freeBuffers.end(); ++buffer)
+			if (buffer->size >= size) {
+				const auto result{*buffer};
+				freeBuffers.erase(buffer);
+				return result;
+			}
+	}
+
+	const SDL_GPUTransferBufferCreateInfo createInfo{
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+		.size = size,
+	};
+	const DownloadBuffer buffer{
+		.transferBuffer = CreateTrackedTransferBuffer(device, createInfo, MemoryTag::Rendering, "Screenshot Download"),
+		.size = size,
+	};
+	if (!buffer.transferBuffer)
+		throw SDLException{"Couldn't create screenshot download buffer"};
+	return buffer;
+}
+
+void ScreenshotCapture::Save(const PendingCapture &capture) {
+	PROFILE_ZONE("Save Screenshot");
+	auto pixels{SDL_MapGPUTransferBuffer(device, capture.buffer.transferBuffer, false)};
+	if (!pixels)
+		throw SDLException{"Couldn't map screenshot download buffer"};
+
+	// Converting copies the pixels out, so the buffer is unmapped before the slow part
+	auto mapped{
+		SDL_CreateSurfaceFrom(static_cast<int>(capture.width), static_cast<int>(capture.height), capture.pixelFormat,
+		                      pixels, static_cast<int>(capture.pitch))
+	};
+	auto surface{mapped ? SDL_ConvertSurface(mapped, SDL_PIXELFORMAT_RGBA32) : nullptr};
+	SDL_DestroySurface(mapped);
+	SDL_UnmapGPUTransferBuffer(device, capture.buffer.transferBuffer);
+	if (!surface)
+		throw SDLException{"Couldn't convert screenshot"};
+
+	// Whatever the frame left in the alpha channel isn't meant to be seen
+	for (int y{}; y < surface->h; ++y) {
+		auto row{static_cast<Uint8 *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch};
+		for (int x{}; x < surface->w; ++x)
+			row[x * 4 + 3] = 255;
+	}
+
+	const auto saved{IMG_SavePNG(surface, capture.path.string().c_str())};
+	SDL_DestroySurface(surface);
+	if (!saved)
+		throw SDLException{"Couldn't save screenshot"};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "GpuFrameTimer.hpp"
+#include "JobSystem.hpp"
+
+// Reads textures back without stalling the frame: the copy into a download buffer is recorded into the frame's command
+// buffer, the frame's fence is waited for by the GpuFrameTimer thread and the PNG is encoded on the job system. Download
+// buffers are reused by later captures that fit.
+class ScreenshotCapture {
+public:
+	ScreenshotCapture(SDL_GPUDevice *device, JobSystem &jobSystem);
+
+	~ScreenshotCapture();
+
+	ScreenshotCapture(const ScreenshotCapture &) = delete;
+
+	ScreenshotCapture &operator=(const ScreenshotCapture &) = delete;
+
+	// Records the copy after everything already in the command buffer. The texture has to be one of the engine's own,
+	// swapchain textures aren't guaranteed to support downloads. The returned callback has to be passed to
+	// GpuFrameTimer::Submit with the same command buffer.
+	GpuFrameTimer::CompletionCallback Capture(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *texture,
+	                                          SDL_GPUTextureFormat format, Uint32 width, Uint32 height,
+	                                          std::filesystem::path path);
+
+	// Waits until the captures of all submitted frames are written and releases the download buffers, has to happen
+	// after GpuFrameTimer::Stop and before the device is destroyed
+	void Stop();
+
+private:
+	struct DownloadBuffer {
+		SDL_GPUTransferBuffer *transferBuffer;
+		Uint32 size;
+	};
+
+	struct PendingCapture {
+		DownloadBuffer buffer;
+		SDL_PixelFormat pixelFormat;
+		Uint32 width;
+		Uint32 height;
+		Uint32 pitch;
+		std::filesystem::path path;
+	};
+
+	DownloadBuffer AcquireBuffer(Uint32 size);
+
+	void Save(const PendingCapture &capture);
+
+	SDL_GPUDevice *device;
+	JobSystem &jobSystem;
+	JobCounter pendingCaptures;
+
+	std::mutex freeBuffersMutex;
+	std::vector<DownloadBuffer> freeBuffers;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+// The vector instruction set the CPU image loops are written for: SSE2, which every x86-64 CPU has, or NEON on AArch64.
+// Other targets run only the scalar loops.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ENGINE_NEON
+#endif
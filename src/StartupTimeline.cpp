@@ -0,0 +1,84 @@
+#include "StartupTimeline.hpp"
+
+#include <algorithm>
+#include <print>
+#include <unordered_set>
+
+namespace {
+	constexpr size_t BarWidth{40};
+}
+
+StartupTimeline::StartupTimeline() : origin{SDL_GetPerformanceCounter()}, mainThreadStepBegin{origin} {}
+
+void StartupTimeline::Add(Step step) {
+	std::lock_guard lock{mutex};
+	steps.push_back(std::move(step));
+}
+
+void StartupTimeline::EndMainThreadStep(std::string name, std::vector<std::string> dependencies) {
+	const auto end{SDL_GetPerformanceCounter()};
+	Add({
+		.name = std::move(name),
+		.begin = std::exchange(mainThreadStepBegin, end),
+		.end = end,
+		.isMainThread = true,
+		.dependencies = std::move(dependencies),
+	});
+}
+
+double StartupTimeline::GetElapsed() const {
+	return static_cast<double>(SDL_GetPerformanceCounter() - origin) * 1000.0 /
+	       static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+void StartupTimeline::Print() const {
+	std::vector<Step> sortedSteps;
+	{
+		std::lock_guard lock{mutex};
+		sortedSteps = steps;
+	}
+	if (sortedSteps.empty())
+		return;
+	std::ranges::sort(sortedSteps, {}, &Step::begin);
+
+	// Walks back from the step that finished last, through whichever of its inputs finished last
+	std::unordered_set<const Step *> criticalPath;
+	const Step *current{&*std::ranges::max_element(sortedSteps, {}, &Step::end)};
+	while (current) {
+		criticalPath.insert(current);
+		const Step *predecessor{};
+		for (const auto &step: sortedSteps) {
+			if (&step == current || step.end > current->end || criticalPath.contains(&step))
+				continue;
+			const auto isInput{
+				std::ranges::find(current->dependencies, step.name) != current->dependencies.end() ||
+				(current->isMainThread && step.isMainThread && step.end <= current->begin)
+			};
+			if (isInput && (!predecessor || step.end > predecessor->end))
+				predecessor = &step;
+		}
+		current = predecessor;
+	}
+
+	const auto frequency{static_cast<double>(SDL_GetPerformanceFrequency())};
+	const auto toMilliseconds{
+		[this, frequency](const Uint64 ticks) { return static_cast<double>(ticks - origin) * 1000.0 / frequency; }
+	};
+	const auto total{toMilliseconds(std::ranges::max(sortedSteps, {}, &Step::end).end)};
+	const auto toColumn{
+		[&](const Uint64 ticks) {
+			return std::min(static_cast<size_t>(toMilliseconds(ticks) / total * BarWidth), BarWidth - 1);
+		}
+	};
+
+	std::println("Startup timeline, {:.1f} ms in total, * marks the critical path", total);
+	std::println("  {:>8} {:>8}  {:<6} {}", "begin ms", "end ms", "thread", "step");
+	for (const auto &step: sortedSteps) {
+		std::string bar(BarWidth, ' ');
+		std::fill(bar.begin() + static_cast<std::ptrdiff_t>(toColumn(step.begin)),
+		          bar.begin() + static_cast<std::ptrdiff_t>(toColumn(step.end)) + 1, '#');
+		std::println("{} {:8.1f} {:8.1f}  {:<6} {:<28} |{}|", criticalPath.contains(&step) ? '*' : ' ',
+		             toMilliseconds(step.begin), toMilliseconds(step.end), step.isMainThread ? "main" : "jobs",
+		             step.name, bar);
+	}
+}
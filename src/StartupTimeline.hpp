@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "Task.hpp"
+
+// Steps of the startup along with the steps whose results they consume, used to find the critical path: the chain of
+// steps that kept the window from showing up sooner
+class StartupTimeline {
+public:
+	struct Step {
+		std::string name;
+		Uint64 begin;
+		Uint64 end;
+		// Main thread steps run one after the other, so each also waits for the main thread step before it
+		bool isMainThread;
+		std::vector<std::string> dependencies;
+	};
+
+	StartupTimeline();
+
+	// Thread-safe
+	void Add(Step step);
+
+	// Main thread steps follow each other, so each one lasts from the end of the previous one (or the creation of the
+	// timeline) until now
+	void EndMainThreadStep(std::string name, std::vector<std::string> dependencies = {});
+
+	// Milliseconds since the timeline was created
+	[[nodiscard]] double GetElapsed() const;
+
+	// Every step on a bar chart with the critical path marked
+	void Print() const;
+
+private:
+	Uint64 origin;
+	Uint64 mainThreadStepBegin;
+	mutable std::mutex mutex;
+	std::vector<Step> steps;
+};
+
+// Adds the task as a step lasting from when it starts until it finishes, the timeline has to outlive it
+template<typename T>
+Task<T> TimeStartupStep(StartupTimeline &timeline, std::string name, Task<T> task,
+                        std::vector<std::string> dependencies = {}) {
+	const auto begin{SDL_GetPerformanceCounter()};
+	auto result{co_await std::move(task)};
+	timeline.Add({
+		.name = std::move(name),
+		.begin = begin,
+		.end = SDL_GetPerformanceCounter(),
+		.isMainThread = false,
+		.dependencies = std::move(dependencies),
+	});
+	co_return result;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+// Nearest rank on sorted values, the smallest value with at least percentile % of the values at or below it
+inline double Percentile(const std::span<const double> sorted, const double percentile) {
+	const auto rank{static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sorted.size())))};
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
@@ -0,0 +1,113 @@
+#include "StressScene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <print>
+#include <random>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "CommandLine.hpp"
+#include "Statistics.hpp"
+
+namespace {
+	// Room given to every object, about the size of the loaded mesh
+	constexpr float ObjectSpacing{2.0f};
+	constexpr Uint64 CameraOrbitFrames{1200};
+
+	void PrintTimes(const std::string_view name, std::vector<double> times) {
+		std::ranges::sort(times);
+		double sum{};
+		for (const auto time: times)
+			sum += time;
+		std::println("{:<8} mean {:7.3f} ms, median {:7.3f}, p90 {:7.3f}, p99 {:7.3f}, max {:7.3f}", name,
+		             sum / static_cast<double>(times.size()), Percentile(times, 50.0), Percentile(times, 90.0),
+		             Percentile(times, 99.0), times.back());
+	}
+}
+
+std::optional<StressSceneSettings> ParseStressSceneSettings(const std::span<char *> arguments) {
+	if (!FindOption(arguments, "stress"))
+		return std::nullopt;
+	return StressSceneSettings{
+		.objectCount = FindUnsignedOption(arguments, "stress").value_or(1),
+		.frameCount = FindUnsignedOption(arguments, "stress-frames", 1u).value_or(1000),
+		.warmUpFrameCount = FindUnsignedOption(arguments, "stress-warm-up").value_or(60),
+		.seed = FindUnsignedOption(arguments, "stress-seed").value_or(1234),
+	};
+}
+
+float SpawnStressScene(World &world, TransformHierarchy &transformHierarchy, const MeshInstance &mesh,
+                       const StressSceneSettings &settings) {
+	const auto halfExtent{std::cbrt(static_cast<float>(settings.objectCount)) * ObjectSpacing * 0.5f};
+	// The distributions' output isn't specified by the standard, the engine's is
+	std::mt19937 random{settings.seed};
+	const auto uniform{
+		[&random](const float min, const float max) {
+			return min + (max - min) * static_cast<float>(random() >> 8) / static_cast<float>(1u << 24);
+		}
+	};
+	const auto randomDirection{
+		[&uniform] {
+			const auto z{uniform(-1.0f, 1.0f)};
+			const auto angle{uniform(0.0f, glm::two_pi<float>())};
+			const auto radius{std::sqrt(1.0f - z * z)};
+			return glm::vec3{radius * std::cos(angle), radius * std::sin(angle), z};
+		}
+	};
+
+	for (Uint32 i{}; i < settings.objectCount; ++i) {
+		const LocalTransform localTransform{
+			.position = {
+				uniform(-halfExtent, halfExtent), uniform(-halfExtent, halfExtent), uniform(-halfExtent, halfExtent)
+			},
+			.rotation = angleAxis(uniform(0.0f, glm::two_pi<float>()), randomDirection()),
+		};
+		world.Create(
+			TransformNode{transformHierarchy.Create(NoParent, localTransform)},
+			WorldTransform{},
+			Spin{.axis = randomDirection(), .radiansPerSecond = glm::radians(uniform(20.0f, 180.0f))},
+			mesh
+		);
+	}
+	return halfExtent * std::sqrt(3.0f);
+}
+
+glm::mat4 GetStressCameraView(const Uint64 frameIndex, const float sceneRadius) {
+	const auto phase{
+		static_cast<float>(frameIndex % CameraOrbitFrames) / static_cast<float>(CameraOrbitFrames) * glm::two_pi<float>()
+	};
+	const auto distance{sceneRadius + 2.0f};
+	const glm::vec3 eye{
+		distance * std::sin(phase), distance * 0.5f * std::sin(phase * 2.0f), distance * std::cos(phase)
+	};
+	return lookAt(eye, glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+}
+
+void PrintStressSceneReport(const StressSceneSettings &settings, const std::span<const StressFrameSample> samples,
+                            const GpuFrameStats &gpuStats) {
+	if (samples.empty())
+		return;
+
+	std::vector<double> frameTimes, recordTimes, submitTimes;
+	double drawCount{}, triangleCount{};
+	for (const auto &sample: samples) {
+		frameTimes.push_back(sample.frameTime);
+		recordTimes.push_back(sample.recordTime);
+		submitTimes.push_back(sample.submitTime);
+		drawCount += sample.drawCount;
+		triangleCount += static_cast<double>(sample.triangleCount);
+	}
+	const auto frameCount{static_cast<double>(samples.size())};
+
+	std::println("Stress scene: {} objects, seed {}, {} frames after {} warm-up frames", settings.objectCount,
+	             settings.seed, samples.size(), settings.warmUpFrameCount);
+	PrintTimes("Frame", std::move(frameTimes));
+	PrintTimes("Record", std::move(recordTimes));
+	PrintTimes("Submit", std::move(submitTimes));
+	if (gpuStats.frameCount)
+		std::println("GPU      mean {:7.3f} ms, max {:7.3f}, {} of {} frames GPU bound",
+		             gpuStats.gpuTime / gpuStats.frameCount, gpuStats.maxGpuTime, gpuStats.gpuBoundFrameCount,
+		             gpuStats.frameCount);
+	std::println("Draws {:.0f}, triangles {:.0f} per frame", drawCount / frameCount, triangleCount / frameCount);
+}
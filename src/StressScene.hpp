@@ -0,0 +1,44 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+#include "Components.hpp"
+#include "Ecs.hpp"
+#include "GpuFrameTimer.hpp"
+#include "TransformHierarchy.hpp"
+
+struct StressSceneSettings {
+	Uint32 objectCount;
+	// Measured frames, the warm-up frames before them aren't reported
+	Uint32 frameCount;
+	Uint32 warmUpFrameCount;
+	Uint32 seed;
+};
+
+// Set when --stress=objectCount was passed, --stress-frames, --stress-warm-up and --stress-seed override the defaults
+std::optional<StressSceneSettings> ParseStressSceneSettings(std::span<char *> arguments);
+
+// Spawns objectCount spinning instances of the mesh at the same positions and rotations for the same seed. The volume
+// grows with the count so the density stays the same, returns the radius of the sphere containing it.
+float SpawnStressScene(World &world, TransformHierarchy &transformHierarchy, const MeshInstance &mesh,
+                       const StressSceneSettings &settings);
+
+// Orbits the scene while bobbing up and down, driven by the frame index so every run sees the same views
+glm::mat4 GetStressCameraView(Uint64 frameIndex, float sceneRadius);
+
+// CPU times in milliseconds
+struct StressFrameSample {
+	double frameTime;
+	double recordTime;
+	double submitTime;
+	Uint32 drawCount;
+	Uint64 triangleCount;
+};
+
+// Means and percentiles of the samples, gpuStats covers the same frames
+void PrintStressSceneReport(const StressSceneSettings &settings, std::span<const StressFrameSample> samples,
+                            const GpuFrameStats &gpuStats);
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "JobSystem.hpp"
+
+template<typename T = void>
+class Task;
+
+namespace TaskDetail {
+	struct PromiseBase {
+		// Hands control straight to whoever awaited the task instead of growing the stack
+		struct FinalAwaiter {
+			bool await_ready() noexcept { return false; }
+
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+				if (const auto continuation{handle.promise().continuation})
+					return continuation;
+				return std::noop_coroutine();
+			}
+
+			void await_resume() noexcept {}
+		};
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+
+		FinalAwaiter final_suspend() noexcept { return {}; }
+
+		void unhandled_exception() noexcept { error = std::current_exception(); }
+
+		std::coroutine_handle<> continuation;
+		std::exception_ptr error;
+	};
+
+	template<typename T>
+	struct Promise : PromiseBase {
+		Task<T> get_return_object() noexcept;
+
+		template<typename U = T>
+		void return_value(U &&value) { result.emplace(std::forward<U>(value)); }
+
+		T TakeResult() {
+			if (error)
+				std::rethrow_exception(error);
+			return std::move(*result);
+		}
+
+		std::optional<T> result;
+	};
+
+	template<>
+	struct Promise<void> : PromiseBase {
+		Task<void> get_return_object() noexcept;
+
+		void return_void() noexcept {}
+
+		void TakeResult() const {
+			if (error)
+				std::rethrow_exception(error);
+		}
+	};
+
+	// Starts immediately and frees itself when done, used to drive tasks nobody co_awaits
+	struct DetachedTask {
+		struct promise_type {
+			DetachedTask get_return_object() noexcept { return {}; }
+
+			std::suspend_never initial_suspend() noexcept { return {}; }
+
+			std::suspend_never final_suspend() noexcept { return {}; }
+
+			void return_void() noexcept {}
+
+			void unhandled_exception() noexcept { std::terminate(); }
+		};
+	};
+
+	// Void tasks leave an empty element in WhenAll's tuple
+	template<typename T>
+	using WhenAllElement = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+	template<typename... Ts>
+	using WhenAllResult = std::conditional_t<(std::is_void_v<Ts> && ...), void, std::tuple<WhenAllElement<Ts>...>>;
+}
+
+// How WhenAll releases the result of a task that succeeded while another one failed. Results owning resources without
+// a destructor specialize it, everything else is released by its destructor.
+template<typename T>
+struct DiscardTaskResult {
+	void operator()(T &) const noexcept {}
+};
+
+// Lazily started coroutine: the body runs once the task is co_awaited and the awaiting coroutine resumes on whichever
+// thread finished the task. Results and exceptions are passed to the awaiter.
+template<typename T>
+class [[nodiscard]] Task {
+public:
+	using promise_type = TaskDetail::Promise<T>;
+
+	Task() = default;
+
+	explicit Task(const std::coroutine_handle<promise_type> handle) : handle{handle} {}
+
+	Task(Task &&other) noexcept : handle{std::exchange(other.handle, nullptr)} {}
+
+	Task &operator=(Task &&other) noexcept {
+		if (this != &other) {
+			if (handle)
+				handle.destroy();
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+
+	~Task() {
+		if (handle)
+			handle.destroy();
+	}
+
+	auto operator co_await() && noexcept {
+		struct Awaiter {
+			std::coroutine_handle<promise_type> handle;
+
+			bool await_ready() const noexcept { return handle.done(); }
+
+			std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) noexcept {
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			T await_resume() { return handle.promise().TakeResult(); }
+		};
+		return Awaiter{handle};
+	}
+
+private:
+	template<typename U>
+	friend U SyncWait(JobSystem &jobSystem, Task<U> task);
+
+	template<typename U>
+	friend class RunningTask;
+
+	template<typename... Ts>
+	friend class WhenAllAwaiter;
+
+	template<typename... Ts>
+	friend Task<TaskDetail::WhenAllResult<Ts...>> WhenAll(JobSystem &jobSystem, Task<Ts>... tasks);
+
+	// Like co_await but leaves the result (or exception) in the promise for TakeResult
+	auto Completion() noexcept {
+		struct Awaiter {
+			std::coroutine_handle<promise_type> handle;
+
+			bool await_ready() const noexcept { return handle.done(); }
+
+			std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) noexcept {
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			void await_resume() const noexcept {}
+		};
+		return Awaiter{handle};
+	}
+
+	T TakeResult() { return handle.promise().TakeResult(); }
+
+	TaskDetail::WhenAllElement<T> TakeElement() {
+		if constexpr (std::is_void_v<T>) {
+			TakeResult();
+			return {};
+		} else
+			return TakeResult();
+	}
+
+	[[nodiscard]] bool HasFailed() const { return handle.promise().error != nullptr; }
+
+	// Keeps the first failure's exception, releases a successful result with DiscardTaskResult
+	void Discard(std::exception_ptr &firstError) {
+		auto &promise{handle.promise()};
+		if (promise.error) {
+			if (!firstError)
+				firstError = promise.error;
+		} else if constexpr (!std::is_void_v<T>)
+			DiscardTaskResult<T>{}(*promise.result);
+	}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T>
+Task<T> TaskDetail::Promise<T>::get_return_object() noexcept {
+	return Task<T>{std::coroutine_handle<Promise>::from_promise(*this)};
+}
+
+inline Task<void> TaskDetail::Promise<void>::get_return_object() noexcept {
+	return Task<void>{std::coroutine_handle<Promise>::from_promise(*this)};
+}
+
+// co_await ScheduleOn{jobSystem} moves the rest of the coroutine onto a job system thread
+struct ScheduleOn {
+	JobSystem &jobSystem;
+
+	bool await_ready() const noexcept { return false; }
+
+	void await_suspend(const std::coroutine_handle<> handle) const {
+		jobSystem.Run([handle] { handle.resume(); });
+	}
+
+	void await_resume() const noexcept {}
+};
+
+// co_await ResumeOnMainThread{jobSystem} continues on the main thread, for SDL calls that have to happen there
+struct ResumeOnMainThread {
+	JobSystem &jobSystem;
+
+	bool await_ready() const noexcept { return jobSystem.IsMainThread(); }
+
+	void await_suspend(const std::coroutine_handle<> handle) const {
+		jobSystem.RunOnMainThread([handle] { handle.resume(); });
+	}
+
+	void await_resume() const noexcept {}
+};
+
+template<typename... Ts>
+class WhenAllAwaiter {
+public:
+	WhenAllAwaiter(JobSystem &jobSystem, Task<Ts> &... tasks) : jobSystem{jobSystem}, tasks{tasks...} {}
+
+	bool await_ready() const noexcept { return false; }
+
+	bool await_suspend(const std::coroutine_handle<> handle) {
+		continuation = handle;
+		// The extra count keeps the last task from resuming the awaiter while tasks are still being started
+		remaining.store(sizeof...(Ts) + 1, std::memory_order_relaxed);
+		std::apply([this](auto &... task) { (Start(*this, task), ...); }, tasks);
+		return remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+	}
+
+	void await_resume() const noexcept {}
+
+private:
+	template<typename T>
+	static TaskDetail::DetachedTask Start(WhenAllAwaiter &self, Task<T> &task) {
+		co_await ScheduleOn{self.jobSystem};
+		co_await task.Completion();
+		if (self.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			self.continuation.resume();
+	}
+
+	JobSystem &jobSystem;
+	std::tuple<Task<Ts> &...> tasks;
+	std::atomic<size_t> remaining;
+	std::coroutine_handle<> continuation;
+};
+
+// Runs the tasks concurrently on the job system and resumes once all of them finished, with a tuple of their results or
+// nothing when every task is void. When tasks fail, the results of the others are released with DiscardTaskResult and
+// the exception of the first failed task in argument order is rethrown.
+template<typename... Ts>
+Task<TaskDetail::WhenAllResult<Ts...>> WhenAll(JobSystem &jobSystem, Task<Ts>... tasks) {
+	co_await WhenAllAwaiter<Ts...>{jobSystem, tasks...};
+	if ((tasks.HasFailed() || ...)) {
+		std::exception_ptr error;
+		(tasks.Discard(error), ...);
+		std::rethrow_exception(error);
+	}
+	if constexpr (std::is_void_v<TaskDetail::WhenAllResult<Ts...>>)
+		co_return;
+	else
+		co_return TaskDetail::WhenAllResult<Ts...>{tasks.TakeElement()...};
+}
+
+// Blocks until the task finished, executing other jobs (including main thread jobs) in the meantime
+template<typename T>
+T SyncWait(JobSystem &jobSystem, Task<T> task) {
+	JobCounter counter;
+	jobSystem.Acquire(counter);
+	[](JobSystem &jobSystem, JobCounter &counter, Task<T> &task) -> TaskDetail::DetachedTask {
+		co_await task.Completion();
+		jobSystem.Release(counter);
+	}(jobSystem, counter, task);
+	jobSystem.Wait(counter);
+	return task.TakeResult();
+}
+
+// Starts the task on the job system right away so it makes progress while the caller does other work, unlike a Task
+// which only runs once awaited. The task's main thread parts run while the main thread waits in Get.
+template<typename T>
+class RunningTask {
+public:
+	RunningTask(JobSystem &jobSystem, Task<T> task) : jobSystem{jobSystem}, task{std::move(task)} {
+		jobSystem.Acquire(counter);
+		[](RunningTask &self) -> TaskDetail::DetachedTask {
+			co_await ScheduleOn{self.jobSystem};
+			co_await self.task.Completion();
+			self.jobSystem.Release(self.counter);
+		}(*this);
+	}
+
+	~RunningTask() {
+		jobSystem.Wait(counter);
+	}
+
+	RunningTask(const RunningTask &) = delete;
+
+	RunningTask &operator=(const RunningTask &) = delete;
+
+	// Blocks like SyncWait, can only be called once
+	T Get() {
+		jobSystem.Wait(counter);
+		return task.TakeResult();
+	}
+
+private:
+	JobSystem &jobSystem;
+	Task<T> task;
+	JobCounter counter;
+};
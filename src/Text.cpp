@@ -0,0 +1,286 @@
+#include "Text.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "DebugFont.hpp"
+#include "GpuResources.hpp"
+#include "JobSystem.hpp"
+#include "Memory.hpp"
+#include "OverlayRendering.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+
+namespace {
+
+	// Distance field texels per font pixel, and font pixels of distance stored around each glyph. The spread is how far
+	// outlines and shadows could reach, the resolution how well corners survive magnification.
+	constexpr int TexelsPerPixel{4};
+	constexpr int Spread{2};
+	constexpr int CellSize{(DebugFont::Size + 2 * Spread) * TexelsPerPixel};
+	constexpr Uint32 AtlasColumns{16};
+	constexpr Uint32 AtlasRows{(DebugFont::GlyphCount + AtlasColumns - 1) / AtlasColumns};
+
+	constexpr float LineSpacing{1.25f};
+	constexpr Uint32 MinInstanceCapacity{256};
+
+	struct TextUniforms {
+		glm::vec2 inverseTargetSize;
+		glm::vec2 padding;
+	};
+
+	bool IsPixelSet(const Uint64 bitmap, const int x, const int y) {
+		return bitmap >> (y * DebugFont::Size + x) & 1;
+	}
+
+	float SquaredDistanceToPixel(const glm::vec2 point, const int x, const int y) {
+		const auto dx{std::max({static_cast<float>(x) - point.x, 0.0f, point.x - static_cast<float>(x + 1)})};
+		const auto dy{std::max({static_cast<float>(y) - point.y, 0.0f, point.y - static_cast<float>(y + 1)})};
+		return dx * dx + dy * dy;
+	}
+
+	// The glyph is a union of square pixels, so the exact distance to its outline is the distance to the nearest pixel
+	// of the other kind, with everything outside the bitmap counting as background
+	void GenerateGlyphField(const Uint64 bitmap, Uint8 *cell, const Uint32 pitch) {
+		for (int texelY{}; texelY < CellSize; ++texelY)
+			for (int texelX{}; texelX < CellSize; ++texelX) {
+				const glm::vec2 point{
+					(static_cast<float>(texelX) + 0.5f) / TexelsPerPixel - Spread,
+					(static_cast<float>(texelY) + 0.5f) / TexelsPerPixel - Spread,
+				};
+				auto toGlyph{std::numeric_limits<float>::infinity()};
+				const auto toEdge{
+					std::max(0.0f, std::min({point.x, point.y, DebugFont::Size - point.x, DebugFont::Size - point.y}))
+				};
+				auto toBackground{toEdge * toEdge};
+				for (int y{}; y < DebugFont::Size; ++y)
+					for (int x{}; x < DebugFont::Size; ++x) {
+						auto &nearest{IsPixelSet(bitmap, x, y) ? toGlyph : toBackground};
+						nearest = std::min(nearest, SquaredDistanceToPixel(point, x, y));
+					}
+
+				const auto signedDistance{toGlyph > 0.0f ? -std::sqrt(toGlyph) : std::sqrt(toBackground)};
+				const auto value{std::clamp(0.5f + signedDistance / (2.0f * Spread), 0.0f, 1.0f)};
+				cell[texelY * pitch + texelX] = static_cast<Uint8>(std::lround(value * 255.0f));
+			}
+	}
+
+	glm::vec4 GetTexCoordRectangle(const char character) {
+		const auto glyph{static_cast<Uint32>(character - DebugFont::FirstCharacter)};
+		const auto atlasWidth{static_cast<float>(AtlasColumns * CellSize)};
+		const auto atlasHeight{static_cast<float>(AtlasRows * CellSize)};
+		return {
+			static_cast<float>(glyph % AtlasColumns * CellSize) / atlasWidth,
+			static_cast<float>(glyph / AtlasColumns * CellSize) / atlasHeight,
+			CellSize / atlasWidth,
+			CellSize / atlasHeight,
+		};
+	}
+}
+
+std::vector<Uint64> RasterizeDebugFont() {
+	PROFILE_ZONE("Rasterize Debug Font");
+	auto surface{SDL_CreateSurface(DebugFont::GlyphCount * DebugFont::Size, DebugFont::Size, SDL_PIXELFORMAT_RGBA32)};
+	if (!surface)
+		throw SDLException{"Couldn't create font surface"};
+	auto renderer{SDL_CreateSoftwareRenderer(surface)};
+	if (!renderer) {
+		SDL_DestroySurface(surface);
+		throw SDLException{"Couldn't create font renderer"};
+	}
+
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+	SDL_RenderClear(renderer);
+	SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+	for (Uint32 glyph{}; glyph < DebugFont::GlyphCount; ++glyph) {
+		const std::array character{static_cast<char>(DebugFont::FirstCharacter + glyph), '\0'};
+		SDL_RenderDebugText(renderer, static_cast<float>(glyph * DebugFont::Size), 0.0f, character.data());
+	}
+	SDL_FlushRenderer(renderer);
+
+	std::vector<Uint64> bitmaps(DebugFont::GlyphCount);
+	for (Uint32 glyph{}; glyph < DebugFont::GlyphCount; ++glyph)
+		for (int y{}; y < DebugFont::Size; ++y)
+			for (int x{}; x < DebugFont::Size; ++x) {
+				Uint8 r, g, b, a;
+				if (SDL_ReadSurfacePixel(surface, static_cast<int>(glyph) * DebugFont::Size + x, y, &r, &g, &b, &a) &&
+				    r > 127)
+					bitmaps[glyph] |= Uint64{1} << (y * DebugFont::Size + x);
+			}
+
+	SDL_DestroyRenderer(renderer);
+	SDL_DestroySurface(surface);
+	return bitmaps;
+}
+
+Task<FontAtlas> GenerateFontAtlasAsync(JobSystem &jobSystem, const std::vector<Uint64> glyphBitmaps) {
+	co_await ScheduleOn{jobSystem};
+	PROFILE_ZONE("Generate Font Atlas");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	FontAtlas atlas{
+		.width = AtlasColumns * CellSize,
+		.height = AtlasRows * CellSize,
+	};
+	atlas.pixels.resize(static_cast<size_t>(atlas.width) * atlas.height);
+	ParallelFor(jobSystem, glyphBitmaps.size(), 8, [&](const size_t begin, const size_t end) {
+		for (auto glyph{begin}; glyph < end; ++glyph) {
+			const auto column{glyph % AtlasColumns};
+			const auto row{glyph / AtlasColumns};
+			GenerateGlyphField(glyphBitmaps[glyph], atlas.pixels.data() + (row * atlas.width + column) * CellSize,
+			                   atlas.width);
+		}
+	});
+	co_return atlas;
+}
+
+TextRenderer::TextRenderer(SDL_GPUDevice *device, const SDL_GPUTextureFormat targetFormat, const FontAtlas &atlas)
+	: device{device},
+	  instanceBuffer{device, sizeof(GlyphInstance), MinInstanceCapacity, "Glyph Instances"} {
+	// Every glyph is one instance, the vertex shader makes its quad's corners from the vertex index
+	constexpr SDL_GPUVertexBufferDescription vertexBufferDescription{
+		.slot = 0,
+		.pitch = sizeof(GlyphInstance),
+		.input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE,
+	};
+	constexpr std::array<SDL_GPUVertexAttribute, 3> vertexAttributes{
+		{
+			{0, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(GlyphInstance, rectangle)},
+			{1, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(GlyphInstance, texCoordRectangle)},
+			{2, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(GlyphInstance, color)},
+		}
+	};
+	pipeline = CreateOverlayPipeline(device, targetFormat, "SdfText.vert", "SdfText.frag", 1, vertexBufferDescription,
+	                                 vertexAttributes, SDL_GPU_PRIMITIVETYPE_TRIANGLELIST);
+	sampler = CreateOverlaySampler(device, SDL_GPU_FILTER_LINEAR);
+	atlasTexture = CreateOverlayAtlas(device, SDL_GPU_TEXTUREFORMAT_R8_UNORM, atlas.width, atlas.height,
+	                                  std::as_bytes(std::span{atlas.pixels}), "Font Atlas");
+}
+
+TextRenderer::~TextRenderer() {
+	Release();
+}
+
+TextId TextRenderer::Create() {
+	TextId id;
+	if (freeIds.empty()) {
+		id = static_cast<TextId>(texts.size());
+		texts.emplace_back();
+	} else {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	texts[id] = {.isAlive = true};
+	return id;
+}
+
+void TextRenderer::Set(const TextId id, const std::string_view text, const glm::vec2 position, const float size,
+                       const glm::vec4 color) {
+	auto &entry{texts[id]};
+	if (entry.layout.text != text || entry.layout.size != size) {
+		entry.layout.text = text;
+		entry.layout.size = size;
+		Layout(entry.layout);
+		isDirty = true;
+	}
+	if (entry.position != position || entry.color != color) {
+		entry.position = position;
+		entry.color = color;
+		isDirty = true;
+	}
+}
+
+void TextRenderer::SetVisible(const TextId id, const bool isVisible) {
+	isDirty |= texts[id].isVisible != isVisible;
+	texts[id].isVisible = isVisible;
+}
+
+void TextRenderer::Destroy(const TextId id) {
+	texts[id] = {};
+	freeIds.push_back(id);
+	isDirty = true;
+}
+
+void TextRenderer::Layout(TextLayout &layout) const {
+	layout.glyphs.clear();
+	const auto scale{layout.size / DebugFont::Size};
+	const auto quadSize{CellSize / static_cast<float>(TexelsPerPixel) * scale};
+	glm::vec2 pen{};
+	for (auto character: layout.text) {
+		if (character == '\n') {
+			pen = {0.0f, pen.y + layout.size * LineSpacing};
+			continue;
+		}
+		if (character < DebugFont::FirstCharacter || character > DebugFont::LastCharacter)
+			character = '?';
+		if (character != ' ')
+			layout.glyphs.push_back({
+				.rectangle = {pen - glm::vec2{Spread * scale}, quadSize, quadSize},
+				.texCoordRectangle = GetTexCoordRectangle(character),
+			});
+		pen.x += layout.size;
+	}
+}
+
+void TextRenderer::Upload(SDL_GPUCommandBuffer *commandBuffer) {
+	PROFILE_ZONE("Upload Text");
+	instances.clear();
+	for (const auto &text: texts) {
+		if (!text.isAlive || !text.isVisible)
+			continue;
+		for (auto glyph: text.layout.glyphs) {
+			glyph.rectangle.x += text.position.x;
+			glyph.rectangle.y += text.position.y;
+			glyph.color = text.color;
+			instances.push_back(glyph);
+		}
+	}
+	glyphCount = static_cast<Uint32>(instances.size());
+	isDirty = false;
+	if (!glyphCount)
+		return;
+
+	instanceBuffer.Reserve(glyphCount);
+	// Cycling hands out fresh memory while earlier frames may still read the previous glyphs
+	instanceBuffer.Upload(commandBuffer, instances.data(), 0, glyphCount, true);
+}
+
+void TextRenderer::Record(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target, const Uint32 width,
+                          const Uint32 height) {
+	if (isDirty)
+		Upload(commandBuffer);
+	if (!glyphCount)
+		return;
+
+	PROFILE_ZONE("Record Text");
+	auto renderPass{BeginOverlayPass(commandBuffer, target, pipeline, instanceBuffer.Get())};
+	const SDL_GPUTextureSamplerBinding atlasBinding{
+		.texture = atlasTexture,
+		.sampler = sampler,
+	};
+	SDL_BindGPUFragmentSamplers(renderPass, 0, &atlasBinding, 1);
+
+	const TextUniforms uniforms{
+		.inverseTargetSize = glm::vec2{1.0f / static_cast<float>(width), 1.0f / static_cast<float>(height)},
+	};
+	SDL_PushGPUVertexUniformData(commandBuffer, 0, &uniforms, sizeof(uniforms));
+
+	SDL_DrawGPUPrimitives(renderPass, 6, glyphCount, 0, 0);
+	SDL_EndGPURenderPass(renderPass);
+}
+
+Uint32 TextRenderer::GetGlyphCount() const {
+	return glyphCount;
+}
+
+void TextRenderer::Release() {
+	SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+	SDL_ReleaseGPUSampler(device, sampler);
+	ReleaseTrackedTexture(device, atlasTexture);
+	instanceBuffer.Release();
+	pipeline = nullptr;
+	sampler = nullptr;
+	atlasTexture = nullptr;
+	glyphCount = 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+#include "OverlayRendering.hpp"
+#include "Task.hpp"
+
+// Single channel signed distance field of the printable ASCII characters, 0.5 on the glyph outlines and higher inside
+struct FontAtlas {
+	std::vector<Uint8> pixels;
+	Uint32 width{};
+	Uint32 height{};
+};
+
+// 8x8 bitmaps of the printable ASCII characters of SDL's built-in debug font, one bit per pixel with the top row in the
+// lowest byte. Draws them with a software renderer, so it has to run on the main thread.
+std::vector<Uint64> RasterizeDebugFont();
+
+// Computes the distance field of the bitmaps on the job system
+Task<FontAtlas> GenerateFontAtlasAsync(JobSystem &jobSystem, std::vector<Uint64> glyphBitmaps);
+
+using TextId = Uint32;
+
+// Draws all texts as instanced glyph quads in a single draw call. Each text keeps its layout until its string or size
+// changes, and the glyph quads of all texts are only gathered and uploaded again in frames where any text changed.
+class TextRenderer {
+public:
+	TextRenderer(SDL_GPUDevice *device, SDL_GPUTextureFormat targetFormat, const FontAtlas &atlas);
+
+	~TextRenderer();
+
+	TextRenderer(const TextRenderer &) = delete;
+
+	TextRenderer &operator=(const TextRenderer &) = delete;
+
+	TextId Create();
+
+	// Position is the top left corner and size the height of a character cell in pixels, the font is drawn at 8.
+	// Setting the same values again costs nothing.
+	void Set(TextId id, std::string_view text, glm::vec2 position, float size, glm::vec4 color);
+
+	void SetVisible(TextId id, bool isVisible);
+
+	void Destroy(TextId id);
+
+	// Uploads the glyphs if anything changed and draws them over the target's content
+	void Record(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target, Uint32 width, Uint32 height);
+
+	[[nodiscard]] Uint32 GetGlyphCount() const;
+
+	// Has to happen before the device is destroyed
+	void Release();
+
+private:
+	struct GlyphInstance {
+		// Pixels, left, top, width and height
+		glm::vec4 rectangle;
+		glm::vec4 texCoordRectangle;
+		glm::vec4 color;
+	};
+
+	// Glyph quads of a text at the origin, only laid out again when the string or size changes
+	struct TextLayout {
+		std::string text;
+		float size{};
+		std::vector<GlyphInstance> glyphs;
+	};
+
+	struct Text {
+		TextLayout layout;
+		glm::vec2 position{};
+		glm::vec4 color{};
+		bool isVisible{true};
+		bool isAlive{};
+	};
+
+	void Layout(TextLayout &layout) const;
+
+	void Upload(SDL_GPUCommandBuffer *commandBuffer);
+
+	SDL_GPUDevice *device;
+	SDL_GPUGraphicsPipeline *pipeline{};
+	SDL_GPUTexture *atlasTexture{};
+	SDL_GPUSampler *sampler{};
+
+	std::vector<Text> texts;
+	std::vector<TextId> freeIds;
+	bool isDirty{};
+
+	std::vector<GlyphInstance> instances;
+	OverlayVertexBuffer instanceBuffer;
+	Uint32 glyphCount{};
+};
@@ -0,0 +1,393 @@
+#include "TextureConversion.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#include "HdrImage.hpp"
+#include "Memory.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+#include "Simd.hpp"
+
+namespace {
+	// 65536 and above round to infinity
+	constexpr Uint32 HalfOverflow{(127 + 16) << 23};
+	// 2^-14, the smallest normal half
+	constexpr Uint32 HalfMinNormal{(127 - 14) << 23};
+	// Adding 0.5 leaves the subnormal half's mantissa, rounded, in the lowest bits
+	constexpr Uint32 SubnormalMagic{(127 - 15 + 23 - 10 + 1) << 23};
+	// Rebiases the exponent and rounds half way cases down, odd mantissas add one more to round them up
+	constexpr Uint32 NormalBias{0xfffu - ((127u - 15u) << 23)};
+
+	// One value at a time, for targets without SIMD and the tails of the vector loops
+	Uint16 ToHalf(const float value) {
+		const auto bits{std::bit_cast<Uint32>(value)};
+		const auto sign{bits & 0x80000000u};
+		const auto magnitude{bits ^ sign};
+		Uint32 half;
+		if (magnitude >= HalfOverflow)
+			half = magnitude > 0x7f800000u ? 0x7e00 : 0x7c00;
+		else if (magnitude < HalfMinNormal)
+			half = std::bit_cast<Uint32>(std::bit_cast<float>(magnitude) + std::bit_cast<float>(SubnormalMagic)) -
+			       SubnormalMagic;
+		else
+			half = (magnitude + NormalBias + (magnitude >> 13 & 1)) >> 13;
+		return static_cast<Uint16>(half | sign >> 16);
+	}
+
+#if defined(ENGINE_SSE2)
+	__m128i Select(const __m128i condition, const __m128i whenTrue, const __m128i whenFalse) {
+		return _mm_or_si128(_mm_and_si128(condition, whenTrue), _mm_andnot_si128(condition, whenFalse));
+	}
+
+	// Four halves in the low 16 bits of 32-bit lanes
+	__m128i ToHalf(const __m128 values) {
+		const auto bits{_mm_castps_si128(values)};
+		const auto sign{_mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x80000000u)))};
+		const auto magnitude{_mm_xor_si128(bits, sign)};
+		const auto isNan{_mm_castps_si128(_mm_cmpunord_ps(values, values))};
+		const auto special{_mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00))};
+
+		const auto subnormalMagic{_mm_set1_epi32(static_cast<int>(SubnormalMagic))};
+		const auto subnormal{
+			_mm_sub_epi32(
+				_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), _mm_castsi128_ps(subnormalMagic))),
+				subnormalMagic)
+		};
+		// All ones for odd mantissas, subtracting it adds one
+		const auto isOdd{_mm_srai_epi32(_mm_slli_epi32(magnitude, 18), 31)};
+		const auto normal{
+			_mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(static_cast<int>(NormalBias))), isOdd),
+			               13)
+		};
+
+		const auto isSubnormal{_mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(HalfMinNormal)), magnitude)};
+		const auto isFinite{_mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(HalfOverflow)), magnitude)};
+		return _mm_or_si128(Select(isFinite, Select(isSubnormal, subnormal, normal), special), _mm_srli_epi32(sign, 16));
+	}
+
+	// Packs the low 16 bits of eight 32-bit lanes. Sign extending them first lets the signed pack keep them intact.
+	__m128i PackLow16(const __m128i low, const __m128i high) {
+		return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(low, 16), 16),
+		                       _mm_srai_epi32(_mm_slli_epi32(high, 16), 16));
+	}
+#endif
+
+	struct SourceChannels {
+		Uint32 count;
+		Uint32 bitsPerChannel;
+	};
+
+	SourceChannels GetSourceChannels(SDL_Surface *image) {
+		const auto format{image->format};
+		if (SDL_ISPIXELFORMAT_INDEXED(format)) {
+			// Grayscale images decode to a palette of grays
+			const auto palette{SDL_GetSurfacePalette(image)};
+			if (!palette)
+				return {4, 8};
+			auto isGray{true};
+			auto isOpaque{true};
+			for (int i{}; i < palette->ncolors; ++i) {
+				const auto &color{palette->colors[i]};
+				isGray = isGray && color.r == color.g && color.g == color.b;
+				isOpaque = isOpaque && color.a == 255;
+			}
+			return {isOpaque ? isGray ? 1u : 3u : 4u, 8};
+		}
+
+		const auto count{SDL_ISPIXELFORMAT_ALPHA(format) ? 4u : 3u};
+		if (SDL_ISPIXELFORMAT_10BIT(format))
+			return {count, 10};
+		if (SDL_ISPIXELFORMAT_ARRAY(format))
+			switch (SDL_PIXELTYPE(format)) {
+				case SDL_PIXELTYPE_ARRAYU16:
+				case SDL_PIXELTYPE_ARRAYF16: return {count, 16};
+				case SDL_PIXELTYPE_ARRAYF32: return {count, 32};
+				default: break;
+			}
+		return {count, 8};
+	}
+
+	// Layouts that are read as they are for a texture format, SDL converts the others to RGBA first
+	bool CanReadDirectly(SDL_Surface *image, const SDL_GPUTextureFormat format) {
+		switch (format) {
+			case SDL_GPU_TEXTUREFORMAT_R8_UNORM:
+			case SDL_GPU_TEXTUREFORMAT_R8G8_UNORM:
+			case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+				return image->format == SDL_PIXELFORMAT_RGBA32 || image->format == SDL_PIXELFORMAT_RGB24 ||
+				       (image->format == SDL_PIXELFORMAT_INDEX8 && SDL_GetSurfacePalette(image));
+			case SDL_GPU_TEXTUREFORMAT_R16_UNORM:
+				return image->format == SDL_PIXELFORMAT_RGBA64 || image->format == SDL_PIXELFORMAT_RGB48;
+			case SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT:
+				return image->format == SDL_PIXELFORMAT_RGBA128_FLOAT || image->format == SDL_PIXELFORMAT_RGB96_FLOAT;
+			default: return false;
+		}
+	}
+
+	// Of the layouts CanReadDirectly accepts, except INDEX8
+	Uint32 GetChannelsPerPixel(const SDL_PixelFormat format) {
+		const auto isRgb{
+			format == SDL_PIXELFORMAT_RGB24 || format == SDL_PIXELFORMAT_RGB48 || format == SDL_PIXELFORMAT_RGB96_FLOAT
+		};
+		return isRgb ? 3 : 4;
+	}
+
+	// The first channelCount (1, 2 or 4) channels of the palette colors of INDEX8 pixels
+	void LookUpPalette(const Uint8 *indices, const size_t pixelCount, const SDL_Palette &palette,
+	                   const Uint32 channelCount, Uint8 *output) {
+		std::array<std::array<Uint8, 4>, 256> colors{};
+		for (int i{}; i < std::min(palette.ncolors, 256); ++i) {
+			const auto &color{palette.colors[i]};
+			colors[i] = {color.r, color.g, color.b, color.a};
+		}
+		for (size_t i{}; i < pixelCount; ++i)
+			std::copy_n(colors[indices[i]].data(), channelCount, output + i * channelCount);
+	}
+
+	// RGB96 float pixels as RGBA16F with alpha 1
+	void ConvertRgbToHalf(const float *pixels, const size_t pixelCount, Uint16 *output) {
+		constexpr Uint16 HalfOne{0x3c00};
+		for (size_t i{}; i < pixelCount; ++i) {
+			for (size_t channel{}; channel < 3; ++channel)
+				output[i * 4 + channel] = ToHalf(pixels[i * 3 + channel]);
+			output[i * 4 + 3] = HalfOne;
+		}
+	}
+}
+
+std::string_view ToString(const TextureUsage usage) {
+	switch (usage) {
+		case TextureUsage::Color: return "color";
+		case TextureUsage::Mask: return "mask";
+		case TextureUsage::TwoChannel: return "two-channel";
+		case TextureUsage::Height: return "height";
+		case TextureUsage::Hdr: return "hdr";
+	}
+	return "unknown";
+}
+
+SDL_GPUTextureFormat ChooseTextureFormat(const TextureUsage usage, const Uint32 sourceChannelCount,
+                                         const Uint32 sourceBitsPerChannel) {
+	switch (usage) {
+		case TextureUsage::Color: return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+		case TextureUsage::Mask: return SDL_GPU_TEXTUREFORMAT_R8_UNORM;
+		case TextureUsage::TwoChannel:
+			return sourceChannelCount == 1 ? SDL_GPU_TEXTUREFORMAT_R8_UNORM : SDL_GPU_TEXTUREFORMAT_R8G8_UNORM;
+		case TextureUsage::Height:
+			return sourceBitsPerChannel > 8 ? SDL_GPU_TEXTUREFORMAT_R16_UNORM : SDL_GPU_TEXTUREFORMAT_R8_UNORM;
+		case TextureUsage::Hdr: return SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT;
+	}
+	return SDL_GPU_TEXTUREFORMAT_INVALID;
+}
+
+void ExtractChannels(const Uint8 *pixels, const size_t pixelCount, const Uint32 pixelSize, const Uint32 channelCount,
+                     Uint8 *output) {
+	if (channelCount != 1 && channelCount != 2)
+		throw std::runtime_error{"Only one or two channels can be extracted"};
+	if (pixelSize != 3 && pixelSize != 4)
+		throw std::runtime_error{"Only channels of three or four channel pixels can be extracted"};
+
+	size_t i{};
+#if defined(ENGINE_SSE2)
+	const auto load{
+		[pixels](const size_t pixel) {
+			return _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + pixel * 4));
+		}
+	};
+	if (pixelSize == 4 && channelCount == 1) {
+		const auto mask{_mm_set1_epi32(0xFF)};
+		for (; i + 16 <= pixelCount; i += 16) {
+			const auto low{_mm_packs_epi32(_mm_and_si128(load(i), mask), _mm_and_si128(load(i + 4), mask))};
+			const auto high{_mm_packs_epi32(_mm_and_si128(load(i + 8), mask), _mm_and_si128(load(i + 12), mask))};
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packus_epi16(low, high));
+		}
+	} else if (pixelSize == 4)
+		for (; i + 8 <= pixelCount; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i * 2), PackLow16(load(i), load(i + 4)));
+#elif defined(ENGINE_NEON)
+	if (pixelSize == 4 && channelCount == 1)
+		for (; i + 16 <= pixelCount; i += 16)
+			vst1q_u8(output + i, vld4q_u8(pixels + i * 4).val[0]);
+	else if (pixelSize == 4)
+		for (; i + 16 <= pixelCount; i += 16) {
+			const auto channels{vld4q_u8(pixels + i * 4)};
+			vst2q_u8(output + i * 2, uint8x16x2_t{channels.val[0], channels.val[1]});
+		}
+	else if (channelCount == 1)
+		for (; i + 16 <= pixelCount; i += 16)
+			vst1q_u8(output + i, vld3q_u8(pixels + i * 3).val[0]);
+	else
+		for (; i + 16 <= pixelCount; i += 16) {
+			const auto channels{vld3q_u8(pixels + i * 3)};
+			vst2q_u8(output + i * 2, uint8x16x2_t{channels.val[0], channels.val[1]});
+		}
+#endif
+	if (channelCount == 1)
+		for (; i < pixelCount; ++i)
+			output[i] = pixels[i * pixelSize];
+	else
+		for (; i < pixelCount; ++i) {
+			output[i * 2] = pixels[i * pixelSize];
+			output[i * 2 + 1] = pixels[i * pixelSize + 1];
+		}
+}
+
+void ExtractFirstChannel16(const Uint16 *pixels, const size_t pixelCount, const Uint32 pixelSize, Uint16 *output) {
+	if (pixelSize != 3 && pixelSize != 4)
+		throw std::runtime_error{"Only channels of three or four channel pixels can be extracted"};
+
+	size_t i{};
+#if defined(ENGINE_SSE2)
+	// The first two channels of four pixels as 32-bit lanes
+	const auto firstChannels{
+		[pixels](const size_t pixel) {
+			const auto left{_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + pixel * 4))};
+			const auto right{_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + pixel * 4 + 8))};
+			return _mm_unpacklo_epi64(_mm_shuffle_epi32(left, _MM_SHUFFLE(3, 1, 2, 0)),
+			                          _mm_shuffle_epi32(right, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+	};
+	if (pixelSize == 4)
+		for (; i + 8 <= pixelCount; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+			                 PackLow16(firstChannels(i), firstChannels(i + 4)));
+#elif defined(ENGINE_NEON)
+	if (pixelSize == 4)
+		for (; i + 8 <= pixelCount; i += 8)
+			vst1q_u16(output + i, vld4q_u16(pixels + i * 4).val[0]);
+	else
+		for (; i + 8 <= pixelCount; i += 8)
+			vst1q_u16(output + i, vld3q_u16(pixels + i * 3).val[0]);
+#endif
+	for (; i < pixelCount; ++i)
+		output[i] = pixels[i * pixelSize];
+}
+
+void ExpandToRgba(const Uint8 *pixels, const size_t pixelCount, Uint8 *output) {
+	size_t i{};
+#if defined(ENGINE_NEON)
+	for (; i + 16 <= pixelCount; i += 16) {
+		const auto channels{vld3q_u8(pixels + i * 3)};
+		vst4q_u8(output + i * 4, uint8x16x4_t{channels.val[0], channels.val[1], channels.val[2], vdupq_n_u8(255)});
+	}
+#elif SDL_BYTEORDER == SDL_LIL_ENDIAN
+	// A whole word per pixel, the byte after it belongs to the next one so the last pixel is left to the loop below
+	for (; i + 1 < pixelCount; ++i) {
+		Uint32 pixel;
+		std::memcpy(&pixel, pixels + i * 3, sizeof(pixel));
+		pixel |= 0xff000000u;
+		std::memcpy(output + i * 4, &pixel, sizeof(pixel));
+	}
+#endif
+	for (; i < pixelCount; ++i) {
+		output[i * 4] = pixels[i * 3];
+		output[i * 4 + 1] = pixels[i * 3 + 1];
+		output[i * 4 + 2] = pixels[i * 3 + 2];
+		output[i * 4 + 3] = 255;
+	}
+}
+
+void ConvertToHalf(const float *values, const size_t count, Uint16 *output) {
+	size_t i{};
+#if defined(ENGINE_SSE2)
+	for (; i + 8 <= count; i += 8)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+		                 PackLow16(ToHalf(_mm_loadu_ps(values + i)), ToHalf(_mm_loadu_ps(values + i + 4))));
+#elif defined(ENGINE_NEON)
+	for (; i + 8 <= count; i += 8) {
+		const auto halves{vcombine_f16(vcvt_f16_f32(vld1q_f32(values + i)), vcvt_f16_f32(vld1q_f32(values + i + 4)))};
+		vst1q_u16(output + i, vreinterpretq_u16_f16(halves));
+	}
+#endif
+	for (; i < count; ++i)
+		output[i] = ToHalf(values[i]);
+}
+
+TextureImage CreateTextureImage(JobSystem &jobSystem, SDL_Surface *image, const TextureUsage usage,
+                                const TextureQuality quality) {
+	PROFILE_ZONE("Create Texture Image");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	const auto [channelCount, bitsPerChannel]{GetSourceChannels(image)};
+	TextureImage result{.format = ChooseTextureFormat(usage, channelCount, bitsPerChannel)};
+
+	// Other layouts are converted to the SDL surface format with the same channel type, the downscale needs RGBA32.
+	// SDL linearizes sRGB images converted to float, like an sRGB texture would when sampled.
+	auto surfaceFormat{SDL_PIXELFORMAT_RGBA32};
+	if (result.format == SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT)
+		surfaceFormat = SDL_PIXELFORMAT_RGBA128_FLOAT;
+	else if (result.format == SDL_GPU_TEXTUREFORMAT_R16_UNORM)
+		surfaceFormat = SDL_PIXELFORMAT_RGBA64;
+	const auto isDownscaled{surfaceFormat == SDL_PIXELFORMAT_RGBA32 && quality != TextureQuality::Full};
+	const auto isDirect{
+		isDownscaled ? image->format == SDL_PIXELFORMAT_RGBA32 : CanReadDirectly(image, result.format)
+	};
+	auto converted{isDirect ? image : SDL_ConvertSurface(image, surfaceFormat)};
+	if (!converted)
+		throw SDLException{"Couldn't convert image"};
+	if (isDownscaled) {
+		const auto downscaled{DownscaleImage(jobSystem, converted, GetHalvingCount(quality))};
+		if (converted != image)
+			SDL_DestroySurface(converted);
+		converted = downscaled;
+	}
+
+	result.width = static_cast<Uint32>(converted->w);
+	result.height = static_cast<Uint32>(converted->h);
+	const auto texelSize{SDL_GPUTextureFormatTexelBlockSize(result.format)};
+	const auto rowSize{static_cast<size_t>(result.width) * texelSize};
+	const auto palette{converted->format == SDL_PIXELFORMAT_INDEX8 ? SDL_GetSurfacePalette(converted) : nullptr};
+	const auto pixelSize{GetChannelsPerPixel(converted->format)};
+	result.pixels.resize(rowSize * result.height);
+	for (Uint32 y{}; y < result.height; ++y) {
+		const auto source{static_cast<const Uint8 *>(converted->pixels) + static_cast<size_t>(y) * converted->pitch};
+		const auto destination{result.pixels.data() + y * rowSize};
+		if (palette) {
+			LookUpPalette(source, result.width, *palette, texelSize, destination);
+			continue;
+		}
+		switch (result.format) {
+			case SDL_GPU_TEXTUREFORMAT_R8_UNORM:
+			case SDL_GPU_TEXTUREFORMAT_R8G8_UNORM:
+				ExtractChannels(source, result.width, pixelSize, texelSize, destination);
+				break;
+			case SDL_GPU_TEXTUREFORMAT_R16_UNORM:
+				ExtractFirstChannel16(reinterpret_cast<const Uint16 *>(source), result.width, pixelSize,
+				                      reinterpret_cast<Uint16 *>(destination));
+				break;
+			case SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT:
+				if (pixelSize == 3)
+					ConvertRgbToHalf(reinterpret_cast<const float *>(source), result.width,
+					                 reinterpret_cast<Uint16 *>(destination));
+				else
+					ConvertToHalf(reinterpret_cast<const float *>(source), static_cast<size_t>(result.width) * 4,
+					              reinterpret_cast<Uint16 *>(destination));
+				break;
+			default:
+				if (pixelSize == 3)
+					ExpandToRgba(source, result.width, destination);
+				else
+					std::copy_n(source, rowSize, destination);
+				break;
+		}
+	}
+
+	if (converted != image)
+		SDL_DestroySurface(converted);
+	return result;
+}
+
+TextureImage CreateTextureImage(const HdrImage &image) {
+	PROFILE_ZONE("Create Texture Image");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	TextureImage result{
+		.width = image.width,
+		.height = image.height,
+		.format = SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT,
+	};
+	result.pixels.resize(image.pixels.size() * sizeof(Uint16));
+	ConvertToHalf(image.pixels.data(), image.pixels.size(), reinterpret_cast<Uint16 *>(result.pixels.data()));
+	return result;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "TextureQuality.hpp"
+
+class JobSystem;
+struct HdrImage;
+
+// What a texture is sampled for, which decides how many channels and how much precision it keeps on the GPU
+enum class TextureUsage {
+	// RGBA8, there's no swizzle to broadcast a single channel
+	Color,
+	// R8 from the first channel, for masks, roughness and occlusion
+	Mask,
+	// RG8 from the first two channels, like packed roughness and metalness or normal XY. R8 for grayscale images.
+	TwoChannel,
+	// R16 from the first channel of 16-bit images, R8 from 8-bit ones
+	Height,
+	// RGBA16F
+	Hdr,
+};
+
+// Pixels ready to upload, rows without padding in the layout of format
+struct TextureImage {
+	std::vector<Uint8> pixels;
+	Uint32 width{};
+	Uint32 height{};
+	SDL_GPUTextureFormat format{SDL_GPU_TEXTUREFORMAT_INVALID};
+};
+
+std::string_view ToString(TextureUsage usage);
+
+SDL_GPUTextureFormat ChooseTextureFormat(TextureUsage usage, Uint32 sourceChannelCount, Uint32 sourceBitsPerChannel);
+
+// The first channelCount (1 or 2) channels of 8-bit pixels with pixelSize (3 or 4) channels, RGB24 or RGBA32
+void ExtractChannels(const Uint8 *pixels, size_t pixelCount, Uint32 pixelSize, Uint32 channelCount, Uint8 *output);
+
+// The first channel of 16-bit pixels with pixelSize (3 or 4) channels, SDL_PIXELFORMAT_RGB48 or RGBA64
+void ExtractFirstChannel16(const Uint16 *pixels, size_t pixelCount, Uint32 pixelSize, Uint16 *output);
+
+// RGB24 pixels as RGBA32 with alpha 255
+void ExpandToRgba(const Uint8 *pixels, size_t pixelCount, Uint8 *output);
+
+// Rounds to the nearest half float, even on ties, like F16C and NEON conversions. Overflow becomes infinity and NaNs
+// stay NaNs. The SSE2, NEON and scalar paths give identical results.
+void ConvertToHalf(const float *values, size_t count, Uint16 *output);
+
+// Converts a decoded image to the format chosen from its channels and the usage. RGB24, RGBA32, INDEX8, RGB48, RGBA64,
+// RGB96 and RGBA128 float images are read as they are, SDL converts other layouts first. Lower qualities shrink 8-bit
+// images with DownscaleImage first, 16-bit and float images keep their size.
+TextureImage CreateTextureImage(JobSystem &jobSystem, SDL_Surface *image, TextureUsage usage,
+                                TextureQuality quality);
+
+TextureImage CreateTextureImage(const HdrImage &image);
@@ -0,0 +1,137 @@
+#include "TextureQuality.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "CommandLine.hpp"
+#include "JobSystem.hpp"
+#include "Memory.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+#include "Simd.hpp"
+
+namespace {
+	// Destination pixels per job
+	constexpr size_t GrainSize{16384};
+
+	// The tail of every row, and whole rows on targets without SIMD
+	void HalveRowScalar(const Uint8 *top, const Uint8 *bottom, const Uint32 begin, const Uint32 width,
+	                    Uint8 *destination) {
+		for (auto x{begin}; x < width; x += 2) {
+			const auto right{std::min(x + 1, width - 1)};
+			for (Uint32 channel{}; channel < 4; ++channel)
+				destination[x * 2 + channel] = static_cast<Uint8>(
+					(top[x * 4 + channel] + top[right * 4 + channel] + bottom[x * 4 + channel] +
+					 bottom[right * 4 + channel] + 2) >> 2);
+		}
+	}
+
+#if defined(ENGINE_SSE2)
+	// Four pixels of both rows to two destination pixels as 16-bit lanes
+	__m128i HalvePixels(const __m128i top, const __m128i bottom) {
+		const auto zero{_mm_setzero_si128()};
+		const auto left{_mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero))};
+		const auto right{_mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero))};
+		const auto sum{_mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right))};
+		return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+	}
+#endif
+
+	// Averages the 2x2 blocks of two rows into one, 8 source pixels per iteration with SSE2 and 16 with NEON
+	void HalveRow(const Uint8 *top, const Uint8 *bottom, const Uint32 width, Uint8 *destination) {
+		Uint32 x{};
+#if defined(ENGINE_SSE2)
+		for (; x + 8 <= width; x += 8) {
+			const auto left{
+				HalvePixels(_mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x * 4)),
+				            _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x * 4)))
+			};
+			const auto right{
+				HalvePixels(_mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x * 4 + 16)),
+				            _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x * 4 + 16)))
+			};
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 2), _mm_packus_epi16(left, right));
+		}
+#elif defined(ENGINE_NEON)
+		for (; x + 16 <= width; x += 16) {
+			const auto topPixels{vld4q_u8(top + x * 4)};
+			const auto bottomPixels{vld4q_u8(bottom + x * 4)};
+			uint8x8x4_t result;
+			for (int channel{}; channel < 4; ++channel)
+				result.val[channel] = vrshrn_n_u16(
+					vaddq_u16(vpaddlq_u8(topPixels.val[channel]), vpaddlq_u8(bottomPixels.val[channel])), 2);
+			vst4_u8(destination + x * 2, result);
+		}
+#endif
+		HalveRowScalar(top, bottom, x, width, destination);
+	}
+
+	SDL_Surface *Halve(JobSystem &jobSystem, const SDL_Surface *source) {
+		PROFILE_ZONE("Halve Image");
+		auto destination{SDL_CreateSurface((source->w + 1) / 2, (source->h + 1) / 2, source->format)};
+		if (!destination)
+			throw SDLException{"Couldn't create surface"};
+
+		const auto width{static_cast<Uint32>(source->w)};
+		const auto height{static_cast<Uint32>(source->h)};
+		const auto sourcePixels{static_cast<const Uint8 *>(source->pixels)};
+		const auto destinationPixels{static_cast<Uint8 *>(destination->pixels)};
+		const auto grainSize{std::max<size_t>(GrainSize / static_cast<size_t>(destination->w), 1)};
+		ParallelFor(jobSystem, static_cast<size_t>(destination->h), grainSize, [&](const size_t begin, const size_t end) {
+			for (auto y{begin}; y < end; ++y) {
+				const auto top{sourcePixels + y * 2 * source->pitch};
+				const auto bottom{y * 2 + 1 < height ? top + source->pitch : top};
+				HalveRow(top, bottom, width, destinationPixels + y * destination->pitch);
+			}
+		});
+		return destination;
+	}
+}
+
+std::string_view ToString(const TextureQuality quality) {
+	switch (quality) {
+		case TextureQuality::Full: return "full";
+		case TextureQuality::Half: return "half";
+		case TextureQuality::Quarter: return "quarter";
+	}
+	return "unknown";
+}
+
+TextureQuality ParseTextureQuality(const std::span<char *> arguments) {
+	const auto value{FindOption(arguments, "texture-quality")};
+	if (!value || value == "full")
+		return TextureQuality::Full;
+	if (value == "half")
+		return TextureQuality::Half;
+	if (value == "quarter")
+		return TextureQuality::Quarter;
+	throw UsageError{"Unknown texture quality: " + std::string{*value}};
+}
+
+Uint32 GetHalvingCount(const TextureQuality quality) {
+	switch (quality) {
+		case TextureQuality::Full: return 0;
+		case TextureQuality::Half: return 1;
+		case TextureQuality::Quarter: return 2;
+	}
+	return 0;
+}
+
+SDL_Surface *DownscaleImage(JobSystem &jobSystem, SDL_Surface *image, const Uint32 halvingCount) {
+	PROFILE_ZONE("Downscale Image");
+	MemoryScope memoryScope{MemoryTag::Assets};
+	if (SDL_BYTESPERPIXEL(image->format) != 4)
+		throw std::runtime_error{"Downscaling needs 32-bit pixels"};
+
+	auto result{image};
+	for (Uint32 i{}; i < halvingCount && (result->w > 1 || result->h > 1); ++i) {
+		const auto halved{Halve(jobSystem, result)};
+		if (result != image)
+			SDL_DestroySurface(result);
+		result = halved;
+	}
+	if (result == image && !(result = SDL_DuplicateSurface(image)))
+		throw SDLException{"Couldn't duplicate surface"};
+	return result;
+}
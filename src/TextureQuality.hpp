@@ -0,0 +1,28 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include <SDL3/SDL.h>
+
+class JobSystem;
+
+// Resolution textures are loaded at, for targets short on memory. Lower qualities shrink the image before the texture
+// is created, so video memory and upload time drop with the pixel count.
+enum class TextureQuality {
+	Full,
+	Half,
+	Quarter,
+};
+
+std::string_view ToString(TextureQuality quality);
+
+// --texture-quality=full|half|quarter, full by default
+TextureQuality ParseTextureQuality(std::span<char *> arguments);
+
+// Times each side is halved, the number of top mips dropped
+Uint32 GetHalvingCount(TextureQuality quality);
+
+// A new surface with each side halved halvingCount times, stopping at 1x1. Every pass averages 2x2 blocks of a
+// 32-bit per pixel surface with SSE2 or NEON and splits the rows over the job system, the last row and column
+// repeat for odd sizes. Averages round half up on every path, so the image doesn't depend on the instruction set.
+SDL_Surface *DownscaleImage(JobSystem &jobSystem, SDL_Surface *image, Uint32 halvingCount);
@@ -0,0 +1,482 @@
+#include "ToneMapping.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "HdrImage.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "Simd.hpp"
+
+namespace {
+	constexpr size_t BlockPixelCount{16384};
+
+	using Matrix3 = std::array<std::array<float, 3>, 3>;
+
+	// Rows of the matrices the shaders multiply row vectors with
+	constexpr Matrix3 AcesInputMatrix{{
+		{0.59719f, 0.35458f, 0.04823f},
+		{0.07600f, 0.90834f, 0.01566f},
+		{0.02840f, 0.13383f, 0.83777f},
+	}};
+	constexpr Matrix3 AcesOutputMatrix{{
+		{1.60475f, -0.53108f, -0.07367f},
+		{-0.10208f, 1.10813f, -0.00605f},
+		{-0.00327f, -0.07276f, 1.07602f},
+	}};
+	constexpr Matrix3 Bt709ToBt2020Matrix{{
+		{0.627404f, 0.329282f, 0.0433136f},
+		{0.069097f, 0.919540f, 0.0113612f},
+		{0.0163916f, 0.0880132f, 0.895595f},
+	}};
+
+	// One channel of four pixels. Every backend only provides the primitive operations, the shader math is written once
+	// on top of them, so all paths round alike.
+#if defined(ENGINE_SSE2)
+	struct Float4 {
+		__m128 value;
+	};
+
+	Float4 Splat(const float value) { return {_mm_set1_ps(value)}; }
+	Float4 operator+(const Float4 a, const Float4 b) { return {_mm_add_ps(a.value, b.value)}; }
+	Float4 operator-(const Float4 a, const Float4 b) { return {_mm_sub_ps(a.value, b.value)}; }
+	Float4 operator*(const Float4 a, const Float4 b) { return {_mm_mul_ps(a.value, b.value)}; }
+	Float4 operator/(const Float4 a, const Float4 b) { return {_mm_div_ps(a.value, b.value)}; }
+	Float4 Min(const Float4 a, const Float4 b) { return {_mm_min_ps(a.value, b.value)}; }
+	Float4 Max(const Float4 a, const Float4 b) { return {_mm_max_ps(a.value, b.value)}; }
+
+	Float4 Abs(const Float4 a) {
+		return {_mm_and_ps(a.value, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)))};
+	}
+
+	// All bits set in the lanes where a > b
+	Float4 Greater(const Float4 a, const Float4 b) { return {_mm_cmpgt_ps(a.value, b.value)}; }
+
+	Float4 Select(const Float4 mask, const Float4 a, const Float4 b) {
+		return {_mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value))};
+	}
+
+	// Only for values that fit an int, the exponents Exp2 splits off
+	Float4 Floor(const Float4 a) {
+		const auto truncated{_mm_cvtepi32_ps(_mm_cvttps_epi32(a.value))};
+		return {_mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.value), _mm_set1_ps(1.0f)))};
+	}
+
+	// Unbiased exponent of positive normal floats
+	Float4 Exponent(const Float4 a) {
+		const auto bits{_mm_srli_epi32(_mm_castps_si128(a.value), 23)};
+		return {_mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(bits, _mm_set1_epi32(0xff)), _mm_set1_epi32(127)))};
+	}
+
+	// Mantissa of positive normal floats in [1, 2)
+	Float4 Mantissa(const Float4 a) {
+		const auto bits{_mm_and_si128(_mm_castps_si128(a.value), _mm_set1_epi32(0x007fffff))};
+		return {_mm_castsi128_ps(_mm_or_si128(bits, _mm_set1_epi32(0x3f800000)))};
+	}
+
+	// 2 to the power of whole numbers in [-126, 127]
+	Float4 Exp2Integer(const Float4 a) {
+		const auto exponent{_mm_add_epi32(_mm_cvttps_epi32(a.value), _mm_set1_epi32(127))};
+		return {_mm_castsi128_ps(_mm_slli_epi32(exponent, 23))};
+	}
+
+	void LoadPixels(const float *pixels, Float4 &r, Float4 &g, Float4 &b, Float4 &a) {
+		r.value = _mm_loadu_ps(pixels);
+		g.value = _mm_loadu_ps(pixels + 4);
+		b.value = _mm_loadu_ps(pixels + 8);
+		a.value = _mm_loadu_ps(pixels + 12);
+		_MM_TRANSPOSE4_PS(r.value, g.value, b.value, a.value);
+	}
+
+	// Channels already scaled to [0.5, 255.5], truncation rounds them
+	void StorePixels(const Float4 r, const Float4 g, const Float4 b, const Float4 a, Uint8 *output) {
+		auto pixels{_mm_cvttps_epi32(r.value)};
+		pixels = _mm_or_si128(pixels, _mm_slli_epi32(_mm_cvttps_epi32(g.value), 8));
+		pixels = _mm_or_si128(pixels, _mm_slli_epi32(_mm_cvttps_epi32(b.value), 16));
+		pixels = _mm_or_si128(pixels, _mm_slli_epi32(_mm_cvttps_epi32(a.value), 24));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(output), pixels);
+	}
+#elif defined(ENGINE_NEON)
+	struct Float4 {
+		float32x4_t value;
+	};
+
+	Float4 Splat(const float value) { return {vdupq_n_f32(value)}; }
+	Float4 operator+(const Float4 a, const Float4 b) { return {vaddq_f32(a.value, b.value)}; }
+	Float4 operator-(const Float4 a, const Float4 b) { return {vsubq_f32(a.value, b.value)}; }
+	Float4 operator*(const Float4 a, const Float4 b) { return {vmulq_f32(a.value, b.value)}; }
+	Float4 operator/(const Float4 a, const Float4 b) { return {vdivq_f32(a.value, b.value)}; }
+	Float4 Min(const Float4 a, const Float4 b) { return {vminq_f32(a.value, b.value)}; }
+	Float4 Max(const Float4 a, const Float4 b) { return {vmaxq_f32(a.value, b.value)}; }
+	Float4 Abs(const Float4 a) { return {vabsq_f32(a.value)}; }
+
+	Float4 Greater(const Float4 a, const Float4 b) {
+		return {vreinterpretq_f32_u32(vcgtq_f32(a.value, b.value))};
+	}
+
+	Float4 Select(const Float4 mask, const Float4 a, const Float4 b) {
+		return {vbslq_f32(vreinterpretq_u32_f32(mask.value), a.value, b.value)};
+	}
+
+	Float4 Floor(const Float4 a) { return {vrndmq_f32(a.value)}; }
+
+	Float4 Exponent(const Float4 a) {
+		const auto bits{vandq_u32(vshrq_n_u32(vreinterpretq_u32_f32(a.value), 23), vdupq_n_u32(0xff))};
+		return {vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(bits), vdupq_n_s32(127)))};
+	}
+
+	Float4 Mantissa(const Float4 a) {
+		const auto bits{vandq_u32(vreinterpretq_u32_f32(a.value), vdupq_n_u32(0x007fffff))};
+		return {vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3f800000)))};
+	}
+
+	Float4 Exp2Integer(const Float4 a) {
+		const auto exponent{vaddq_s32(vcvtq_s32_f32(a.value), vdupq_n_s32(127))};
+		return {vreinterpretq_f32_s32(vshlq_n_s32(exponent, 23))};
+	}
+
+	void LoadPixels(const float *pixels, Float4 &r, Float4 &g, Float4 &b, Float4 &a) {
+		const auto channels{vld4q_f32(pixels)};
+		r.value = channels.val[0];
+		g.value = channels.val[1];
+		b.value = channels.val[2];
+		a.value = channels.val[3];
+	}
+
+	void StorePixels(const Float4 r, const Float4 g, const Float4 b, const Float4 a, Uint8 *output) {
+		auto pixels{vcvtq_u32_f32(r.value)};
+		pixels = vorrq_u32(pixels, vshlq_n_u32(vcvtq_u32_f32(g.value), 8));
+		pixels = vorrq_u32(pixels, vshlq_n_u32(vcvtq_u32_f32(b.value), 16));
+		pixels = vorrq_u32(pixels, vshlq_n_u32(vcvtq_u32_f32(a.value), 24));
+		vst1q_u8(output, vreinterpretq_u8_u32(pixels));
+	}
+#else
+	struct Float4 {
+		std::array<float, 4> value;
+	};
+
+	template<typename Function>
+	Float4 Map(const Float4 a, const Float4 b, Function &&function) {
+		Float4 result;
+		for (size_t lane{}; lane < 4; ++lane)
+			result.value[lane] = function(a.value[lane], b.value[lane]);
+		return result;
+	}
+
+	Float4 Splat(const float value) { return {{value, value, value, value}}; }
+	Float4 operator+(const Float4 a, const Float4 b) { return Map(a, b, [](float x, float y) { return x + y; }); }
+	Float4 operator-(const Float4 a, const Float4 b) { return Map(a, b, [](float x, float y) { return x - y; }); }
+	Float4 operator*(const Float4 a, const Float4 b) { return Map(a, b, [](float x, float y) { return x * y; }); }
+	Float4 operator/(const Float4 a, const Float4 b) { return Map(a, b, [](float x, float y) { return x / y; }); }
+	Float4 Min(const Float4 a, const Float4 b) { return Map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+	Float4 Max(const Float4 a, const Float4 b) { return Map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+	Float4 Abs(const Float4 a) { return Map(a, a, [](float x, float) { return std::fabs(x); }); }
+
+	Float4 Greater(const Float4 a, const Float4 b) {
+		return Map(a, b, [](float x, float y) { return std::bit_cast<float>(x > y ? ~Uint32{} : Uint32{}); });
+	}
+
+	Float4 Select(const Float4 mask, const Float4 a, const Float4 b) {
+		Float4 result;
+		for (size_t lane{}; lane < 4; ++lane)
+			result.value[lane] = std::bit_cast<Uint32>(mask.value[lane]) ? a.value[lane] : b.value[lane];
+		return result;
+	}
+
+	Float4 Floor(const Float4 a) { return Map(a, a, [](float x, float) { return std::floor(x); }); }
+
+	Float4 Exponent(const Float4 a) {
+		return Map(a, a, [](float x, float) {
+			return static_cast<float>(static_cast<int>(std::bit_cast<Uint32>(x) >> 23 & 0xff) - 127);
+		});
+	}
+
+	Float4 Mantissa(const Float4 a) {
+		return Map(a, a, [](float x, float) {
+			return std::bit_cast<float>(std::bit_cast<Uint32>(x) & 0x007fffff | 0x3f800000);
+		});
+	}
+
+	Float4 Exp2Integer(const Float4 a) {
+		return Map(a, a, [](float x, float) {
+			return std::bit_cast<float>(static_cast<Uint32>(static_cast<int>(x) + 127) << 23);
+		});
+	}
+
+	void LoadPixels(const float *pixels, Float4 &r, Float4 &g, Float4 &b, Float4 &a) {
+		for (size_t pixel{}; pixel < 4; ++pixel) {
+			r.value[pixel] = pixels[pixel * 4];
+			g.value[pixel] = pixels[pixel * 4 + 1];
+			b.value[pixel] = pixels[pixel * 4 + 2];
+			a.value[pixel] = pixels[pixel * 4 + 3];
+		}
+	}
+
+	void StorePixels(const Float4 r, const Float4 g, const Float4 b, const Float4 a, Uint8 *output) {
+		for (size_t pixel{}; pixel < 4; ++pixel) {
+			output[pixel * 4] = static_cast<Uint8>(r.value[pixel]);
+			output[pixel * 4 + 1] = static_cast<Uint8>(g.value[pixel]);
+			output[pixel * 4 + 2] = static_cast<Uint8>(b.value[pixel]);
+			output[pixel * 4 + 3] = static_cast<Uint8>(a.value[pixel]);
+		}
+	}
+#endif
+
+	struct Color {
+		Float4 r, g, b;
+	};
+
+	Color operator*(const Color &color, const Float4 scale) {
+		return {color.r * scale, color.g * scale, color.b * scale};
+	}
+
+	// Row vector times the matrix like HLSL's mul(color, matrix), the rows are given
+	Color Transform(const Color &color, const Matrix3 &matrix) {
+		auto row{
+			[&color](const std::array<float, 3> &weights) {
+				return color.r * Splat(weights[0]) + color.g * Splat(weights[1]) + color.b * Splat(weights[2]);
+			}
+		};
+		return {row(matrix[0]), row(matrix[1]), row(matrix[2])};
+	}
+
+	// Mantissa moved to [sqrt(0.5), sqrt(2)), where the atanh series converges within float precision in four terms
+	Float4 Log2(const Float4 x) {
+		auto mantissa{Mantissa(x)};
+		auto exponent{Exponent(x)};
+		const auto isHigh{Greater(mantissa, Splat(1.41421356f))};
+		mantissa = Select(isHigh, mantissa * Splat(0.5f), mantissa);
+		exponent = exponent + Select(isHigh, Splat(1.0f), Splat(0.0f));
+		const auto t{(mantissa - Splat(1.0f)) / (mantissa + Splat(1.0f))};
+		const auto t2{t * t};
+		const auto series{
+			t * (Splat(2.88539008f) + t2 * (Splat(0.961796694f) + t2 * (Splat(0.577078016f) + t2 * Splat(0.412198583f))))
+		};
+		return exponent + series;
+	}
+
+	// Taylor series of 2^x for the fraction, exact powers of two for the whole part
+	Float4 Exp2(Float4 x) {
+		x = Min(Max(x, Splat(-126.0f)), Splat(127.0f));
+		const auto whole{Floor(x)};
+		const auto f{x - whole};
+		auto power{Splat(1.52527338e-5f)};
+		for (const auto coefficient: {1.54035304e-4f, 1.33335581e-3f, 9.61812911e-3f, 5.55041087e-2f, 0.240226507f,
+		                              0.693147181f, 1.0f})
+			power = power * f + Splat(coefficient);
+		return power * Exp2Integer(whole);
+	}
+
+	// powr, defined for non-negative bases only, with 0 to any power being 0
+	Float4 Pow(const Float4 x, const float exponent) {
+		return Select(Greater(x, Splat(0.0f)), Exp2(Log2(x) * Splat(exponent)), Splat(0.0f));
+	}
+
+	// The constants are the ones the shaders were compiled with
+	Color ToneMap(const Color &color, const ToneMapOperator toneMapOperator) {
+		switch (toneMapOperator) {
+			case ToneMapOperator::None: return color;
+			case ToneMapOperator::Reinhard: {
+				const auto one{Splat(1.0f)};
+				return {color.r / (one + color.r), color.g / (one + color.g), color.b / (one + color.b)};
+			}
+			case ToneMapOperator::ExtendedReinhard: {
+				const auto luminance{
+					color.r * Splat(0.2126f) + color.g * Splat(0.7152f) + color.b * Splat(0.0722f)
+				};
+				const auto one{Splat(1.0f)};
+				// White point of about 662, where luminance maps to 1
+				const auto scale{
+					luminance * (one + luminance * Splat(2.2818337583885295e-6f)) / (one + luminance) / luminance
+				};
+				// The shader divides 0 by 0 for black, which is black either way
+				return color * Select(Greater(luminance, Splat(0.0f)), scale, Splat(0.0f));
+			}
+			case ToneMapOperator::Hable: {
+				auto curve{
+					[](const Float4 channel) {
+						const auto x{channel * Splat(2.0f)};
+						const auto scaled{x * Splat(0.15f)};
+						const auto mapped{
+							(x * (scaled + Splat(0.05f)) + Splat(0.004f)) / (x * (scaled + Splat(0.5f)) + Splat(0.06f))
+						};
+						return (mapped - Splat(0.0666666627f)) * Splat(1.37906432f);
+					}
+				};
+				return {curve(color.r), curve(color.g), curve(color.b)};
+			}
+			case ToneMapOperator::Aces: {
+				const auto input{Transform(color, AcesInputMatrix)};
+				auto curve{
+					[](const Float4 x) {
+						return (x * (x + Splat(0.0245786f)) - Splat(0.000090537f)) /
+						       (x * (x * Splat(0.983729f) + Splat(0.4329510f)) + Splat(0.238081f));
+					}
+				};
+				return Transform({curve(input.r), curve(input.g), curve(input.b)}, AcesOutputMatrix);
+			}
+		}
+		return color;
+	}
+
+	Color Encode(const Color &color, const TransferFunction transferFunction) {
+		if (transferFunction == TransferFunction::Srgb)
+			return {
+				Pow(Abs(color.r), 0.454545438f), Pow(Abs(color.g), 0.454545438f), Pow(Abs(color.b), 0.454545438f)
+			};
+
+		// BT.709 to BT.2020, then 1.0 is 200 of the curve's 10000 nits
+		const auto bt2020{Transform(color, Bt709ToBt2020Matrix) * Splat(200.0f * 1e-4f)};
+		auto curve{
+			[](const Float4 channel) {
+				const auto y{Pow(Abs(channel), 0.1593017578125f)};
+				return Pow((Splat(0.8359375f) + y * Splat(18.8515625f)) / (Splat(1.0f) + y * Splat(18.6875f)),
+				           78.84375f);
+			}
+		};
+		return {curve(bt2020.r), curve(bt2020.g), curve(bt2020.b)};
+	}
+
+	Float4 ToUnorm8(const Float4 channel) {
+		return Min(Max(channel, Splat(0.0f)), Splat(1.0f)) * Splat(255.0f) + Splat(0.5f);
+	}
+
+	void ToneMapFour(const float *pixels, const ToneMapOperator toneMapOperator,
+	                 const TransferFunction transferFunction, Uint8 *output) {
+		Color color;
+		Float4 alpha;
+		LoadPixels(pixels, color.r, color.g, color.b, alpha);
+		// Both kinds of shaders write opaque pixels
+		color = Encode(ToneMap(color, toneMapOperator), transferFunction);
+		StorePixels(ToUnorm8(color.r), ToUnorm8(color.g), ToUnorm8(color.b), Splat(255.0f), output);
+	}
+
+	// The reference path, one pixel in plain floats with the standard library's pow
+	using Rgb = std::array<float, 3>;
+
+	Rgb Transform(const Rgb &color, const Matrix3 &matrix) {
+		Rgb result;
+		for (size_t row{}; row < 3; ++row)
+			result[row] = color[0] * matrix[row][0] + color[1] * matrix[row][1] + color[2] * matrix[row][2];
+		return result;
+	}
+
+	template<typename Function>
+	Rgb Map(const Rgb &color, Function &&function) {
+		return {function(color[0]), function(color[1]), function(color[2])};
+	}
+
+	Rgb ReferenceToneMap(const Rgb &color, const ToneMapOperator toneMapOperator) {
+		switch (toneMapOperator) {
+			case ToneMapOperator::None: return color;
+			case ToneMapOperator::Reinhard: return Map(color, [](const float x) { return x / (1.0f + x); });
+			case ToneMapOperator::ExtendedReinhard: {
+				const auto luminance{color[0] * 0.2126f + color[1] * 0.7152f + color[2] * 0.0722f};
+				if (luminance <= 0.0f)
+					return {};
+				const auto scale{luminance * (1.0f + luminance * 2.2818337583885295e-6f) / (1.0f + luminance) / luminance};
+				return Map(color, [scale](const float x) { return x * scale; });
+			}
+			case ToneMapOperator::Hable:
+				return Map(color, [](const float channel) {
+					const auto x{channel * 2.0f};
+					const auto mapped{(x * (x * 0.15f + 0.05f) + 0.004f) / (x * (x * 0.15f + 0.5f) + 0.06f)};
+					return (mapped - 0.0666666627f) * 1.37906432f;
+				});
+			case ToneMapOperator::Aces:
+				return Transform(Map(Transform(color, AcesInputMatrix), [](const float x) {
+					return (x * (x + 0.0245786f) - 0.000090537f) / (x * (x * 0.983729f + 0.4329510f) + 0.238081f);
+				}), AcesOutputMatrix);
+		}
+		return color;
+	}
+
+	Rgb ReferenceEncode(const Rgb &color, const TransferFunction transferFunction) {
+		if (transferFunction == TransferFunction::Srgb)
+			return Map(color, [](const float x) { return std::pow(std::fabs(x), 0.454545438f); });
+		return Map(Transform(color, Bt709ToBt2020Matrix), [](const float channel) {
+			const auto y{std::pow(std::fabs(channel * 200.0f * 1e-4f), 0.1593017578125f)};
+			return std::pow((0.8359375f + y * 18.8515625f) / (1.0f + y * 18.6875f), 78.84375f);
+		});
+	}
+}
+
+std::string_view ToString(const ToneMapOperator toneMapOperator) {
+	switch (toneMapOperator) {
+		case ToneMapOperator::None: return "none";
+		case ToneMapOperator::Reinhard: return "reinhard";
+		case ToneMapOperator::ExtendedReinhard: return "extended-reinhard";
+		case ToneMapOperator::Hable: return "hable";
+		case ToneMapOperator::Aces: return "aces";
+	}
+	return "unknown";
+}
+
+std::string_view ToString(const TransferFunction transferFunction) {
+	switch (transferFunction) {
+		case TransferFunction::Srgb: return "srgb";
+		case TransferFunction::Pq: return "pq";
+	}
+	return "unknown";
+}
+
+std::optional<ToneMapOperator> ParseToneMapOperator(const std::string_view name) {
+	for (const auto toneMapOperator: {
+		     ToneMapOperator::None, ToneMapOperator::Reinhard, ToneMapOperator::ExtendedReinhard, ToneMapOperator::Hable,
+		     ToneMapOperator::Aces
+	     })
+		if (name == ToString(toneMapOperator))
+			return toneMapOperator;
+	return std::nullopt;
+}
+
+std::optional<TransferFunction> ParseTransferFunction(const std::string_view name) {
+	for (const auto transferFunction: {TransferFunction::Srgb, TransferFunction::Pq})
+		if (name == ToString(transferFunction))
+			return transferFunction;
+	return std::nullopt;
+}
+
+void ToneMapPixels(const float *pixels, const size_t pixelCount, const ToneMapOperator toneMapOperator,
+                   const TransferFunction transferFunction, Uint8 *output) {
+	size_t pixel{};
+	for (; pixel + 4 <= pixelCount; pixel += 4)
+		ToneMapFour(pixels + pixel * 4, toneMapOperator, transferFunction, output + pixel * 4);
+
+	// The last pixels go through the same path from a padded copy
+	if (const auto remaining{pixelCount - pixel}) {
+		std::array<float, 16> tail{};
+		std::array<Uint8, 16> tailOutput;
+		std::copy_n(pixels + pixel * 4, remaining * 4, tail.begin());
+		ToneMapFour(tail.data(), toneMapOperator, transferFunction, tailOutput.data());
+		std::memcpy(output + pixel * 4, tailOutput.data(), remaining * 4);
+	}
+}
+
+void ToneMapPixelsReference(const float *pixels, const size_t pixelCount, const ToneMapOperator toneMapOperator,
+                            const TransferFunction transferFunction, Uint8 *output) {
+	for (size_t pixel{}; pixel < pixelCount; ++pixel) {
+		const auto *input{pixels + pixel * 4};
+		const auto color{ReferenceEncode(ReferenceToneMap({input[0], input[1], input[2]}, toneMapOperator),
+		                                 transferFunction)};
+		for (size_t channel{}; channel < 3; ++channel)
+			output[pixel * 4 + channel] = static_cast<Uint8>(std::clamp(color[channel], 0.0f, 1.0f) * 255.0f + 0.5f);
+		output[pixel * 4 + 3] = 255;
+	}
+}
+
+void ToneMapImage(JobSystem &jobSystem, const HdrImage &image, const ToneMapOperator toneMapOperator,
+                  const TransferFunction transferFunction, Uint8 *output) {
+	PROFILE_ZONE("Tone Map Image");
+	const auto pixelCount{static_cast<size_t>(image.width) * image.height};
+	const auto blockCount{(pixelCount + BlockPixelCount - 1) / BlockPixelCount};
+	ParallelFor(jobSystem, blockCount, 1, [&](const size_t begin, const size_t end) {
+		const auto first{begin * BlockPixelCount};
+		const auto last{std::min(end * BlockPixelCount, pixelCount)};
+		ToneMapPixels(image.pixels.data() + first * 4, last - first, toneMapOperator, transferFunction,
+		              output + first * 4);
+	});
+}
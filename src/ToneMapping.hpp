@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <SDL3/SDL.h>
+
+class JobSystem;
+struct HdrImage;
+
+// CPU ports of the ToneMap*.comp and LinearTo*.comp compute shaders, to preview HDR images offline and as a reference
+// for their GPU results
+enum class ToneMapOperator {
+	None,
+	Reinhard,
+	ExtendedReinhard,
+	Hable,
+	Aces,
+};
+
+enum class TransferFunction {
+	// Gamma 2.2 like LinearToSRGB.comp, not the piecewise sRGB curve
+	Srgb,
+	// ST 2084 of BT.2020 primaries with 1.0 at 200 nits, like LinearToST2084.comp
+	Pq,
+};
+
+// The command line names, e.g. "extended-reinhard"
+std::string_view ToString(ToneMapOperator toneMapOperator);
+
+std::string_view ToString(TransferFunction transferFunction);
+
+std::optional<ToneMapOperator> ParseToneMapOperator(std::string_view name);
+
+std::optional<TransferFunction> ParseTransferFunction(std::string_view name);
+
+// Tone maps linear RGBA float pixels and encodes them into RGBA32 pixels with alpha 255, four pixels at a time with
+// SSE2 or NEON. Powers use polynomial log2 and exp2 approximations that are well within 8-bit precision, the same on
+// every path.
+void ToneMapPixels(const float *pixels, size_t pixelCount, ToneMapOperator toneMapOperator,
+                   TransferFunction transferFunction, Uint8 *output);
+
+// The same mapping one pixel at a time in scalar floats with std::pow, slow but exact enough to check ToneMapPixels
+// against
+void ToneMapPixelsReference(const float *pixels, size_t pixelCount, ToneMapOperator toneMapOperator,
+                            TransferFunction transferFunction, Uint8 *output);
+
+// Splits the image into blocks tone mapped on the job system, output holds width * height RGBA32 pixels
+void ToneMapImage(JobSystem &jobSystem, const HdrImage &image, ToneMapOperator toneMapOperator,
+                  TransferFunction transferFunction, Uint8 *output);
@@ -0,0 +1,139 @@
+#include "TransformHierarchy.hpp"
+
+#include "Memory.hpp"
+#include "Profiler.hpp"
+
+TransformNodeId TransformHierarchy::Create(const TransformNodeId parent, const LocalTransform &localTransform) {
+	MemoryScope memoryScope{MemoryTag::Ecs};
+	const auto depth{parent == NoParent ? 0 : locations[parent].depth + 1};
+	if (depth == levels.size())
+		levels.push_back(std::make_unique<Level>());
+
+	TransformNodeId node;
+	if (freeNodes.empty()) {
+		node = static_cast<TransformNodeId>(locations.size());
+		locations.emplace_back();
+	} else {
+		node = freeNodes.back();
+		freeNodes.pop_back();
+	}
+
+	auto &level{*levels[depth]};
+	locations[node] = {depth, static_cast<Uint32>(level.nodes.size())};
+	level.parents.push_back(parent == NoParent ? 0 : locations[parent].index);
+	level.localTransforms.push_back(localTransform);
+	level.worldMatrices.emplace_back(1.0f);
+	level.nodes.push_back(node);
+	level.dirty.push_back(1);
+	level.changed.push_back(0);
+	level.hasDirty.store(true, std::memory_order_relaxed);
+	++nodeCount;
+	return node;
+}
+
+void TransformHierarchy::Destroy(const TransformNodeId node) {
+	const auto [depth, index]{locations[node]};
+
+	// Compact level by level keeping the order, a node goes when its parent went. Indices shift, so the parents of
+	// the first level without removals still have to be remapped.
+	std::vector<Uint32> previousRemap;
+	std::vector<Uint32> remap;
+	constexpr auto Removed{~Uint32{}};
+	for (auto d{depth}; d < levels.size(); ++d) {
+		auto &level{*levels[d]};
+		const auto count{static_cast<Uint32>(level.nodes.size())};
+		remap.assign(count, Removed);
+
+		Uint32 kept{};
+		for (Uint32 i{}; i < count; ++i) {
+			const auto isRemoved{d == depth ? i == index : previousRemap[level.parents[i]] == Removed};
+			if (isRemoved) {
+				freeNodes.push_back(level.nodes[i]);
+				--nodeCount;
+				continue;
+			}
+
+			remap[i] = kept;
+			level.parents[kept] = d == depth ? level.parents[i] : previousRemap[level.parents[i]];
+			level.localTransforms[kept] = level.localTransforms[i];
+			level.worldMatrices[kept] = level.worldMatrices[i];
+			level.nodes[kept] = level.nodes[i];
+			level.dirty[kept] = level.dirty[i];
+			level.changed[kept] = level.changed[i];
+			locations[level.nodes[kept]].index = kept;
+			++kept;
+		}
+
+		level.parents.resize(kept);
+		level.localTransforms.resize(kept);
+		level.worldMatrices.resize(kept);
+		level.nodes.resize(kept);
+		level.dirty.resize(kept);
+		level.changed.resize(kept);
+
+		if (kept == count)
+			break;
+		previousRemap.swap(remap);
+	}
+
+	while (!levels.empty() && levels.back()->nodes.empty())
+		levels.pop_back();
+}
+
+const LocalTransform &TransformHierarchy::GetLocal(const TransformNodeId node) const {
+	const auto [depth, index]{locations[node]};
+	return levels[depth]->localTransforms[index];
+}
+
+void TransformHierarchy::SetLocal(const TransformNodeId node, const LocalTransform &localTransform) {
+	const auto [depth, index]{locations[node]};
+	auto &level{*levels[depth]};
+	level.localTransforms[index] = localTransform;
+	level.dirty[index] = 1;
+	level.hasDirty.store(true, std::memory_order_relaxed);
+}
+
+const glm::mat4 &TransformHierarchy::GetWorld(const TransformNodeId node) const {
+	const auto [depth, index]{locations[node]};
+	return levels[depth]->worldMatrices[index];
+}
+
+void TransformHierarchy::Update(JobSystem &jobSystem) {
+	PROFILE_ZONE("Transform Hierarchy");
+	constexpr size_t GrainSize{1024};
+
+	Level *parentLevel{};
+	for (auto &levelPointer: levels) {
+		auto &level{*levelPointer};
+		const auto parentChanged{parentLevel && parentLevel->hasChanged};
+		if (!level.hasDirty.load(std::memory_order_relaxed) && !parentChanged) {
+			level.hasChanged = false;
+			parentLevel = &level;
+			continue;
+		}
+
+		std::atomic<bool> anyChanged{};
+		ParallelFor(jobSystem, level.nodes.size(), GrainSize, [&](const size_t begin, const size_t end) {
+			auto rangeChanged{false};
+			for (auto i{begin}; i < end; ++i) {
+				const auto isChanged{level.dirty[i] || (parentChanged && parentLevel->changed[level.parents[i]])};
+				level.changed[i] = isChanged;
+				level.dirty[i] = 0;
+				if (!isChanged)
+					continue;
+
+				const auto localMatrix{ToMatrix(level.localTransforms[i])};
+				level.worldMatrices[i] = parentLevel
+					                         ? parentLevel->worldMatrices[level.parents[i]] * localMatrix
+					                         : localMatrix;
+				rangeChanged = true;
+			}
+			if (rangeChanged)
+				anyChanged.store(true, std::memory_order_relaxed);
+		});
+
+		level.hasDirty.store(false, std::memory_order_relaxed);
+		level.hasChanged = anyChanged.load(std::memory_order_relaxed);
+		parentLevel = &level;
+	}
+}
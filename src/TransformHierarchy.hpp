@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+#include "Components.hpp"
+#include "JobSystem.hpp"
+
+using TransformNodeId = Uint32;
+
+constexpr TransformNodeId NoParent{~TransformNodeId{}};
+
+// Scene graph of local transforms. Nodes are stored in one structure of arrays per depth, parents always in the level
+// above, so world matrices are computed level by level with every level split over the job system. Only nodes whose
+// local transform or ancestors changed are recomputed and levels without changes are skipped entirely.
+class TransformHierarchy {
+public:
+	TransformNodeId Create(TransformNodeId parent = NoParent, const LocalTransform &localTransform = {});
+
+	// Destroys the node along with all of its descendants
+	void Destroy(TransformNodeId node);
+
+	[[nodiscard]] const LocalTransform &GetLocal(TransformNodeId node) const;
+
+	// Safe to call from several threads as long as they change different nodes
+	void SetLocal(TransformNodeId node, const LocalTransform &localTransform);
+
+	// Up to date after Update
+	[[nodiscard]] const glm::mat4 &GetWorld(TransformNodeId node) const;
+
+	void Update(JobSystem &jobSystem);
+
+	[[nodiscard]] Uint32 GetNodeCount() const { return nodeCount; }
+
+	[[nodiscard]] Uint32 GetDepth() const { return static_cast<Uint32>(levels.size()); }
+
+private:
+	struct Level {
+		// Index into the level above
+		std::vector<Uint32> parents;
+		std::vector<LocalTransform> localTransforms;
+		std::vector<glm::mat4> worldMatrices;
+		std::vector<TransformNodeId> nodes;
+		// Local transform changed since the last update
+		std::vector<Uint8> dirty;
+		// World matrix recomputed by the current update, read by the level below
+		std::vector<Uint8> changed;
+		std::atomic<bool> hasDirty{};
+		bool hasChanged{};
+	};
+
+	struct Location {
+		Uint32 depth;
+		Uint32 index;
+	};
+
+	std::vector<std::unique_ptr<Level>> levels;
+	std::vector<Location> locations;
+	std::vector<TransformNodeId> freeNodes;
+	Uint32 nodeCount{};
+};
@@ -0,0 +1,251 @@
+#include "Ui.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <span>
+#include <glm/ext/matrix_clip_space.hpp>
+
+#include "DebugFont.hpp"
+#include "GpuResources.hpp"
+#include "Profiler.hpp"
+
+namespace {
+	// Glyphs get a transparent pixel on every side, so nearest sampling at a cell's edge never reaches the neighbour
+	constexpr Uint32 CellSize{DebugFont::Size + 2};
+	constexpr Uint32 AtlasColumns{16};
+	constexpr Uint32 AtlasWidth{AtlasColumns * CellSize};
+	// Below the glyphs, a white strip that plain rectangles sample
+	constexpr Uint32 WhiteRowCount{4};
+
+	constexpr Uint32 MinVertexCapacity{1024};
+
+	constexpr Uint64 HashSeed{14695981039346656037ull};
+
+	Uint64 HashBytes(Uint64 hash, const void *data, const size_t size) {
+		for (const auto byte: std::span{static_cast<const Uint8 *>(data), size})
+			hash = (hash ^ byte) * 1099511628211ull;
+		return hash;
+	}
+
+	template<typename T>
+	Uint64 HashValue(const Uint64 hash, const T &value) {
+		return HashBytes(hash, &value, sizeof(value));
+	}
+}
+
+UiId MakeUiId(const std::string_view name, const Uint64 index) {
+	return HashValue(HashBytes(HashSeed, name.data(), name.size()), index);
+}
+
+UiRenderer::UiRenderer(SDL_GPUDevice *device, const SDL_GPUTextureFormat targetFormat,
+                       const std::vector<Uint64> &glyphBitmaps)
+	: device{device}, vertexBuffer{device, sizeof(UiVertex), MinVertexCapacity, "UI Vertices"} {
+	constexpr SDL_GPUVertexBufferDescription vertexBufferDescription{
+		.slot = 0,
+		.pitch = sizeof(UiVertex),
+		.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+	};
+	constexpr std::array<SDL_GPUVertexAttribute, 3> vertexAttributes{
+		{
+			{0, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(UiVertex, position)},
+			{1, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, offsetof(UiVertex, texCoord)},
+			{2, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(UiVertex, color)},
+		}
+	};
+	pipeline = CreateOverlayPipeline(device, targetFormat, "TexturedQuadColorWithMatrix.vert", "TexturedQuadColor.frag",
+	                                 1, vertexBufferDescription, vertexAttributes, SDL_GPU_PRIMITIVETYPE_TRIANGLELIST);
+	// Text is drawn at whole multiples of the font size, so nearest sampling keeps its pixels sharp
+	sampler = CreateOverlaySampler(device, SDL_GPU_FILTER_NEAREST);
+
+	const auto glyphRows{static_cast<Uint32>(glyphBitmaps.size() + AtlasColumns - 1) / AtlasColumns};
+	const auto atlasHeight{glyphRows * CellSize + WhiteRowCount};
+	std::vector<Uint32> pixels(AtlasWidth * atlasHeight);
+	for (size_t glyph{}; glyph < glyphBitmaps.size(); ++glyph) {
+		const auto left{static_cast<Uint32>(glyph % AtlasColumns * CellSize + 1)};
+		const auto top{static_cast<Uint32>(glyph / AtlasColumns * CellSize + 1)};
+		for (Uint32 y{}; y < DebugFont::Size; ++y)
+			for (Uint32 x{}; x < DebugFont::Size; ++x)
+				if (glyphBitmaps[glyph] >> (y * DebugFont::Size + x) & 1)
+					pixels[(top + y) * AtlasWidth + left + x] = 0xffffffff;
+	}
+	std::fill(pixels.end() - AtlasWidth * WhiteRowCount, pixels.end(), 0xffffffff);
+
+	atlasTexture = CreateOverlayAtlas(device, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, AtlasWidth, atlasHeight,
+	                                  std::as_bytes(std::span{pixels}), "UI Atlas");
+	atlasSize = {static_cast<float>(AtlasWidth), static_cast<float>(atlasHeight)};
+}
+
+UiRenderer::~UiRenderer() {
+	Release();
+}
+
+void UiRenderer::BeginFrame() {
+	++frame;
+	std::swap(placedWidgets, previousPlacedWidgets);
+	placedWidgets.clear();
+	tessellatedWidgetCount = 0;
+	vertexCount = 0;
+}
+
+void UiRenderer::Rectangle(const UiId id, const glm::vec4 rectangle, const glm::vec4 color) {
+	auto &widget{widgets[id]};
+	const auto isChanged{Invalidate(widget, HashValue(HashValue(HashSeed, rectangle), color))};
+	if (isChanged) {
+		// Every corner samples the middle of the white strip
+		const auto white{glm::vec2{AtlasWidth / 2.0f, atlasSize.y - WhiteRowCount / 2.0f} / atlasSize};
+		AddQuad(widget.vertices, rectangle, glm::vec4{white, 0.0f, 0.0f}, color);
+	}
+	PlaceWidget(id, widget.vertices, isChanged);
+}
+
+void UiRenderer::Label(const UiId id, const std::string_view text, const glm::vec2 position, const Uint32 scale,
+                       const glm::vec4 color) {
+	auto &widget{widgets[id]};
+	auto contentHash{HashBytes(HashSeed, text.data(), text.size())};
+	contentHash = HashValue(HashValue(HashValue(contentHash, position), scale), color);
+	const auto isChanged{Invalidate(widget, contentHash)};
+	if (isChanged) {
+		const auto size{static_cast<float>(DebugFont::Size * scale)};
+		const auto cellTexCoordSize{glm::vec2{static_cast<float>(DebugFont::Size)} / atlasSize};
+		auto pen{position};
+		for (auto character: text) {
+			if (character == '\n') {
+				pen = {position.x, pen.y + size + static_cast<float>(scale) * 2.0f};
+				continue;
+			}
+			if (character < DebugFont::FirstCharacter || character > DebugFont::LastCharacter)
+				character = '?';
+			if (character != ' ') {
+				const auto glyph{static_cast<Uint32>(character - DebugFont::FirstCharacter)};
+				const glm::vec2 cell{
+					static_cast<float>(glyph % AtlasColumns * CellSize + 1),
+					static_cast<float>(glyph / AtlasColumns * CellSize + 1),
+				};
+				AddQuad(widget.vertices, {pen, size, size}, {cell / atlasSize, cellTexCoordSize}, color);
+			}
+			pen.x += size;
+		}
+	}
+	PlaceWidget(id, widget.vertices, isChanged);
+}
+
+bool UiRenderer::Invalidate(CachedWidget &widget, const Uint64 contentHash) {
+	widget.lastFrame = frame;
+	if (widget.isTessellated && widget.contentHash == contentHash)
+		return false;
+	widget.contentHash = contentHash;
+	widget.vertices.clear();
+	widget.isTessellated = true;
+	++tessellatedWidgetCount;
+	return true;
+}
+
+void UiRenderer::PlaceWidget(const UiId id, const std::vector<UiVertex> &vertices, const bool isChanged) {
+	const auto index{placedWidgets.size()};
+	const auto firstVertex{vertexCount};
+	const auto count{static_cast<Uint32>(vertices.size())};
+	placedWidgets.push_back({id, firstVertex, count});
+	vertexCount += count;
+
+	// A widget left where it was last frame is still in the vertex buffer, unless an earlier widget overwrote it, but
+	// then that one moved and so did this one
+	if (!isChanged && index < previousPlacedWidgets.size()) {
+		const auto &previous{previousPlacedWidgets[index]};
+		if (previous.id == id && previous.firstVertex == firstVertex && previous.vertexCount == count)
+			return;
+	}
+	if (this->vertices.size() < vertexCount)
+		this->vertices.resize(vertexCount);
+	std::ranges::copy(vertices, this->vertices.begin() + firstVertex);
+	dirtyBegin = std::min(dirtyBegin, firstVertex);
+	dirtyEnd = std::max(dirtyEnd, vertexCount);
+}
+
+void UiRenderer::AddQuad(std::vector<UiVertex> &vertices, const glm::vec4 rectangle,
+                         const glm::vec4 texCoordRectangle, const glm::vec4 color) {
+	const std::array corners{
+		glm::vec2{0.0f, 0.0f}, glm::vec2{1.0f, 0.0f}, glm::vec2{1.0f, 1.0f},
+		glm::vec2{0.0f, 0.0f}, glm::vec2{1.0f, 1.0f}, glm::vec2{0.0f, 1.0f},
+	};
+	for (const auto corner: corners)
+		vertices.push_back({
+			.position = {glm::vec2{rectangle.x, rectangle.y} + corner * glm::vec2{rectangle.z, rectangle.w}, 0.0f, 1.0f},
+			.texCoord = glm::vec2{texCoordRectangle.x, texCoordRectangle.y} +
+			            corner * glm::vec2{texCoordRectangle.z, texCoordRectangle.w},
+			.color = color,
+		});
+}
+
+void UiRenderer::Upload(SDL_GPUCommandBuffer *commandBuffer) {
+	PROFILE_ZONE("Upload UI");
+	// The new buffer holds nothing yet
+	if (vertexBuffer.Reserve(vertexCount)) {
+		dirtyBegin = 0;
+		dirtyEnd = vertexCount;
+	}
+
+	// Ranges left from frames that weren't recorded may reach past the widgets that are left
+	dirtyEnd = std::min(dirtyEnd, vertexCount);
+	const auto count{dirtyEnd - dirtyBegin};
+	uploadedVertexCount = count;
+	// The vertex buffer isn't cycled, the copy runs after earlier frames drew from it and has to keep the vertices
+	// outside the dirty range
+	vertexBuffer.Upload(commandBuffer, vertices.data() + dirtyBegin, dirtyBegin, count, false);
+	dirtyBegin = std::numeric_limits<Uint32>::max();
+	dirtyEnd = 0;
+}
+
+void UiRenderer::Record(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target, const Uint32 width,
+                        const Uint32 height) {
+	PROFILE_ZONE("Record UI");
+	// Widgets that weren't declared this frame are gone
+	if (widgets.size() != placedWidgets.size())
+		std::erase_if(widgets, [this](const auto &entry) { return entry.second.lastFrame != frame; });
+
+	uploadedVertexCount = 0;
+	if (vertexCount && (std::min(dirtyEnd, vertexCount) > dirtyBegin || vertexCount > vertexBuffer.GetCapacity()))
+		Upload(commandBuffer);
+	if (!vertexCount)
+		return;
+
+	auto renderPass{BeginOverlayPass(commandBuffer, target, pipeline, vertexBuffer.Get())};
+	const SDL_GPUTextureSamplerBinding atlasBinding{
+		.texture = atlasTexture,
+		.sampler = sampler,
+	};
+	SDL_BindGPUFragmentSamplers(renderPass, 0, &atlasBinding, 1);
+
+	// Pixels with the origin at the top left
+	const auto projection{
+		glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f, -1.0f, 1.0f)
+	};
+	SDL_PushGPUVertexUniformData(commandBuffer, 0, &projection, sizeof(projection));
+	SDL_DrawGPUPrimitives(renderPass, vertexCount, 1, 0, 0);
+	SDL_EndGPURenderPass(renderPass);
+}
+
+Uint32 UiRenderer::GetWidgetCount() const {
+	return static_cast<Uint32>(placedWidgets.size());
+}
+
+Uint32 UiRenderer::GetTessellatedWidgetCount() const {
+	return tessellatedWidgetCount;
+}
+
+Uint32 UiRenderer::GetUploadedVertexCount() const {
+	return uploadedVertexCount;
+}
+
+void UiRenderer::Release() {
+	SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+	SDL_ReleaseGPUSampler(device, sampler);
+	ReleaseTrackedTexture(device, atlasTexture);
+	vertexBuffer.Release();
+	pipeline = nullptr;
+	sampler = nullptr;
+	atlasTexture = nullptr;
+	widgets.clear();
+	placedWidgets.clear();
+	previousPlacedWidgets.clear();
+}
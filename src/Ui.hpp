@@ -0,0 +1,103 @@
+#pragma once
+
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+#include "OverlayRendering.hpp"
+
+using UiId = Uint64;
+
+// Widgets drawn every frame need ids that stay the same across frames, the index tells apart widgets made in a loop
+UiId MakeUiId(std::string_view name, Uint64 index = 0);
+
+// Immediate-mode UI drawn as one batch of textured quads. Widgets are declared every frame between BeginFrame and
+// Record, but each keeps its tessellated geometry until its content changes, and only the range of the vertex buffer
+// holding changed or moved widgets is uploaded again. Static panels cost a hash and a comparison per widget.
+class UiRenderer {
+public:
+	// The glyph bitmaps come from RasterizeDebugFont, text is drawn at multiples of its 8 pixels
+	UiRenderer(SDL_GPUDevice *device, SDL_GPUTextureFormat targetFormat, const std::vector<Uint64> &glyphBitmaps);
+
+	~UiRenderer();
+
+	UiRenderer(const UiRenderer &) = delete;
+
+	UiRenderer &operator=(const UiRenderer &) = delete;
+
+	void BeginFrame();
+
+	// Rectangle is left, top, width and height in pixels
+	void Rectangle(UiId id, glm::vec4 rectangle, glm::vec4 color);
+
+	// Position is the top left corner, scale a whole multiple of the font's 8 pixels
+	void Label(UiId id, std::string_view text, glm::vec2 position, Uint32 scale, glm::vec4 color);
+
+	// Uploads what changed since the last frame and draws the widgets declared since BeginFrame over the target's content
+	void Record(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *target, Uint32 width, Uint32 height);
+
+	// Widgets of the last frame and how many of them had to be tessellated again
+	[[nodiscard]] Uint32 GetWidgetCount() const;
+
+	[[nodiscard]] Uint32 GetTessellatedWidgetCount() const;
+
+	[[nodiscard]] Uint32 GetUploadedVertexCount() const;
+
+	// Has to happen before the device is destroyed
+	void Release();
+
+private:
+	struct UiVertex {
+		glm::vec4 position;
+		glm::vec2 texCoord;
+		glm::vec4 color;
+	};
+
+	struct CachedWidget {
+		Uint64 contentHash{};
+		std::vector<UiVertex> vertices;
+		Uint64 lastFrame{};
+		bool isTessellated{};
+	};
+
+	// Where a widget's vertices were placed in the vertex buffer, in declaration order
+	struct PlacedWidget {
+		UiId id;
+		Uint32 firstVertex;
+		Uint32 vertexCount;
+	};
+
+	// Returns whether the widget has to be tessellated again and clears its geometry if so
+	bool Invalidate(CachedWidget &widget, Uint64 contentHash);
+
+	void PlaceWidget(UiId id, const std::vector<UiVertex> &vertices, bool isChanged);
+
+	static void AddQuad(std::vector<UiVertex> &vertices, glm::vec4 rectangle, glm::vec4 texCoordRectangle,
+	                    glm::vec4 color);
+
+	void Upload(SDL_GPUCommandBuffer *commandBuffer);
+
+	SDL_GPUDevice *device;
+	SDL_GPUGraphicsPipeline *pipeline{};
+	SDL_GPUTexture *atlasTexture{};
+	SDL_GPUSampler *sampler{};
+	glm::vec2 atlasSize{};
+
+	std::unordered_map<UiId, CachedWidget> widgets;
+	std::vector<PlacedWidget> placedWidgets;
+	std::vector<PlacedWidget> previousPlacedWidgets;
+	Uint64 frame{};
+	Uint32 tessellatedWidgetCount{};
+
+	// Every widget's vertices in declaration order, only the dirty range is uploaded
+	std::vector<UiVertex> vertices;
+	Uint32 vertexCount{};
+	// Kept across frames until uploaded, in case a frame wasn't recorded
+	Uint32 dirtyBegin{std::numeric_limits<Uint32>::max()};
+	Uint32 dirtyEnd{};
+	Uint32 uploadedVertexCount{};
+	OverlayVertexBuffer vertexBuffer;
+};
@@ -0,0 +1,214 @@
+#include "VideoRecorder.hpp"
+
+#include <algorithm>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <string>
+
+#include "GpuResources.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+#include "YuvConversion.hpp"
+
+namespace {
+	// Two frames in flight, one being converted and one spare to absorb a slow write
+	constexpr Uint32 DownloadBufferCount{4};
+}
+
+VideoRecorder::VideoRecorder(SDL_GPUDevice *device) : device{device} {
+	thread = std::thread{&VideoRecorder::WriteLoop, this};
+}
+
+VideoRecorder::~VideoRecorder() {
+	Stop();
+}
+
+void VideoRecorder::Start(const std::filesystem::path &path, const SDL_GPUTextureFormat format, const Uint32 width,
+                          const Uint32 height, const Uint32 frameRateNumerator, const Uint32 frameRateDenominator) {
+	Finish();
+
+	MemoryScope memoryScope{MemoryTag::Rendering};
+	auto recording{std::make_unique<Recording>()};
+	switch (format) {
+		case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+		case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB: recording->pixelFormat = SDL_PIXELFORMAT_RGBA32;
+			break;
+		case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+		case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB: recording->pixelFormat = SDL_PIXELFORMAT_BGRA32;
+			break;
+		default: throw std::runtime_error{"Can't record textures of format " + std::to_string(format)};
+	}
+
+	recording->file.open(path, std::ios::binary);
+	if (!recording->file)
+		throw std::runtime_error{"Couldn't create " + path.string()};
+	recording->file << std::format("YUV4MPEG2 W{} H{} F{}:{} Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height,
+	                               frameRateNumerator, frameRateDenominator);
+
+	recording->path = path;
+	recording->width = width;
+	recording->height = height;
+	recording->yuvFrame.resize(GetYuv420Size(width, height));
+
+	const SDL_GPUTransferBufferCreateInfo createInfo{
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+		.size = width * height * 4,
+	};
+	for (Uint32 slot{}; slot < DownloadBufferCount; ++slot) {
+		const auto buffer{CreateTrackedTransferBuffer(device, createInfo, MemoryTag::Rendering, "Video Download")};
+		if (!buffer) {
+			for (const auto created: recording->downloadBuffers)
+				ReleaseTrackedTransferBuffer(device, created);
+			throw SDLException{"Couldn't create video download buffer"};
+		}
+		recording->downloadBuffers.push_back(buffer);
+		recording->freeSlots.push_back(slot);
+	}
+
+	this->recording = std::move(recording);
+	isRecording.store(true, std::memory_order_relaxed);
+}
+
+GpuFrameTimer::CompletionCallback VideoRecorder::Capture(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *texture,
+                                                         const Uint32 width, const Uint32 height) {
+	if (!recording)
+		return {};
+	if (width != recording->width || height != recording->height) {
+		std::println("Frame size changed to {}x{}", width, height);
+		Finish();
+		return {};
+	}
+
+	PROFILE_ZONE("Capture Video Frame");
+	Uint32 slot;
+	{
+		std::lock_guard lock{mutex};
+		if (recording->freeSlots.empty()) {
+			++recording->droppedFrameCount;
+			return {};
+		}
+		slot = recording->freeSlots.back();
+		recording->freeSlots.pop_back();
+		++recording->pendingFrameCount;
+	}
+
+	const SDL_GPUTextureRegion source{
+		.texture = texture,
+		.w = width,
+		.h = height,
+		.d = 1,
+	};
+	const SDL_GPUTextureTransferInfo destination{
+		.transfer_buffer = recording->downloadBuffers[slot],
+	};
+	auto copyPass{SDL_BeginGPUCopyPass(commandBuffer)};
+	SDL_DownloadFromGPUTexture(copyPass, &source, &destination);
+	SDL_EndGPUCopyPass(copyPass);
+
+	return [this, recording = recording.get(), slot](const bool completed) {
+		{
+			std::lock_guard lock{mutex};
+			completedFrames.push_back({recording, slot, completed});
+		}
+		wakeWriter.notify_one();
+	};
+}
+
+void VideoRecorder::Finish() {
+	if (!recording)
+		return;
+	isRecording.store(false, std::memory_order_relaxed);
+	{
+		std::lock_guard lock{mutex};
+		finishedRecordings.push_back(std::move(recording));
+	}
+	wakeWriter.notify_one();
+}
+
+void VideoRecorder::Stop() {
+	Finish();
+	{
+		std::lock_guard lock{mutex};
+		stopping = true;
+	}
+	wakeWriter.notify_one();
+	if (thread.joinable())
+		thread.join();
+}
+
+void VideoRecorder::WriteLoop() {
+	SetProfilerThreadName("Video");
+	std::unique_lock lock{mutex};
+	while (true) {
+		const auto finished{
+			std::ranges::find_if(finishedRecordings, [](const auto &finished) {
+				return finished->pendingFrameCount == 0;
+			})
+		};
+		if (finished != finishedRecordings.end()) {
+			const auto recording{std::move(*finished)};
+			finishedRecordings.erase(finished);
+			lock.unlock();
+			Close(*recording);
+			lock.lock();
+			continue;
+		}
+		if (completedFrames.empty()) {
+			if (stopping && finishedRecordings.empty())
+				return;
+			wakeWriter.wait(lock);
+			continue;
+		}
+
+		const auto frame{completedFrames.front()};
+		completedFrames.pop_front();
+		lock.unlock();
+
+		// Frames complete in submission order, so they are appended in order as well
+		if (frame.completed) {
+			try {
+				WriteFrame(*frame.recording, frame.slot);
+			} catch (const std::exception &exception) {
+				std::println("Couldn't record frame: {}", exception.what());
+			}
+		}
+
+		lock.lock();
+		frame.recording->freeSlots.push_back(frame.slot);
+		--frame.recording->pendingFrameCount;
+	}
+}
+
+void VideoRecorder::WriteFrame(Recording &recording, const Uint32 slot) {
+	PROFILE_ZONE("Write Video Frame");
+	// Stays failed after the first error, the file is reported once it's finished
+	if (!recording.file)
+		return;
+
+	const auto buffer{recording.downloadBuffers[slot]};
+	const auto pixels{SDL_MapGPUTransferBuffer(device, buffer, false)};
+	if (!pixels)
+		throw SDLException{"Couldn't map video download buffer"};
+	ConvertToYuv420(static_cast<const Uint8 *>(pixels), recording.width, recording.height, recording.width * 4,
+	                recording.pixelFormat, recording.yuvFrame.data());
+	SDL_UnmapGPUTransferBuffer(device, buffer);
+
+	recording.file << "FRAME\n";
+	recording.file.write(reinterpret_cast<const char *>(recording.yuvFrame.data()),
+	                     static_cast<std::streamsize>(recording.yuvFrame.size()));
+	++recording.writtenFrameCount;
+}
+
+void VideoRecorder::Close(Recording &recording) {
+	for (const auto buffer: recording.downloadBuffers)
+		ReleaseTrackedTransferBuffer(device, buffer);
+	recording.downloadBuffers.clear();
+
+	recording.file.close();
+	if (!recording.file)
+		std::println("Couldn't write {}", recording.path.string());
+	else
+		std::println("Recorded {} frames to {}, dropped {}", recording.writtenFrameCount, recording.path.string(),
+		             recording.droppedFrameCount);
+}
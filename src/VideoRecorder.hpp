@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "GpuFrameTimer.hpp"
+
+// Records frames into a Y4M video. Each frame is copied into one of a ring of download buffers at the end of its command
+// buffer, and once the GpuFrameTimer saw it complete the recorder's thread converts it to YUV 4:2:0 and appends it to
+// the file. The frame loop never waits: when all buffers are still in use, the frame is dropped from the video, and a
+// finished recording is closed by the recorder's thread once its last frame is written.
+class VideoRecorder {
+public:
+	explicit VideoRecorder(SDL_GPUDevice *device);
+
+	~VideoRecorder();
+
+	VideoRecorder(const VideoRecorder &) = delete;
+
+	VideoRecorder &operator=(const VideoRecorder &) = delete;
+
+	// Frames have to be SDL_GPU_TEXTUREFORMAT_R8G8B8A8 or B8G8R8A8 of the given size and are played back at
+	// frameRateNumerator / frameRateDenominator frames per second, a running recording is finished first
+	void Start(const std::filesystem::path &path, SDL_GPUTextureFormat format, Uint32 width, Uint32 height,
+	           Uint32 frameRateNumerator, Uint32 frameRateDenominator);
+
+	// Safe to call from any thread
+	[[nodiscard]] bool IsRecording() const { return isRecording.load(std::memory_order_relaxed); }
+
+	// Records the copy after everything already in the command buffer. The texture has to be one of the engine's own,
+	// swapchain textures aren't guaranteed to support downloads. The returned callback has to be passed to
+	// GpuFrameTimer::Submit with the same command buffer, it's empty when the frame was dropped. A frame of another
+	// size finishes the recording.
+	GpuFrameTimer::CompletionCallback Capture(SDL_GPUCommandBuffer *commandBuffer, SDL_GPUTexture *texture,
+	                                          Uint32 width, Uint32 height);
+
+	// Hands the recording over to the recorder's thread, which closes the file and prints how many frames were recorded
+	// once the captured frames are written
+	void Finish();
+
+	// Finishes the recording, waits until it's written and stops the thread, has to happen after GpuFrameTimer::Stop and
+	// before the device is destroyed
+	void Stop();
+
+private:
+	struct Recording {
+		std::filesystem::path path;
+		std::ofstream file;
+		SDL_PixelFormat pixelFormat;
+		Uint32 width;
+		Uint32 height;
+		std::vector<SDL_GPUTransferBuffer *> downloadBuffers;
+		std::vector<Uint8> yuvFrame;
+		// Only written by the recorder's thread
+		Uint32 writtenFrameCount{};
+		// Only written by the calling thread before the recording is finished
+		Uint32 droppedFrameCount{};
+		// Guarded by the recorder's mutex
+		std::vector<Uint32> freeSlots;
+		Uint32 pendingFrameCount{};
+	};
+
+	struct CompletedFrame {
+		Recording *recording;
+		Uint32 slot;
+		bool completed;
+	};
+
+	void WriteLoop();
+
+	void WriteFrame(Recording &recording, Uint32 slot);
+
+	// Closes the file and releases the download buffers, called without the mutex held
+	void Close(Recording &recording);
+
+	SDL_GPUDevice *device;
+	std::thread thread;
+
+	// Only changed on the calling thread
+	std::unique_ptr<Recording> recording;
+	std::atomic_bool isRecording;
+
+	std::mutex mutex;
+	std::condition_variable wakeWriter;
+	std::deque<CompletedFrame> completedFrames;
+	// Handed over by Finish, closed once none of their frames are pending
+	std::vector<std::unique_ptr<Recording>> finishedRecordings;
+	bool stopping{};
+};
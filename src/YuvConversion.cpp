@@ -0,0 +1,226 @@
+#include "YuvConversion.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Simd.hpp"
+
+namespace {
+	// BT.601 in 8.8 fixed point. The chroma weights sum to zero so gray maps exactly to 128, and every intermediate
+	// stays within 16 unsigned bits, which the SIMD paths rely on.
+	constexpr int LumaRed{77}, LumaGreen{150}, LumaBlue{29};
+	constexpr int BlueDifferenceRed{43}, BlueDifferenceGreen{84}, BlueDifferenceBlue{127};
+	constexpr int RedDifferenceRed{127}, RedDifferenceGreen{106}, RedDifferenceBlue{21};
+	// 128 offset plus rounding
+	constexpr int ChromaBias{128 * 256 + 128};
+
+	struct Rows {
+		const Uint8 *top;
+		const Uint8 *bottom;
+		Uint8 *lumaTop;
+		Uint8 *lumaBottom;
+		Uint8 *blueDifference;
+		Uint8 *redDifference;
+	};
+
+	Uint8 Luma(const int r, const int g, const int b) {
+		return static_cast<Uint8>((LumaRed * r + LumaGreen * g + LumaBlue * b + 128) >> 8);
+	}
+
+	// Pairs of columns from begin, the tail of every row and whole rows on targets without SIMD
+	void ConvertScalar(const Rows &rows, const Uint32 begin, const Uint32 width, const bool hasBottom,
+	                   const int redOffset, const int blueOffset) {
+		for (auto x{begin}; x < width; x += 2) {
+			const auto right{std::min(x + 1, width - 1)};
+			int r{}, g{}, b{};
+			for (const auto row: {rows.top, rows.bottom})
+				for (const auto column: {x, right}) {
+					const auto pixel{row + column * 4};
+					r += pixel[redOffset];
+					g += pixel[1];
+					b += pixel[blueOffset];
+				}
+			for (const auto column: {x, right}) {
+				const auto top{rows.top + column * 4};
+				rows.lumaTop[column] = Luma(top[redOffset], top[1], top[blueOffset]);
+				if (hasBottom) {
+					const auto bottom{rows.bottom + column * 4};
+					rows.lumaBottom[column] = Luma(bottom[redOffset], bottom[1], bottom[blueOffset]);
+				}
+			}
+			r = (r + 2) >> 2;
+			g = (g + 2) >> 2;
+			b = (b + 2) >> 2;
+			rows.blueDifference[x / 2] = static_cast<Uint8>(
+				(ChromaBias - BlueDifferenceRed * r - BlueDifferenceGreen * g + BlueDifferenceBlue * b) >> 8);
+			rows.redDifference[x / 2] = static_cast<Uint8>(
+				(ChromaBias + RedDifferenceRed * r - RedDifferenceGreen * g - RedDifferenceBlue * b) >> 8);
+		}
+	}
+
+#if defined(ENGINE_SSE2)
+	struct Channels {
+		__m128i r, g, b;
+	};
+
+	// Eight pixels as 16-bit lanes per channel
+	Channels LoadChannels(const Uint8 *pixels, const bool isBgra) {
+		const auto low{_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels))};
+		const auto high{_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 16))};
+		const auto mask{_mm_set1_epi32(0xFF)};
+		const auto first{_mm_packs_epi32(_mm_and_si128(low, mask), _mm_and_si128(high, mask))};
+		const auto g{
+			_mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 8), mask), _mm_and_si128(_mm_srli_epi32(high, 8), mask))
+		};
+		const auto third{
+			_mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 16), mask), _mm_and_si128(_mm_srli_epi32(high, 16), mask))
+		};
+		return isBgra ? Channels{third, g, first} : Channels{first, g, third};
+	}
+
+	__m128i Luma(const Channels &channels) {
+		// Wraps around in 16 bits, but the true sum never exceeds 65535
+		auto sum{_mm_mullo_epi16(channels.r, _mm_set1_epi16(LumaRed))};
+		sum = _mm_add_epi16(sum, _mm_mullo_epi16(channels.g, _mm_set1_epi16(LumaGreen)));
+		sum = _mm_add_epi16(sum, _mm_mullo_epi16(channels.b, _mm_set1_epi16(LumaBlue)));
+		return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+	}
+
+	// Averages of the 2x2 blocks of 16 pixels in two rows, as the low four and the high four 16-bit lanes
+	__m128i BlockAverage(const __m128i topLeft, const __m128i bottomLeft, const __m128i topRight,
+	                     const __m128i bottomRight) {
+		const auto ones{_mm_set1_epi16(1)};
+		const auto two{_mm_set1_epi32(2)};
+		const auto left{_mm_madd_epi16(_mm_add_epi16(topLeft, bottomLeft), ones)};
+		const auto right{_mm_madd_epi16(_mm_add_epi16(topRight, bottomRight), ones)};
+		return _mm_packs_epi32(_mm_srli_epi32(_mm_add_epi32(left, two), 2), _mm_srli_epi32(_mm_add_epi32(right, two), 2));
+	}
+
+	__m128i Chroma(const __m128i positive, const int positiveWeight, const __m128i first, const int firstWeight,
+	               const __m128i second, const int secondWeight) {
+		auto sum{_mm_add_epi16(_mm_set1_epi16(static_cast<short>(ChromaBias)),
+		                       _mm_mullo_epi16(positive, _mm_set1_epi16(static_cast<short>(positiveWeight))))};
+		sum = _mm_sub_epi16(sum, _mm_mullo_epi16(first, _mm_set1_epi16(static_cast<short>(firstWeight))));
+		sum = _mm_sub_epi16(sum, _mm_mullo_epi16(second, _mm_set1_epi16(static_cast<short>(secondWeight))));
+		return _mm_srli_epi16(sum, 8);
+	}
+#endif
+
+	// 16 pixels of both rows per iteration, the rest goes through the scalar loop
+	void ConvertRows(const Rows &rows, const Uint32 width, const bool hasBottom, const bool isBgra) {
+		Uint32 x{};
+#if defined(ENGINE_SSE2)
+		for (; x + 16 <= width; x += 16) {
+			const auto topLeft{LoadChannels(rows.top + x * 4, isBgra)};
+			const auto topRight{LoadChannels(rows.top + x * 4 + 32, isBgra)};
+			const auto bottomLeft{LoadChannels(rows.bottom + x * 4, isBgra)};
+			const auto bottomRight{LoadChannels(rows.bottom + x * 4 + 32, isBgra)};
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(rows.lumaTop + x),
+			                 _mm_packus_epi16(Luma(topLeft), Luma(topRight)));
+			if (hasBottom)
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(rows.lumaBottom + x),
+				                 _mm_packus_epi16(Luma(bottomLeft), Luma(bottomRight)));
+
+			const auto r{BlockAverage(topLeft.r, bottomLeft.r, topRight.r, bottomRight.r)};
+			const auto g{BlockAverage(topLeft.g, bottomLeft.g, topRight.g, bottomRight.g)};
+			const auto b{BlockAverage(topLeft.b, bottomLeft.b, topRight.b, bottomRight.b)};
+			const auto blueDifference{
+				Chroma(b, BlueDifferenceBlue, r, BlueDifferenceRed, g, BlueDifferenceGreen)
+			};
+			const auto redDifference{Chroma(r, RedDifferenceRed, g, RedDifferenceGreen, b, RedDifferenceBlue)};
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(rows.blueDifference + x / 2),
+			                 _mm_packus_epi16(blueDifference, blueDifference));
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(rows.redDifference + x / 2),
+			                 _mm_packus_epi16(redDifference, redDifference));
+		}
+#elif defined(ENGINE_NEON)
+		const auto redIndex{isBgra ? 2 : 0};
+		const auto blueIndex{isBgra ? 0 : 2};
+		const auto luma{
+			[](const uint8x16x4_t &pixels, const int redIndex, const int blueIndex) {
+				const auto r{pixels.val[redIndex]};
+				const auto g{pixels.val[1]};
+				const auto b{pixels.val[blueIndex]};
+				auto low{vmull_u8(vget_low_u8(r), vdup_n_u8(LumaRed))};
+				low = vmlal_u8(low, vget_low_u8(g), vdup_n_u8(LumaGreen));
+				low = vmlal_u8(low, vget_low_u8(b), vdup_n_u8(LumaBlue));
+				auto high{vmull_high_u8(r, vdupq_n_u8(LumaRed))};
+				high = vmlal_high_u8(high, g, vdupq_n_u8(LumaGreen));
+				high = vmlal_high_u8(high, b, vdupq_n_u8(LumaBlue));
+				return vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8));
+			}
+		};
+		for (; x + 16 <= width; x += 16) {
+			const auto top{vld4q_u8(rows.top + x * 4)};
+			const auto bottom{vld4q_u8(rows.bottom + x * 4)};
+			vst1q_u8(rows.lumaTop + x, luma(top, redIndex, blueIndex));
+			if (hasBottom)
+				vst1q_u8(rows.lumaBottom + x, luma(bottom, redIndex, blueIndex));
+
+			const auto average{
+				[&top, &bottom](const int index) {
+					return vrshrq_n_u16(vaddq_u16(vpaddlq_u8(top.val[index]), vpaddlq_u8(bottom.val[index])), 2);
+				}
+			};
+			const auto r{average(redIndex)};
+			const auto g{average(1)};
+			const auto b{average(blueIndex)};
+			auto blueDifference{vmlaq_n_u16(vdupq_n_u16(ChromaBias), b, BlueDifferenceBlue)};
+			blueDifference = vmlsq_n_u16(blueDifference, r, BlueDifferenceRed);
+			blueDifference = vmlsq_n_u16(blueDifference, g, BlueDifferenceGreen);
+			auto redDifference{vmlaq_n_u16(vdupq_n_u16(ChromaBias), r, RedDifferenceRed)};
+			redDifference = vmlsq_n_u16(redDifference, g, RedDifferenceGreen);
+			redDifference = vmlsq_n_u16(redDifference, b, RedDifferenceBlue);
+			vst1_u8(rows.blueDifference + x / 2, vshrn_n_u16(blueDifference, 8));
+			vst1_u8(rows.redDifference + x / 2, vshrn_n_u16(redDifference, 8));
+		}
+#endif
+		ConvertScalar(rows, x, width, hasBottom, isBgra ? 2 : 0, isBgra ? 0 : 2);
+	}
+}
+
+size_t GetYuv420Size(const Uint32 width, const Uint32 height) {
+	const auto chromaSize{static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2)};
+	return static_cast<size_t>(width) * height + chromaSize * 2;
+}
+
+namespace {
+	void Convert(const Uint8 *pixels, const Uint32 width, const Uint32 height, const Uint32 pitch,
+	             const SDL_PixelFormat format, Uint8 *yuv, const bool isScalar) {
+		if (format != SDL_PIXELFORMAT_RGBA32 && format != SDL_PIXELFORMAT_BGRA32)
+			throw std::runtime_error{"YUV conversion needs RGBA32 or BGRA32 pixels"};
+
+		const auto isBgra{format == SDL_PIXELFORMAT_BGRA32};
+		const auto chromaWidth{(width + 1) / 2};
+		const auto chromaSize{static_cast<size_t>(chromaWidth) * ((height + 1) / 2)};
+		const auto blueDifference{yuv + static_cast<size_t>(width) * height};
+		const auto redDifference{blueDifference + chromaSize};
+		for (Uint32 y{}; y < height; y += 2) {
+			const auto hasBottom{y + 1 < height};
+			const auto top{pixels + static_cast<size_t>(y) * pitch};
+			const Rows rows{
+				.top = top,
+				.bottom = hasBottom ? top + pitch : top,
+				.lumaTop = yuv + static_cast<size_t>(y) * width,
+				.lumaBottom = yuv + static_cast<size_t>(y + 1) * width,
+				.blueDifference = blueDifference + static_cast<size_t>(y / 2) * chromaWidth,
+				.redDifference = redDifference + static_cast<size_t>(y / 2) * chromaWidth,
+			};
+			if (isScalar)
+				ConvertScalar(rows, 0, width, hasBottom, isBgra ? 2 : 0, isBgra ? 0 : 2);
+			else
+				ConvertRows(rows, width, hasBottom, isBgra);
+		}
+	}
+}
+
+void ConvertToYuv420(const Uint8 *pixels, const Uint32 width, const Uint32 height, const Uint32 pitch,
+                     const SDL_PixelFormat format, Uint8 *yuv) {
+	Convert(pixels, width, height, pitch, format, yuv, false);
+}
+
+void ConvertToYuv420Reference(const Uint8 *pixels, const Uint32 width, const Uint32 height, const Uint32 pitch,
+                              const SDL_PixelFormat format, Uint8 *yuv) {
+	Convert(pixels, width, height, pitch, format, yuv, true);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <SDL3/SDL.h>
+
+// Bytes of an 8-bit YUV 4:2:0 image: the luma plane followed by both chroma planes at half the size, rounded up
+size_t GetYuv420Size(Uint32 width, Uint32 height);
+
+// Converts SDL_PIXELFORMAT_RGBA32 or SDL_PIXELFORMAT_BGRA32 pixels to full range BT.601 planes laid out like Y4M
+// frames. Each chroma sample is the average of a 2x2 block, the last row and column repeat for odd sizes. The SSE2,
+// NEON and scalar paths share the same 8.8 fixed point rounding, so their frames are identical.
+void ConvertToYuv420(const Uint8 *pixels, Uint32 width, Uint32 height, Uint32 pitch, SDL_PixelFormat format,
+                     Uint8 *yuv);
+
+// The same conversion through the scalar loop alone, to check ConvertToYuv420's SIMD paths against
+void ConvertToYuv420Reference(const Uint8 *pixels, Uint32 width, Uint32 height, Uint32 pitch, SDL_PixelFormat format,
+                              Uint8 *yuv);
@@ -1,166 +1,75 @@
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdlib>
 #include <filesystem>
+#include <format>
 #include <vector>
 #include <SDL3/SDL.h>
 #include <print>
 #include <span>
 #include <glm/glm.hpp>
-#include <string>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <memory_resource>
+#include <optional>
 #include <stdexcept>
-#include <fstream>
-#include <SDL3_image/SDL_image.h>
-
-#include "assimp/Importer.hpp"
-#include "assimp/postprocess.h"
-#include "assimp/scene.h"
-#include "glm/ext/matrix_clip_space.hpp"
-#include "glm/ext/matrix_transform.hpp"
-
-static std::filesystem::path BasePath;
-
-class SDLException final : public std::runtime_error {
-public:
-	explicit SDLException(const std::string &message) : std::runtime_error(message + '\n' + SDL_GetError()) {
-	}
-};
+#include <string>
 
-SDL_GPUShader *LoadShader(
+#include "AntiAliasing.hpp"
+#include "Assets.hpp"
+#include "CommandLine.hpp"
+#include "Components.hpp"
+#include "Culling.hpp"
+#include "DebugDraw.hpp"
+#include "Ecs.hpp"
+#include "GpuFrameTimer.hpp"
+#include "GpuResources.hpp"
+#include "Headless.hpp"
+#include "JobSystem.hpp"
+#include "Memory.hpp"
+#include "Profiler.hpp"
+#include "SDLException.hpp"
+#include "SceneRecording.hpp"
+#include "ScreenshotCapture.hpp"
+#include "StartupTimeline.hpp"
+#include "StressScene.hpp"
+#include "Text.hpp"
+#include "TextureConversion.hpp"
+#include "TextureQuality.hpp"
+#include "TransformHierarchy.hpp"
+#include "Ui.hpp"
+#include "VideoRecorder.hpp"
+
+// Both shader files are read concurrently on the job system, the shaders and the pipeline are created on the main thread
+Task<SDL_GPUGraphicsPipeline *> CreateScenePipelineAsync(
+	JobSystem &jobSystem,
 	SDL_GPUDevice *device,
-	const std::string &shaderFilename,
-	const Uint32 samplerCount,
-	const Uint32 uniformBufferCount,
-	const Uint32 storageBufferCount,
-	const Uint32 storageTextureCount
+	const AntiAliasingSettings settings,
+	const SDL_GPUTextureFormat colorFormat,
+	const SDL_GPUTextureFormat depthStencilFormat
 ) {
-	SDL_GPUShaderStage stage;
-	if (shaderFilename.contains(".vert"))
-		stage = SDL_GPU_SHADERSTAGE_VERTEX;
-	else if (shaderFilename.contains(".frag"))
-		stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
-	else
-		throw std::runtime_error{"Unrecognized shader stage!"};
-
-	std::filesystem::path fullPath;
-	const SDL_GPUShaderFormat backendFormats{SDL_GetGPUShaderFormats(device)};
-	SDL_GPUShaderFormat format{};
-	std::string entrypoint{"main"};
-
-	if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV) {
-		fullPath = BasePath / "Content/Shaders/Compiled/SPIRV" / (shaderFilename + ".spv");
-		format = SDL_GPU_SHADERFORMAT_SPIRV;
-	} else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL) {
-		fullPath = BasePath / "Content/Shaders/Compiled/MSL" / (shaderFilename + ".msl");
-		format = SDL_GPU_SHADERFORMAT_MSL;
-		entrypoint = "main0";
-	} else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL) {
-		fullPath = BasePath / "Content/Shaders/Compiled/DXIL" / (shaderFilename + ".dxil");
-		format = SDL_GPU_SHADERFORMAT_DXIL;
-	} else throw std::runtime_error{"No supported shader formats available"};
-
-	std::ifstream file{fullPath, std::ios::binary};
-	if (!file)
-		throw std::runtime_error{"Couldn't open shader file"};
-	std::vector<Uint8> code{std::istreambuf_iterator(file), {}};
-
-	const SDL_GPUShaderCreateInfo shaderInfo{
-		.code_size = code.size(),
-		.code = code.data(),
-		.entrypoint = entrypoint.c_str(),
-		.format = format,
-		.stage = stage,
-		.num_samplers = samplerCount,
-		.num_storage_textures = storageTextureCount,
-		.num_storage_buffers = storageBufferCount,
-		.num_uniform_buffers = uniformBufferCount
-	};
-
-	return SDL_CreateGPUShader(device, &shaderInfo);
-}
-
-SDL_Surface *LoadImage(const std::string_view imageFilename, const int desiredChannels) {
-	const auto fullPath{BasePath / "Content/Images" / imageFilename};
-	SDL_PixelFormat format;
-
-	auto result{IMG_Load(fullPath.string().c_str())};
-	if (!result)
-		throw SDLException{"Couldn't load image"};
-
-	if (desiredChannels == 4)
-		format = SDL_PIXELFORMAT_ABGR8888;
-	else {
-		SDL_DestroySurface(result);
-		throw std::runtime_error{"Unsupported number of channels"};
-	}
-	if (result->format != format) {
-		SDL_Surface *next = SDL_ConvertSurface(result, format);
-		SDL_DestroySurface(result);
-		result = next;
-	}
-
-	return result;
-}
-
-
-struct Vertex {
-	glm::vec3 position;
-	glm::vec2 uv;
-};
-
-int main() {
-	if (!SDL_Init(SDL_INIT_VIDEO))
-		throw SDLException{"Couldn't initialize SDL"};
-
-	BasePath = SDL_GetBasePath();
-
-	auto window{SDL_CreateWindow("Codotaku Game Engine", 800, 600, SDL_WINDOW_HIDDEN | SDL_WINDOW_RESIZABLE)};
-	if (!window)
-		throw SDLException{"Couldn't create window"};
-
-	auto device{
-		SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_MSL | SDL_GPU_SHADERFORMAT_DXIL, true,
-		                    nullptr)
+	// TAA writes screen space motion to a second color target
+	const auto isTemporal{settings.mode == AntiAliasingMode::TAA};
+
+	const auto [vertexShader, fragmentShader]{
+		co_await WhenAll(
+			jobSystem,
+			LoadShaderAsync(jobSystem, device,
+			                isTemporal ? "TexturedQuadWithVelocity.vert" : "TexturedQuadWithMatrix.vert", 0, 1, 0, 0),
+			LoadShaderAsync(jobSystem, device, isTemporal ? "TexturedQuadWithVelocity.frag" : "TexturedQuad.frag", 1,
+			                0, 0, 0))
 	};
-	if (!device)
-		throw SDLException{"Couldn't create GPU device"};
-
-	std::println("Using GPU device driver: {}", SDL_GetGPUDeviceDriver(device));
-
-	if (!SDL_ClaimWindowForGPUDevice(device, window))
-		throw SDLException{"Couldn't claim window for GPU device"};
-
-
-	SDL_GPUTextureFormat depthStencilFormat;
-
-	if (SDL_GPUTextureSupportsFormat(
-		device,
-		SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT,
-		SDL_GPU_TEXTURETYPE_2D,
-		SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET
-	))
-		depthStencilFormat = SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT;
-	else if (SDL_GPUTextureSupportsFormat(
-		device,
-		SDL_GPU_TEXTUREFORMAT_D32_FLOAT_S8_UINT,
-		SDL_GPU_TEXTURETYPE_2D,
-		SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET
-	))
-		depthStencilFormat = SDL_GPU_TEXTUREFORMAT_D32_FLOAT_S8_UINT;
-	else
-		throw SDLException{"Couldn't find a suitable depth stencil format"};
-
-	auto vertexShader{LoadShader(device, "TexturedQuadWithMatrix.vert", 0, 1, 0, 0)};
-	if (!vertexShader)
-		throw SDLException{"Couldn't load vertex shader"};
-
-	auto fragmentShader{LoadShader(device, "TexturedQuad.frag", 1, 0, 0, 0)};
-	if (!fragmentShader)
-		throw SDLException{"Couldn't load fragment shader"};
-
-	SDL_GPUSampleCount msaaSampleCount{SDL_GPU_SAMPLECOUNT_4};
+	co_await ResumeOnMainThread{jobSystem};
+	PROFILE_ZONE("Create Scene Pipeline");
+	MemoryScope memoryScope{MemoryTag::Rendering};
 
 	std::array colorTargetDescriptions{
 		SDL_GPUColorTargetDescription{
-			.format = SDL_GetGPUSwapchainTextureFormat(device, window),
+			.format = colorFormat,
+		},
+		SDL_GPUColorTargetDescription{
+			.format = VelocityFormat,
 		},
 	};
 	std::array<SDL_GPUVertexAttribute, 2> vertexAttributes{
@@ -175,8 +84,8 @@ int main() {
 		},
 	};
 	SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo{
-		.vertex_shader = vertexShader,
-		.fragment_shader = fragmentShader,
+		.vertex_shader = vertexShader.shader,
+		.fragment_shader = fragmentShader.shader,
 		.vertex_input_state = {
 			.vertex_buffer_descriptions = vertexBufferDescriptions.data(),
 			.num_vertex_buffers = vertexBufferDescriptions.size(),
@@ -184,7 +93,7 @@ int main() {
 			.num_vertex_attributes = vertexAttributes.size(),
 		},
 		.multisample_state = {
-			.sample_count = msaaSampleCount,
+			.sample_count = GetSceneSampleCount(settings),
 		},
 		.depth_stencil_state = {
 			.compare_op = SDL_GPU_COMPAREOP_LESS,
@@ -193,50 +102,159 @@ int main() {
 		},
 		.target_info = {
 			.color_target_descriptions = colorTargetDescriptions.data(),
-			.num_color_targets = colorTargetDescriptions.size(),
+			.num_color_targets = isTemporal ? 2u : 1u,
 			.depth_stencil_format = depthStencilFormat,
 			.has_depth_stencil_target = true,
 		},
 	};
 	auto pipeline{SDL_CreateGPUGraphicsPipeline(device, &pipelineCreateInfo)};
+	SDL_ReleaseGPUShader(device, vertexShader.shader);
+	SDL_ReleaseGPUShader(device, fragmentShader.shader);
 	if (!pipeline)
 		throw SDLException{"Couldn't create GPU graphics pipeline"};
 
-	SDL_ReleaseGPUShader(device, vertexShader);
-	SDL_ReleaseGPUShader(device, fragmentShader);
+	co_return pipeline;
+}
+
+int Run(const std::span<char *> arguments) {
+	StartupTimeline startupTimeline;
+	auto antiAliasingSettings{ParseAntiAliasingSettings(arguments)};
+	const auto headless{ParseHeadlessSettings(arguments)};
+	const auto textureQuality{ParseTextureQuality(arguments)};
+	const auto jobThreadCount{
+		FindUnsignedOption(arguments, "job-threads", 0u, 256u).value_or(
+			static_cast<Uint32>(std::max(SDL_GetNumLogicalCPUCores() - 1, 0)))
+	};
+	const auto maxRecordingChunkCount{FindUnsignedOption(arguments, "record-threads", 1u)};
+
+	InstallSdlMemoryTracking();
+	// Runs after main's locals are destroyed, so anything still reported was never released
+	std::atexit(PrintMemoryLeaks);
+	SetProfilerThreadName("Main Thread");
+
+	// The GPU device needs the video subsystem to load Vulkan, the offscreen driver provides it without a display. The
+	// SDL_VIDEO_DRIVER environment variable still takes precedence.
+	if (headless)
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+
+	if (!SDL_Init(SDL_INIT_VIDEO))
+		throw SDLException{"Couldn't initialize SDL"};
+
+	BasePath = SDL_GetBasePath();
+	startupTimeline.EndMainThreadStep("Initialize SDL");
+
+	JobSystem jobSystem{jobThreadCount};
+	std::println("Job threads: {}", jobSystem.GetWorkerCount());
+
+	// Decoding the texture and importing the model take the longest, so they start first and overlap with the device
+	// creation on the main thread
+	RunningTask assetLoads{
+		jobSystem,
+		WhenAll(jobSystem,
+		        TimeStartupStep(startupTimeline, "Load Image",
+		                        LoadTextureAsync(jobSystem, "viking_room.png", TextureUsage::Color, textureQuality),
+		                        {"Initialize SDL"}),
+		        TimeStartupStep(startupTimeline, "Load Mesh", LoadMeshAsync(jobSystem, "viking_room.obj"),
+		                        {"Initialize SDL"}))
+	};
+	// The glyph bitmaps have to be drawn on the main thread, their distance field is computed on the job system
+	const auto glyphBitmaps{RasterizeDebugFont()};
+	RunningTask fontAtlas{
+		jobSystem,
+		TimeStartupStep(startupTimeline, "Generate Font Atlas", GenerateFontAtlasAsync(jobSystem, glyphBitmaps),
+		                {"Initialize SDL"})
+	};
+	startupTimeline.EndMainThreadStep("Start Job System");
+
+	SDL_Window *window{};
+	if (!headless) {
+		window = SDL_CreateWindow("Codotaku Game Engine", 800, 600, SDL_WINDOW_HIDDEN | SDL_WINDOW_RESIZABLE);
+		if (!window)
+			throw SDLException{"Couldn't create window"};
+		startupTimeline.EndMainThreadStep("Create Window");
+	}
+
+	auto device{
+		SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_MSL | SDL_GPU_SHADERFORMAT_DXIL, true,
+		                    nullptr)
+	};
+	if (!device)
+		throw SDLException{"Couldn't create GPU device"};
+
+	std::println("Using GPU device driver: {}", SDL_GetGPUDeviceDriver(device));
+	startupTimeline.EndMainThreadStep("Create GPU Device");
+
+	if (window && !SDL_ClaimWindowForGPUDevice(device, window))
+		throw SDLException{"Couldn't claim window for GPU device"};
+
+
+	SDL_GPUTextureFormat depthStencilFormat;
+
+	if (SDL_GPUTextureSupportsFormat(
+		device,
+		SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT,
+		SDL_GPU_TEXTURETYPE_2D,
+		SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET
+	))
+		depthStencilFormat = SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT;
+	else if (SDL_GPUTextureSupportsFormat(
+		device,
+		SDL_GPU_TEXTUREFORMAT_D32_FLOAT_S8_UINT,
+		SDL_GPU_TEXTURETYPE_2D,
+		SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET
+	))
+		depthStencilFormat = SDL_GPU_TEXTUREFORMAT_D32_FLOAT_S8_UINT;
+	else
+		throw SDLException{"Couldn't find a suitable depth stencil format"};
 
 	int windowWidth, windowHeight;
-	if (!SDL_GetWindowSize(window, &windowWidth, &windowHeight))
+	if (headless) {
+		windowWidth = static_cast<int>(headless->width);
+		windowHeight = static_cast<int>(headless->height);
+	} else if (!SDL_GetWindowSize(window, &windowWidth, &windowHeight))
 		throw SDLException{"Couldn't get window size"};
 
-	// msaa texture
-	SDL_GPUTextureCreateInfo msaaTextureCreateInfo{
-		.format = SDL_GetGPUSwapchainTextureFormat(device, window),
-		.usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
-		.width = static_cast<Uint32>(windowWidth),
-		.height = static_cast<Uint32>(windowHeight),
-		.layer_count_or_depth = 1,
-		.num_levels = 1,
-		.sample_count = msaaSampleCount,
-	};
-	auto msaaTexture{SDL_CreateGPUTexture(device, &msaaTextureCreateInfo)};
-	if (!msaaTexture)
-		throw SDLException{"Couldn't create GPU texture"};
-	SDL_SetGPUTextureName(device, msaaTexture, "MSAA Texture");
-
-	SDL_GPUTextureCreateInfo depthStencilTextureCreateInfo{
-		.format = depthStencilFormat,
-		.usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET,
-		.width = static_cast<Uint32>(windowWidth),
-		.height = static_cast<Uint32>(windowHeight),
-		.layer_count_or_depth = 1,
-		.num_levels = 1,
-		.sample_count = msaaSampleCount,
+	const auto colorFormat{headless ? OffscreenFormat : SDL_GetGPUSwapchainTextureFormat(device, window)};
+	antiAliasingSettings.msaaSampleCount = ClampSampleCount(device, colorFormat, depthStencilFormat,
+	                                                        antiAliasingSettings.msaaSampleCount);
+	std::println("Anti-aliasing: {} (F1 to cycle), MSAA x{} (F2 to cycle), FXAA split view with F3",
+	             ToString(antiAliasingSettings.mode), 1u << antiAliasingSettings.msaaSampleCount);
+	startupTimeline.EndMainThreadStep("Claim Window");
+
+	// Shader files are read while the renderer's other resources are created
+	RunningTask scenePipeline{
+		jobSystem,
+		TimeStartupStep(startupTimeline, "Load Scene Pipeline",
+		                CreateScenePipelineAsync(jobSystem, device, antiAliasingSettings, colorFormat,
+		                                         depthStencilFormat), {"Claim Window"})
 	};
-	auto depthStencilTexture{SDL_CreateGPUTexture(device, &depthStencilTextureCreateInfo)};
-	if (!depthStencilTexture)
-		throw SDLException{"Couldn't create GPU texture"};
-	SDL_SetGPUTextureName(device, depthStencilTexture, "Depth Stencil Texture");
+
+	ParallelRecorder parallelRecorder{
+		device, jobSystem, maxRecordingChunkCount.value_or(jobSystem.GetThreadCount())
+	};
+	std::println("Recording threads: {}", parallelRecorder.GetMaxChunkCount());
+	// Chunks can't resolve into the swapchain, so a scene drawn straight into it gets a target of its own once its draw
+	// list is first split
+	auto offscreenSceneColor{false};
+	// Frames are summed for the periodic log, for the anti-aliasing mode they were rendered with, comparing the modes'
+	// cost, and for the stress report once the warm-up is over
+	constexpr Uint32 LogGpuStats{0};
+	constexpr Uint32 AntiAliasingGpuStats{1};
+	constexpr Uint32 StressGpuStats{AntiAliasingGpuStats + AntiAliasingModeCount};
+	GpuFrameTimer gpuFrameTimer{device, StressGpuStats + 1};
+	ScreenshotCapture screenshotCapture{device, jobSystem};
+	VideoRecorder videoRecorder{device};
+
+	auto renderTargets{
+		CreateRenderTargets(device, antiAliasingSettings, colorFormat, depthStencilFormat,
+		                    static_cast<Uint32>(windowWidth), static_cast<Uint32>(windowHeight), offscreenSceneColor)
+	};
+	TemporalResolve temporalResolve;
+	if (antiAliasingSettings.mode == AntiAliasingMode::TAA)
+		temporalResolve = CreateTemporalResolve(device, colorFormat);
+	PostProcessAntiAliasing postProcessAntiAliasing;
+	if (antiAliasingSettings.mode == AntiAliasingMode::FXAA)
+		postProcessAntiAliasing = CreatePostProcessAntiAliasing(device, colorFormat);
 
 	SDL_GPUSamplerCreateInfo samplerCreateInfo{
 		.min_filter = SDL_GPU_FILTER_LINEAR,
@@ -251,77 +269,55 @@ int main() {
 		SDL_CreateGPUSampler(device, &samplerCreateInfo)
 	};
 
-	SDL_Surface *imageData{
-		LoadImage("viking_room.png", 4)
-	};
+	OffscreenTarget offscreenTarget;
+	if (headless)
+		offscreenTarget = CreateOffscreenTarget(device, headless->width, headless->height);
+	if (headless && headless->outputDirectory)
+		std::filesystem::create_directories(*headless->outputDirectory);
+	// Frames that are read back are drawn here and blitted to the swapchain, created once the first one is captured
+	OffscreenTarget captureTarget;
+
+	startupTimeline.EndMainThreadStep("Create Renderer");
+
+	auto pipeline{scenePipeline.Get()};
+	startupTimeline.EndMainThreadStep("Wait for Scene Pipeline", {"Load Scene Pipeline"});
+
+	auto [textureImage, mesh]{assetLoads.Get()};
+	startupTimeline.EndMainThreadStep("Wait for Assets", {"Load Image", "Load Mesh"});
+	std::println("Texture quality: {}, viking_room.png at {}x{} {}", ToString(textureQuality), textureImage.width,
+	             textureImage.height, ToString(textureImage.format));
 
 	SDL_GPUTextureCreateInfo textureCreateInfo{
-		.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+		.format = textureImage.format,
 		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
-		.width = static_cast<Uint32>(imageData->w),
-		.height = static_cast<Uint32>(imageData->h),
+		.width = textureImage.width,
+		.height = textureImage.height,
 		.layer_count_or_depth = 1,
 		.num_levels = 1,
 	};
-	auto texture{SDL_CreateGPUTexture(device, &textureCreateInfo)};
-	if (!texture)
-		throw SDLException{"Couldn't create GPU texture"};
-
-	SDL_SetGPUTextureName(device, texture, "viking_room.png");
-
-	Assimp::Importer importer;
-	const auto *scene{importer.ReadFile("Content/Models/viking_room.obj", aiProcess_Triangulate)};
-	if (!scene)
-		throw std::runtime_error{"Couldn't load model"};
-
-	// cube
-	std::vector<Vertex> vertices;
-	std::vector<Uint32> indices;
-
-	for (size_t i{}; i < scene->mNumMeshes; ++i) {
-		const auto *mesh{scene->mMeshes[i]};
-		for (size_t j{}; j < mesh->mNumVertices; ++j) {
-			const auto &vertex{mesh->mVertices[j]};
-			vertices.push_back({
-				.position = glm::vec3{vertex.x, vertex.y, vertex.z},
-				.uv = mesh->mTextureCoords[0]
-					      ? glm::vec2{mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y}
-					      : glm::vec2{0.0f, 0.0f},
-			});
-		}
-		for (size_t j{}; j < mesh->mNumFaces; ++j) {
-			const auto &face{mesh->mFaces[j]};
-			for (size_t k{}; k < face.mNumIndices; ++k)
-				indices.push_back(face.mIndices[k]);
-		}
-	}
+	auto texture{CreateTrackedTexture(device, textureCreateInfo, MemoryTag::Assets, "viking_room.png")};
+
+	const auto &[vertices, indices]{mesh};
 
 	SDL_GPUBufferCreateInfo vertexBufferCreateInfo{
 		.usage = SDL_GPU_BUFFERUSAGE_VERTEX,
 		.size = static_cast<Uint32>(vertices.size() * sizeof(Vertex)),
 	};
-	auto vertexBuffer{SDL_CreateGPUBuffer(device, &vertexBufferCreateInfo)};
-	if (!vertexBuffer)
-		throw SDLException{"Couldn't create GPU buffer"};
-
-	SDL_SetGPUBufferName(device, vertexBuffer, "Vertex Buffer");
+	auto vertexBuffer{CreateTrackedBuffer(device, vertexBufferCreateInfo, MemoryTag::Assets, "Vertex Buffer")};
 
 	SDL_GPUBufferCreateInfo indexBufferCreateInfo{
 		.usage = SDL_GPU_BUFFERUSAGE_INDEX,
 		.size = static_cast<Uint32>(indices.size() * sizeof(Uint32)),
 	};
-	auto indexBuffer{SDL_CreateGPUBuffer(device, &indexBufferCreateInfo)};
-	if (!indexBuffer)
-		throw SDLException{"Couldn't create GPU buffer"};
-	SDL_SetGPUBufferName(device, indexBuffer, "Index Buffer");
+	auto indexBuffer{CreateTrackedBuffer(device, indexBufferCreateInfo, MemoryTag::Assets, "Index Buffer")};
 
 	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo{
 		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
 		.size = vertexBufferCreateInfo.size + indexBufferCreateInfo.size,
 	};
-	auto transferBuffer{SDL_CreateGPUTransferBuffer(device, &transferBufferCreateInfo)};
-	if (!transferBuffer)
-		throw SDLException{"Couldn't create transfer buffer"};
+	auto transferBuffer{
+		CreateTrackedTransferBuffer(device, transferBufferCreateInfo, MemoryTag::Assets, "Mesh Upload Buffer")
+	};
 
 	auto transferBufferDataPtr{static_cast<Uint8 *>(SDL_MapGPUTransferBuffer(device, transferBuffer, false))};
 	if (!transferBufferDataPtr)
@@ -338,11 +334,11 @@ int main() {
 	SDL_UnmapGPUTransferBuffer(device, transferBuffer);
 
 	SDL_GPUTransferBufferCreateInfo textureTransferBufferCreateInfo{
-		.size = static_cast<Uint32>(imageData->pitch * imageData->h),
+		.size = static_cast<Uint32>(textureImage.pixels.size()),
+	};
+	auto textureTransferBuffer{
+		CreateTrackedTransferBuffer(device, textureTransferBufferCreateInfo, MemoryTag::Assets, "Texture Upload Buffer")
 	};
-	auto textureTransferBuffer{SDL_CreateGPUTransferBuffer(device, &textureTransferBufferCreateInfo)};
-	if (!textureTransferBuffer)
-		throw SDLException{"Couldn't create transfer buffer"};
 
 	auto textureTransferBufferDataPtr{
 		static_cast<Uint8 *>(SDL_MapGPUTransferBuffer(device, textureTransferBuffer, false))
@@ -351,11 +347,7 @@ int main() {
 		throw SDLException{"Couldn't map transfer buffer"};
 
 	std::span textureDataSpan{textureTransferBufferDataPtr, textureTransferBufferCreateInfo.size};
-	std::span imagePixels{
-		static_cast<Uint8 *>(imageData->pixels),
-		static_cast<size_t>(imageData->pitch * imageData->h)
-	};
-	std::ranges::copy(imagePixels, textureDataSpan.begin());
+	std::ranges::copy(textureImage.pixels, textureDataSpan.begin());
 
 	SDL_UnmapGPUTransferBuffer(device, textureTransferBuffer);
 
@@ -385,8 +377,8 @@ int main() {
 
 	SDL_GPUTextureRegion textureRegion{
 		.texture = texture,
-		.w = static_cast<Uint32>(imageData->w),
-		.h = static_cast<Uint32>(imageData->h),
+		.w = textureImage.width,
+		.h = textureImage.height,
 		.d = 1
 	};
 	SDL_UploadToGPUTexture(copyPass, &textureTransferInfo, &textureRegion, false);
@@ -396,109 +388,628 @@ int main() {
 	if (!SDL_SubmitGPUCommandBuffer(transferCommandBuffer))
 		throw SDLException{"Couldn't submit GPU command buffer"};
 
-	SDL_ReleaseGPUTransferBuffer(device, transferBuffer);
-	SDL_ReleaseGPUTransferBuffer(device, textureTransferBuffer);
+	ReleaseTrackedTransferBuffer(device, transferBuffer);
+	ReleaseTrackedTransferBuffer(device, textureTransferBuffer);
+
+	textureImage = {};
 
-	SDL_DestroySurface(imageData);
+	startupTimeline.EndMainThreadStep("Upload Assets");
 
-	SDL_ShowWindow(window);
+	// Only created once an overlay is requested, the font atlas is generated in the background either way
+	std::optional<TextRenderer> textRenderer;
+	TextId statsText{};
+	TextId gpuMemoryText{};
+	auto createTextRenderer{
+		[&] {
+			if (textRenderer)
+				return;
+			textRenderer.emplace(device, colorFormat, fontAtlas.Get());
+			statsText = textRenderer->Create();
+			gpuMemoryText = textRenderer->Create();
+		}
+	};
+	auto showStats{HasFlag(arguments, "stats")};
+	auto showGpuMemory{HasFlag(arguments, "gpu-memory")};
+	if (showStats || showGpuMemory) {
+		createTextRenderer();
+		startupTimeline.EndMainThreadStep("Create Text Renderer", {"Generate Font Atlas"});
+	}
+	DebugDrawRenderer debugDrawRenderer{device, colorFormat};
+	startupTimeline.EndMainThreadStep("Create Debug Draw Renderer");
+	UiRenderer uiRenderer{device, colorFormat, glyphBitmaps};
+	startupTimeline.EndMainThreadStep("Create UI Renderer");
+
+	if (window)
+		SDL_ShowWindow(window);
+	startupTimeline.EndMainThreadStep("Show Window");
+	std::println("Started in {:.1f} ms", startupTimeline.GetElapsed());
+	if (HasFlag(arguments, "startup-timeline"))
+		startupTimeline.Print();
 
 	auto isRunning{true};
 	SDL_Event event;
 	float windowAspectRatio{static_cast<float>(windowWidth) / static_cast<float>(windowHeight)};
+	Uint64 frameIndex{};
+	glm::mat4 previousProjectionViewMatrix{1.0f};
+	// SDL keeps up to two frames in flight but only waits for them when acquiring the swapchain, so the frame being
+	// recorded needs a third arena
+	FrameAllocator frameAllocator{3, 1024 * 1024};
+	const auto logAllocations{HasFlag(arguments, "allocation-stats")};
+	const auto logGpuTimes{HasFlag(arguments, "gpu-stats")};
+	const auto traceFrame{FindUnsignedOption<Uint64>(arguments, "trace-frames")};
+	auto writeTrace{
+		[&frameIndex] {
+			const auto path{std::format("trace-{}.json", frameIndex)};
+			WriteChromeTrace(path);
+			std::println("Wrote {}", path);
+		}
+	};
+	constexpr Uint64 StatsLogInterval{300};
+	auto captureScreenshot{false};
+	// Only laid out again every StatsOverlayInterval frames, the text costs nothing in between
+	constexpr Uint64 StatsOverlayInterval{30};
+	// Refreshed with the stats, every texture and buffer grouped by name with its size computed from its shape
+	constexpr size_t GpuMemoryOverlayLineCount{16};
+	// Written after the first frame, once every lazily created buffer exists
+	const auto gpuMemoryCsvPath{FindOption(arguments, "gpu-memory-csv")};
+	auto writeGpuMemoryCsv{
+		[](const std::filesystem::path &path) {
+			WriteGpuMemoryCsv(path);
+			std::println("Wrote {}", path.string());
+		}
+	};
+	// Only the bar of the newest frame and the cursor move every frame, the rest of the panel is cached
+	constexpr Uint32 FrameGraphBarCount{64};
+	std::array<float, FrameGraphBarCount> frameGraph{};
+	auto showUi{HasFlag(arguments, "ui")};
+	auto statsOverlayBegin{SDL_GetPerformanceCounter()};
+	Uint64 statsOverlayCpuTicks{};
+	// Started with the first frame, whose size the video keeps
+	std::optional<std::filesystem::path> videoPath;
+	if (const auto value{FindOption(arguments, "video")})
+		videoPath = std::filesystem::path{*value};
+	auto toMilliseconds{
+		[](const Uint64 ticks) {
+			return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+		}
+	};
+
+	World world;
+	TransformHierarchy transformHierarchy;
+	const MeshInstance meshInstance{.indexCount = static_cast<Uint32>(indices.size())};
+	BoundingSphere meshBounds{};
+	{
+		glm::vec3 min{vertices.front().position};
+		glm::vec3 max{min};
+		for (const auto &vertex: vertices) {
+			min = glm::min(min, vertex.position);
+			max = glm::max(max, vertex.position);
+		}
+		meshBounds.center = (min + max) * 0.5f;
+		for (const auto &vertex: vertices)
+			meshBounds.radius = std::max(meshBounds.radius, distance(meshBounds.center, vertex.position));
+	}
+	SetDebugDrawEnabled(HasFlag(arguments, "debug-draw"));
+	const auto stressScene{ParseStressSceneSettings(arguments)};
+	float sceneRadius{1.0f};
+	std::vector<StressFrameSample> stressSamples;
+	if (stressScene) {
+		sceneRadius = SpawnStressScene(world, transformHierarchy, meshInstance, *stressScene);
+		stressSamples.reserve(stressScene->frameCount);
+		std::println("Stress scene: {} objects", world.GetEntityCount());
+	} else {
+		world.Create(
+			TransformNode{transformHierarchy.Create()},
+			WorldTransform{},
+			Spin{.axis = normalize(glm::vec3{0.0f, 1.0f, 1.0f}), .radiansPerSecond = glm::radians(100.0f)},
+			meshInstance
+		);
+	}
+
+	Uint64 previousTicks{SDL_GetTicks()};
+	float deltaTime{};
+	SystemSchedule systems;
+	systems.AddForEach<TransformNode, const Spin>(
+		"Spin", [&deltaTime, &transformHierarchy](const TransformNode &transformNode, const Spin &spin) {
+			auto transform{transformHierarchy.GetLocal(transformNode.node)};
+			transform.rotation = normalize(angleAxis(spin.radiansPerSecond * deltaTime, spin.axis) * transform.rotation);
+			transformHierarchy.SetLocal(transformNode.node, transform);
+		});
+	systems.Add(
+		"Transforms", SystemAccess::Of<const TransformNode, WorldTransform>(),
+		[&transformHierarchy](World &world, JobSystem &jobSystem) {
+			transformHierarchy.Update(jobSystem);
+			world.ParallelForEach<const TransformNode, WorldTransform>(
+				jobSystem, [&transformHierarchy](const TransformNode &transformNode, WorldTransform &worldTransform) {
+					worldTransform.previousMatrix = worldTransform.matrix;
+					worldTransform.matrix = transformHierarchy.GetWorld(transformNode.node);
+				});
+		});
+
+	auto recreateRenderTargets{
+		[&] {
+			ReleaseRenderTargets(device, renderTargets);
+			renderTargets = CreateRenderTargets(device, antiAliasingSettings, colorFormat, depthStencilFormat,
+			                                    static_cast<Uint32>(windowWidth), static_cast<Uint32>(windowHeight),
+			                                    offscreenSceneColor);
+			temporalResolve.historyValid = false;
+		}
+	};
+	auto printAntiAliasingGpuTimes{
+		[&] {
+			for (Uint32 mode{}; mode < AntiAliasingModeCount; ++mode) {
+				const auto stats{gpuFrameTimer.GetStats(AntiAliasingGpuStats + mode)};
+				if (stats.frameCount)
+					std::println("{:<4} GPU {:.3f} ms per frame (max {:.3f}) over {} frames",
+					             ToString(static_cast<AntiAliasingMode>(mode)), stats.gpuTime / stats.frameCount,
+					             stats.maxGpuTime, stats.frameCount);
+			}
+		}
+	};
+	auto applyAntiAliasingSettings{
+		[&] {
+			std::println("Anti-aliasing: {}, MSAA x{}", ToString(antiAliasingSettings.mode),
+			             1u << antiAliasingSettings.msaaSampleCount);
+
+			SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+			pipeline = SyncWait(jobSystem, CreateScenePipelineAsync(jobSystem, device, antiAliasingSettings, colorFormat,
+			                                                        depthStencilFormat));
+
+			ReleaseTemporalResolve(device, temporalResolve);
+			if (antiAliasingSettings.mode == AntiAliasingMode::TAA)
+				temporalResolve = CreateTemporalResolve(device, colorFormat);
+
+			ReleasePostProcessAntiAliasing(device, postProcessAntiAliasing);
+			if (antiAliasingSettings.mode == AntiAliasingMode::FXAA)
+				postProcessAntiAliasing = CreatePostProcessAntiAliasing(device, colorFormat);
+
+			recreateRenderTargets();
+		}
+	};
 
 	while (isRunning) {
 		auto ticks{SDL_GetTicks()};
+		// A fixed step animates the stress scene and headless frames the same way whatever the frame rate
+		deltaTime = stressScene || headless ? 1.0f / 60.0f : static_cast<float>(ticks - previousTicks) / 1000.0f;
+		previousTicks = ticks;
+		ProfilerFrameMark();
+		const auto frameBegin{SDL_GetPerformanceCounter()};
+		StressFrameSample stressSample{};
+		frameAllocator.BeginFrame();
+		jobSystem.ExecuteMainThreadJobs();
 
 		while (SDL_PollEvent(&event)) {
 			switch (event.type) {
 				case SDL_EVENT_QUIT:
 					isRunning = false;
 				case SDL_EVENT_WINDOW_RESIZED: {
+					if (!window)
+						break;
 					if (!SDL_GetWindowSize(window, &windowWidth, &windowHeight))
 						throw SDLException{"Couldn't get window size"};
 					windowAspectRatio = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
 
-					SDL_ReleaseGPUTexture(device, depthStencilTexture);
-					SDL_ReleaseGPUTexture(device, msaaTexture);
-
-					depthStencilTextureCreateInfo.width = static_cast<Uint32>(windowWidth);
-					depthStencilTextureCreateInfo.height = static_cast<Uint32>(windowHeight);
-
-					msaaTextureCreateInfo.width = static_cast<Uint32>(windowWidth);
-					msaaTextureCreateInfo.height = static_cast<Uint32>(windowHeight);
-
-					msaaTexture = SDL_CreateGPUTexture(device, &msaaTextureCreateInfo);
-					if (!msaaTexture)
-						throw SDLException{"Couldn't create GPU texture"};
-
-					depthStencilTexture = SDL_CreateGPUTexture(device, &depthStencilTextureCreateInfo);
-					if (!depthStencilTexture)
-						throw SDLException{"Couldn't create GPU texture"};
+					recreateRenderTargets();
+				}
+				break;
+				case SDL_EVENT_KEY_DOWN: {
+					if (event.key.repeat)
+						break;
+					if (event.key.key == SDLK_F1) {
+						printAntiAliasingGpuTimes();
+						antiAliasingSettings.mode = NextAntiAliasingMode(antiAliasingSettings.mode);
+						applyAntiAliasingSettings();
+					} else if (event.key.key == SDLK_F2) {
+						// Supported counts start at 1, so the first unsupported one wraps around
+						auto sampleCount{NextSampleCount(antiAliasingSettings.msaaSampleCount)};
+						if (ClampSampleCount(device, colorFormat, depthStencilFormat, sampleCount) != sampleCount)
+							sampleCount = SDL_GPU_SAMPLECOUNT_1;
+						antiAliasingSettings.msaaSampleCount = sampleCount;
+						// MSAA is only timed at its current sample count
+						gpuFrameTimer.TakeStats(AntiAliasingGpuStats + static_cast<Uint32>(AntiAliasingMode::MSAA));
+						applyAntiAliasingSettings();
+					} else if (event.key.key == SDLK_F3) {
+						antiAliasingSettings.fxaaSplitPosition = antiAliasingSettings.fxaaSplitPosition > 0.0f ? 0.0f : 0.5f;
+					} else if (event.key.key == SDLK_F4) {
+						showStats = !showStats;
+						createTextRenderer();
+						textRenderer->SetVisible(statsText, showStats);
+					} else if (event.key.key == SDLK_F5) {
+						SetDebugDrawEnabled(!IsDebugDrawEnabled());
+					} else if (event.key.key == SDLK_F6) {
+						showUi = !showUi;
+					} else if (event.key.key == SDLK_F7) {
+						showGpuMemory = !showGpuMemory;
+						createTextRenderer();
+						textRenderer->SetVisible(gpuMemoryText, showGpuMemory);
+					} else if (event.key.key == SDLK_F8) {
+						writeGpuMemoryCsv(std::format("gpu-memory-{}.csv", frameIndex));
+					} else if (event.key.key == SDLK_F9) {
+						captureScreenshot = true;
+					} else if (event.key.key == SDLK_F10) {
+						if (videoRecorder.IsRecording())
+							videoRecorder.Finish();
+						else
+							videoPath = std::format("video-{}.y4m", frameIndex);
+					} else if (event.key.key == SDLK_F12) {
+						writeTrace();
+					}
 				}
 				break;
 				default: break;
 			}
 		}
 
+		{
+			PROFILE_ZONE("Systems");
+			systems.Run(world, jobSystem);
+		}
+
 		auto commandBuffer{SDL_AcquireGPUCommandBuffer(device)};
 		if (!commandBuffer)
 			throw SDLException{"Couldn't acquire GPU command buffer"};
 
 		SDL_GPUTexture *swapchainTexture;
-		if (!SDL_WaitAndAcquireGPUSwapchainTexture(commandBuffer, window, &swapchainTexture, nullptr, nullptr))
-			throw SDLException{"Couldn't acquire swapchain texture"};
-
-		if (swapchainTexture) {
-			std::array colorTargets{
-				SDL_GPUColorTargetInfo{
-					.texture = msaaTexture,
-					.clear_color = SDL_FColor{0.1f, 0.1f, 0.1f, 1.0f},
-					.load_op = SDL_GPU_LOADOP_CLEAR,
-					.store_op = SDL_GPU_STOREOP_RESOLVE,
-					.resolve_texture = swapchainTexture,
-				}
-			};
-			SDL_GPUDepthStencilTargetInfo depthStencilTarget{
-				.texture = depthStencilTexture,
-				.clear_depth = 1.0f,
-				.load_op = SDL_GPU_LOADOP_CLEAR,
-			};
-			auto renderPass{
-				SDL_BeginGPURenderPass(commandBuffer, colorTargets.data(), colorTargets.size(), &depthStencilTarget)
-			};
-
-			SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
-
-			std::array<SDL_GPUBufferBinding, 1> bindings{{vertexBuffer, 0}};
-			SDL_BindGPUVertexBuffers(renderPass, 0, bindings.data(), bindings.size());
+		Uint32 swapchainWidth, swapchainHeight;
+		if (headless) {
+			swapchainTexture = offscreenTarget.texture;
+			swapchainWidth = offscreenTarget.width;
+			swapchainHeight = offscreenTarget.height;
+		} else {
+			PROFILE_ZONE("Acquire Swapchain");
+			if (!SDL_WaitAndAcquireGPUSwapchainTexture(commandBuffer, window, &swapchainTexture, &swapchainWidth,
+			                                           &swapchainHeight))
+				throw SDLException{"Couldn't acquire swapchain texture"};
+		}
 
-			SDL_GPUBufferBinding indexBufferBinding{indexBuffer, 0};
-			SDL_BindGPUIndexBuffer(renderPass, &indexBufferBinding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+		// The headless target is the engine's own already
+		SDL_GPUTexture *frameTexture{swapchainTexture};
+		if (swapchainTexture && !headless && (captureScreenshot || videoPath || videoRecorder.IsRecording())) {
+			if (captureTarget.width != swapchainWidth || captureTarget.height != swapchainHeight) {
+				ReleaseOffscreenTarget(device, captureTarget);
+				captureTarget = CreateOffscreenTarget(device, swapchainWidth, swapchainHeight, colorFormat);
+			}
+			frameTexture = captureTarget.texture;
+		}
 
-			std::array<SDL_GPUTextureSamplerBinding, 1> textureSamplerBindings{{texture, sampler}};
-			SDL_BindGPUFragmentSamplers(renderPass, 0, textureSamplerBindings.data(), textureSamplerBindings.size());
+		const auto recordBegin{SDL_GetPerformanceCounter()};
+		if (frameTexture) {
+			const auto isTemporal{antiAliasingSettings.mode == AntiAliasingMode::TAA};
 
-			auto projectionMatrix{glm::perspective(glm::radians(45.0f), windowAspectRatio, 0.1f, 100.0f)};
+			auto projectionMatrix{
+				glm::perspective(glm::radians(45.0f), windowAspectRatio, 0.1f, std::max(100.0f, sceneRadius * 4.0f))
+			};
 			auto viewMatrix{
-				lookAt(glm::vec3{0.0f, 0.0f, 2.0f}, glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f})
+				stressScene
+					? GetStressCameraView(frameIndex, sceneRadius)
+					: lookAt(glm::vec3{0.0f, 0.0f, 2.0f}, glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f})
 			};
-			auto modelMatrix{glm::mat4{1.0f}};
-			modelMatrix = rotate(modelMatrix, glm::radians(static_cast<float>(ticks) * 0.1f),
-			                     glm::vec3{0.0f, 1.0f, 1.0f});
 			auto projectionViewMatrix{projectionMatrix * viewMatrix};
-			auto modelViewProjectionMatrix{projectionViewMatrix * modelMatrix};
-			SDL_PushGPUVertexUniformData(commandBuffer, 0, &modelViewProjectionMatrix,
-			                             sizeof(modelViewProjectionMatrix));
+			const auto resetHistory{isTemporal && !temporalResolve.historyValid};
+			if (resetHistory)
+				previousProjectionViewMatrix = projectionViewMatrix;
+
+			std::pmr::vector<DrawCommand> drawList{&frameAllocator.GetCurrent()};
+			{
+				PROFILE_ZONE("Build Draw List");
+				drawList.reserve(world.GetEntityCount());
+				world.ForEach<const WorldTransform, const MeshInstance>(
+					[&](const WorldTransform &transform, const MeshInstance &mesh) {
+						drawList.push_back({
+							.modelMatrix = transform.matrix,
+							.previousModelMatrix = resetHistory ? transform.matrix : transform.previousMatrix,
+							.indexCount = mesh.indexCount,
+							.firstIndex = mesh.firstIndex,
+							.vertexOffset = mesh.vertexOffset,
+						});
+						stressSample.triangleCount += mesh.indexCount / 3;
+					});
+				stressSample.drawCount = static_cast<Uint32>(drawList.size());
+			}
+			const auto chunkCount{parallelRecorder.GetChunkCount(drawList.size())};
+			if (chunkCount && !offscreenSceneColor && !HasSceneColorTarget(antiAliasingSettings)) {
+				offscreenSceneColor = true;
+				recreateRenderTargets();
+			}
+			// Only drawn into when the mode needs it or the list is split, small lists go straight to the swapchain
+			const auto sceneColor{
+				chunkCount || HasSceneColorTarget(antiAliasingSettings) ? renderTargets.color : nullptr
+			};
+			if (IsDebugDrawEnabled()) {
+				PROFILE_ZONE("Debug Draw Bounds");
+				DebugDrawAxes(glm::mat4{1.0f}, sceneRadius * 0.5f);
+				// Green bounds are inside the camera's frustum, red ones culled
+				const auto frustum{ExtractFrustum(projectionViewMatrix)};
+				world.ParallelForEach<const WorldTransform, const MeshInstance>(
+					jobSystem, [&](const WorldTransform &transform, const MeshInstance &) {
+						const auto &matrix{transform.matrix};
+						const BoundingSphere bounds{
+							.center = glm::vec3{matrix * glm::vec4{meshBounds.center, 1.0f}},
+							.radius = meshBounds.radius * std::sqrt(std::max({
+								dot(matrix[0], matrix[0]), dot(matrix[1], matrix[1]), dot(matrix[2], matrix[2])
+							})),
+						};
+						DebugDrawSphere(bounds, IsVisible(frustum, bounds) ? DebugColor::Green : DebugColor::Red);
+					});
+			}
 
-			SDL_DrawGPUIndexedPrimitives(renderPass, indices.size(), 1, 0, 0, 0);
+			const FrameView frameView{
+				.projectionView = projectionViewMatrix,
+				.previousProjectionView = previousProjectionViewMatrix,
+				.jitter = isTemporal
+					          ? GetJitterMatrix(GetTemporalJitter(frameIndex, renderTargets.width, renderTargets.height))
+					          : glm::mat4{1.0f},
+				.isTemporal = isTemporal,
+			};
+			const SceneBindings sceneBindings{
+				.pipeline = pipeline,
+				.vertexBuffer = vertexBuffer,
+				.indexBuffer = indexBuffer,
+				.texture = texture,
+				.sampler = sampler,
+			};
+			ScenePass scenePass{
+				.colorTargets = {
+					SDL_GPUColorTargetInfo{
+						.texture = sceneColor ? sceneColor : frameTexture,
+						.clear_color = SDL_FColor{0.1f, 0.1f, 0.1f, 1.0f},
+						.load_op = SDL_GPU_LOADOP_CLEAR,
+						.store_op = SDL_GPU_STOREOP_STORE,
+					},
+					SDL_GPUColorTargetInfo{
+						.texture = renderTargets.velocity,
+						.clear_color = SDL_FColor{0.0f, 0.0f, 0.0f, 0.0f},
+						.load_op = SDL_GPU_LOADOP_CLEAR,
+						.store_op = SDL_GPU_STOREOP_STORE,
+					},
+				},
+				.colorTargetCount = isTemporal ? 2u : 1u,
+				.depthStencilTarget = {
+					.texture = renderTargets.depthStencil,
+					.clear_depth = 1.0f,
+					.load_op = SDL_GPU_LOADOP_CLEAR,
+				},
+			};
+			const auto isMultisampled{GetSceneSampleCount(antiAliasingSettings) != SDL_GPU_SAMPLECOUNT_1};
 
-			SDL_EndGPURenderPass(renderPass);
+			if (parallelRecorder.RecordAndSubmit(scenePass, sceneBindings, frameView, drawList) == 0) {
+				if (isMultisampled) {
+					scenePass.colorTargets[0].store_op = SDL_GPU_STOREOP_RESOLVE;
+					scenePass.colorTargets[0].resolve_texture = frameTexture;
+				}
+				RecordScenePass(commandBuffer, scenePass, sceneBindings, frameView, drawList);
+			} else if (isMultisampled) {
+				std::array resolveTargets{
+					SDL_GPUColorTargetInfo{
+						.texture = renderTargets.color,
+						.load_op = SDL_GPU_LOADOP_LOAD,
+						.store_op = SDL_GPU_STOREOP_RESOLVE,
+						.resolve_texture = frameTexture,
+					}
+				};
+				SDL_EndGPURenderPass(
+					SDL_BeginGPURenderPass(commandBuffer, resolveTargets.data(), resolveTargets.size(), nullptr));
+			}
+
+			previousProjectionViewMatrix = projectionViewMatrix;
+
+			SDL_GPUTexture *presentedTexture{};
+			if (isTemporal)
+				presentedTexture = RecordTemporalResolve(commandBuffer, temporalResolve, renderTargets);
+			else if (antiAliasingSettings.mode == AntiAliasingMode::FXAA)
+				RecordPostProcessAntiAliasing(commandBuffer, postProcessAntiAliasing, renderTargets, frameTexture,
+				                              antiAliasingSettings.fxaaSplitPosition);
+			else if (!isMultisampled && sceneColor)
+				presentedTexture = sceneColor;
+
+			if (presentedTexture) {
+				SDL_GPUBlitInfo blitInfo{
+					.source = {
+						.texture = presentedTexture,
+						.w = renderTargets.width,
+						.h = renderTargets.height,
+					},
+					.destination = {
+						.texture = frameTexture,
+						.w = swapchainWidth,
+						.h = swapchainHeight,
+					},
+					.load_op = SDL_GPU_LOADOP_DONT_CARE,
+					.filter = SDL_GPU_FILTER_LINEAR,
+				};
+				SDL_BlitGPUTexture(commandBuffer, &blitInfo);
+			}
+
+			debugDrawRenderer.Record(commandBuffer, frameTexture, projectionViewMatrix);
+			if (showUi) {
+				PROFILE_ZONE("Build UI");
+				constexpr float PanelWidth{FrameGraphBarCount * 4.0f + 16.0f};
+				const glm::vec2 panel{static_cast<float>(swapchainWidth) - PanelWidth - 8.0f, 8.0f};
+				uiRenderer.BeginFrame();
+				uiRenderer.Rectangle(MakeUiId("panel"), {panel, PanelWidth, 248.0f}, {0.0f, 0.0f, 0.0f, 0.6f});
+				uiRenderer.Label(MakeUiId("controls"),
+				                 "F1  Anti-aliasing\nF2  MSAA samples\nF3  FXAA split\nF4  Stats\nF5  Debug draw\n"
+				                 "F6  This panel\nF7  GPU memory\nF8  GPU memory CSV\nF9  Screenshot\nF10 Video\n"
+				                 "F12 Trace",
+				                 panel + 8.0f, 1, {1.0f, 1.0f, 1.0f, 0.9f});
+				// Bars are 33 ms high, red once a frame misses 60 Hz
+				const auto graphBottom{panel.y + 200.0f};
+				for (Uint32 bar{}; bar < FrameGraphBarCount; ++bar) {
+					const auto height{std::min(frameGraph[bar] / 33.3f, 1.0f) * 64.0f};
+					uiRenderer.Rectangle(MakeUiId("frame graph", bar),
+					                     {panel.x + 8.0f + static_cast<float>(bar) * 4.0f, graphBottom - height, 3.0f, height},
+					                     frameGraph[bar] > 16.7f
+						                     ? glm::vec4{1.0f, 0.3f, 0.3f, 0.9f}
+						                     : glm::vec4{0.3f, 1.0f, 0.3f, 0.9f});
+				}
+				uiRenderer.Rectangle(MakeUiId("frame graph cursor"),
+				                     {panel.x + 8.0f + static_cast<float>(frameIndex % FrameGraphBarCount) * 4.0f,
+				                      graphBottom + 2.0f, 3.0f, 2.0f}, glm::vec4{1.0f});
+				std::array<char, 64> uiStats;
+				const auto uiStatsEnd{
+					std::format_to_n(uiStats.data(), uiStats.size(), "{} widgets {} new\n{} vertices uploaded",
+					                 uiRenderer.GetWidgetCount(), uiRenderer.GetTessellatedWidgetCount(),
+					                 uiRenderer.GetUploadedVertexCount()).out
+				};
+				uiRenderer.Label(MakeUiId("ui stats"), {uiStats.data(), uiStatsEnd}, {panel.x + 8.0f, graphBottom + 12.0f},
+				                 1, {1.0f, 1.0f, 1.0f, 0.9f});
+				uiRenderer.Record(commandBuffer, frameTexture, swapchainWidth, swapchainHeight);
+			}
+			if (textRenderer)
+				textRenderer->Record(commandBuffer, frameTexture, swapchainWidth, swapchainHeight);
+
+			if (frameTexture != swapchainTexture) {
+				SDL_GPUBlitInfo blitInfo{
+					.source = {
+						.texture = frameTexture,
+						.w = swapchainWidth,
+						.h = swapchainHeight,
+					},
+					.destination = {
+						.texture = swapchainTexture,
+						.w = swapchainWidth,
+						.h = swapchainHeight,
+					},
+					.load_op = SDL_GPU_LOADOP_DONT_CARE,
+				};
+				SDL_BlitGPUTexture(commandBuffer, &blitInfo);
+			}
+		}
+
+		// Written once the frame completed, the frame only pays for the copy
+		GpuFrameTimer::CompletionCallback onFrameComplete;
+		if (frameTexture && (captureScreenshot || (headless && headless->outputDirectory))) {
+			std::filesystem::path path{std::format("screenshot-{}.png", frameIndex)};
+			if (captureScreenshot)
+				std::println("Saving {}", path.string());
+			else
+				path = *headless->outputDirectory / std::format("frame-{}.png", frameIndex);
+			onFrameComplete = screenshotCapture.Capture(commandBuffer, frameTexture, colorFormat, swapchainWidth,
+			                                            swapchainHeight, std::move(path));
+			captureScreenshot = false;
+		}
+		if (frameTexture && videoPath) {
+			std::println("Recording {}", videoPath->string());
+			// Headless and stress frames are animated at a fixed step, others presented at the display's refresh rate
+			Uint32 frameRateNumerator{60};
+			Uint32 frameRateDenominator{1};
+			if (!headless && !stressScene)
+				if (const auto displayMode{SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window))};
+					displayMode && displayMode->refresh_rate_numerator > 0) {
+					frameRateNumerator = static_cast<Uint32>(displayMode->refresh_rate_numerator);
+					frameRateDenominator = static_cast<Uint32>(displayMode->refresh_rate_denominator);
+				}
+			videoRecorder.Start(*videoPath, colorFormat, swapchainWidth, swapchainHeight, frameRateNumerator,
+			                    frameRateDenominator);
+			videoPath.reset();
+		}
+		if (frameTexture && videoRecorder.IsRecording()) {
+			auto onRecorded{videoRecorder.Capture(commandBuffer, frameTexture, swapchainWidth, swapchainHeight)};
+			if (onRecorded)
+				onFrameComplete = [onSaved = std::move(onFrameComplete), onRecorded = std::move(onRecorded)](
+					const bool completed) mutable {
+						if (onSaved)
+							onSaved(completed);
+						onRecorded(completed);
+					};
 		}
 
-		if (!SDL_SubmitGPUCommandBuffer(commandBuffer))
-			throw SDLException{"Couldn't submit GPU command buffer"};
+		const auto submitBegin{SDL_GetPerformanceCounter()};
+		{
+			PROFILE_ZONE("Submit");
+			const auto isStressMeasured{stressScene && frameIndex >= stressScene->warmUpFrameCount};
+			gpuFrameTimer.Submit(commandBuffer, frameBegin, std::move(onFrameComplete),
+			                     1u << LogGpuStats |
+			                     1u << (AntiAliasingGpuStats + static_cast<Uint32>(antiAliasingSettings.mode)) |
+			                     (isStressMeasured ? 1u << StressGpuStats : 0u));
+		}
+		const auto frameEnd{SDL_GetPerformanceCounter()};
+
+		++frameIndex;
+		if (stressScene && frameIndex > stressScene->warmUpFrameCount) {
+			stressSample.frameTime = toMilliseconds(frameEnd - frameBegin);
+			stressSample.recordTime = toMilliseconds(submitBegin - recordBegin);
+			stressSample.submitTime = toMilliseconds(frameEnd - submitBegin);
+			stressSamples.push_back(stressSample);
+			if (stressSamples.size() == stressScene->frameCount)
+				isRunning = false;
+		}
+		if (headless && !stressScene && frameIndex == headless->frameCount)
+			isRunning = false;
+		statsOverlayCpuTicks += frameEnd - frameBegin;
+		frameGraph[frameIndex % FrameGraphBarCount] = static_cast<float>(toMilliseconds(frameEnd - frameBegin));
+		if (showStats && frameIndex % StatsOverlayInterval == 0) {
+			const auto frameTime{toMilliseconds(frameEnd - statsOverlayBegin) / StatsOverlayInterval};
+			textRenderer->Set(
+				statsText,
+				std::format("{:.0f} FPS {:.2f} ms\nCPU {:.2f} ms GPU {:.2f} ms\n{} {}x{}", 1000.0 / frameTime,
+				            frameTime, toMilliseconds(statsOverlayCpuTicks) / StatsOverlayInterval,
+				            gpuFrameTimer.GetLatestTiming().gpuTime, ToString(antiAliasingSettings.mode),
+				            renderTargets.width, renderTargets.height),
+				glm::vec2{8.0f}, 16.0f, glm::vec4{1.0f, 1.0f, 1.0f, 0.9f});
+		}
+		if (showGpuMemory && frameIndex % StatsOverlayInterval == 0)
+			textRenderer->Set(gpuMemoryText, FormatGpuMemoryReport(GpuMemoryOverlayLineCount), glm::vec2{8.0f, 64.0f},
+			                 8.0f, glm::vec4{1.0f, 1.0f, 1.0f, 0.9f});
+		if (frameIndex == 1 && gpuMemoryCsvPath)
+			writeGpuMemoryCsv(*gpuMemoryCsvPath);
+		if (frameIndex % StatsOverlayInterval == 0) {
+			statsOverlayBegin = frameEnd;
+			statsOverlayCpuTicks = 0;
+		}
+		if (frameIndex == traceFrame)
+			writeTrace();
+		if (logAllocations && frameIndex % StatsLogInterval == 0) {
+			PrintMemoryReport();
+			std::println("Frame arena peak {} KiB", frameAllocator.GetPeak() / 1024);
+		}
+		if (logGpuTimes && frameIndex % StatsLogInterval == 0) {
+			// Frames still in flight are counted in the next report
+			const auto stats{gpuFrameTimer.TakeStats(LogGpuStats)};
+			const auto frameCount{static_cast<double>(std::max(stats.frameCount, 1u))};
+			std::println("Last {} frames: CPU {:.2f} ms, GPU {:.2f} ms (max {:.2f}), submit to complete {:.2f} ms, "
+			             "overlap {:.2f} ms, {} GPU bound", stats.frameCount, stats.cpuTime / frameCount,
+			             stats.gpuTime / frameCount, stats.maxGpuTime, stats.submitToComplete / frameCount,
+			             stats.overlap / frameCount, stats.gpuBoundFrameCount);
+		}
 	}
 
+	gpuFrameTimer.Stop();
+	printAntiAliasingGpuTimes();
+	screenshotCapture.Stop();
+	videoRecorder.Stop();
+	if (stressScene)
+		PrintStressSceneReport(*stressScene, stressSamples, gpuFrameTimer.TakeStats(StressGpuStats));
+	if (!SDL_WaitForGPUIdle(device))
+		throw SDLException{"Couldn't wait for GPU idle"};
+	if (textRenderer)
+		textRenderer->Release();
+	debugDrawRenderer.Release();
+	uiRenderer.Release();
+	ReleaseOffscreenTarget(device, offscreenTarget);
+	ReleaseOffscreenTarget(device, captureTarget);
+	ReleasePostProcessAntiAliasing(device, postProcessAntiAliasing);
+	ReleaseTemporalResolve(device, temporalResolve);
+	ReleaseRenderTargets(device, renderTargets);
+	SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+	SDL_ReleaseGPUSampler(device, sampler);
+	ReleaseTrackedTexture(device, texture);
+	ReleaseTrackedBuffer(device, vertexBuffer);
+	ReleaseTrackedBuffer(device, indexBuffer);
+	if (window)
+		SDL_ReleaseWindowFromGPUDevice(device, window);
+	SDL_DestroyGPUDevice(device);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
 	return EXIT_SUCCESS;
 }
+
+int main(int argc, char **argv) {
+	try {
+		return Run(std::span{argv, static_cast<size_t>(argc)}.subspan(1));
+	} catch (const UsageError &error) {
+		std::println(stderr, "{}", error.what());
+		return EXIT_FAILURE;
+	}
+}
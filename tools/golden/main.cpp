@@ -0,0 +1,166 @@
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+#include "CommandLine.hpp"
+#include "ImageDiff.hpp"
+#include "SDLException.hpp"
+
+namespace {
+	// Golden images only compare at the size they were rendered at
+	constexpr std::string_view RenderSize{"640x360"};
+	// Reported as skipped by ctest rather than passed
+	constexpr int SkipExitCode{77};
+
+	struct GoldenScene {
+		std::string_view name;
+		std::vector<std::string_view> arguments;
+		// Frames rendered at the engine's fixed headless time step, the last one is compared
+		Uint32 frameCount;
+		double minPsnr{40.0};
+		// The same software driver renders the same image, this only leaves room for a different Mesa version
+		Uint8 maxError{8};
+	};
+
+	const std::vector<GoldenScene> Scenes{
+		{.name = "no-aa", .arguments = {"--aa=none"}, .frameCount = 10},
+		{.name = "msaa", .arguments = {"--aa=msaa", "--msaa=4"}, .frameCount = 10},
+		{.name = "fxaa", .arguments = {"--aa=fxaa"}, .frameCount = 10},
+		// The history converges over the 8 frame jitter sequence, small differences are amplified along the way
+		{.name = "taa", .arguments = {"--aa=taa"}, .frameCount = 16, .minPsnr = 35.0, .maxError = 96},
+		{
+			.name = "stress-1000",
+			.arguments = {"--aa=none", "--stress=1000", "--stress-warm-up=9", "--stress-frames=1"},
+			.frameCount = 10,
+		},
+	};
+
+	// Null when the file doesn't exist
+	SDL_Surface *LoadRgba(const std::filesystem::path &path) {
+		if (!std::filesystem::exists(path))
+			return nullptr;
+		auto image{IMG_Load(path.string().c_str())};
+		if (!image)
+			throw SDLException{"Couldn't load " + path.string()};
+		auto converted{SDL_ConvertSurface(image, SDL_PIXELFORMAT_RGBA32)};
+		SDL_DestroySurface(image);
+		if (!converted)
+			throw SDLException{"Couldn't convert " + path.string()};
+		return converted;
+	}
+
+	// Renders the scene headless and returns its exit code
+	int RenderScene(const GoldenScene &scene, const std::filesystem::path &outputDirectory) {
+		std::vector<std::string> arguments{
+			(std::filesystem::path{SDL_GetBasePath()} / ENGINE_EXECUTABLE).string(),
+			"--headless",
+			std::format("--headless-size={}", RenderSize),
+			std::format("--headless-frames={}", scene.frameCount),
+			std::format("--headless-output={}", outputDirectory.string()),
+		};
+		for (const auto argument: scene.arguments)
+			arguments.emplace_back(argument);
+
+		std::vector<const char *> argumentPointers;
+		for (const auto &argument: arguments)
+			argumentPointers.push_back(argument.c_str());
+		argumentPointers.push_back(nullptr);
+
+		auto process{SDL_CreateProcess(argumentPointers.data(), false)};
+		if (!process)
+			throw SDLException{"Couldn't start " + arguments.front()};
+		int exitCode{};
+		SDL_WaitProcess(process, true, &exitCode);
+		SDL_DestroyProcess(process);
+		return exitCode;
+	}
+
+	// Whether the scene's last frame matches its golden image, or replaces the golden image when updating
+	bool CheckScene(const GoldenScene &scene, const std::filesystem::path &goldenDirectory,
+	                const std::filesystem::path &outputDirectory, const bool update) {
+		const auto sceneDirectory{outputDirectory / scene.name};
+		std::filesystem::remove_all(sceneDirectory);
+		if (const auto exitCode{RenderScene(scene, sceneDirectory)}) {
+			std::println("{:<12} FAIL engine exited with code {}", scene.name, exitCode);
+			return false;
+		}
+
+		const auto framePath{sceneDirectory / std::format("frame-{}.png", scene.frameCount - 1)};
+		const auto goldenPath{goldenDirectory / (std::string{scene.name} + ".png")};
+		if (update) {
+			std::filesystem::create_directories(goldenDirectory);
+			std::filesystem::copy_file(framePath, goldenPath, std::filesystem::copy_options::overwrite_existing);
+			std::println("{:<12} updated {}", scene.name, goldenPath.string());
+			return true;
+		}
+
+		auto golden{LoadRgba(goldenPath)};
+		if (!golden) {
+			std::println("{:<12} FAIL no golden image, create it with --update", scene.name);
+			return false;
+		}
+		auto frame{LoadRgba(framePath)};
+		if (!frame)
+			throw std::runtime_error{"Engine didn't write " + framePath.string()};
+
+		auto passed{frame->w == golden->w && frame->h == golden->h};
+		if (!passed)
+			std::println("{:<12} FAIL rendered {}x{} but the golden image is {}x{}", scene.name, frame->w, frame->h,
+			             golden->w, golden->h);
+		else {
+			auto diff{SDL_CreateSurface(frame->w, frame->h, SDL_PIXELFORMAT_RGBA32)};
+			if (!diff)
+				throw SDLException{"Couldn't create diff image"};
+			const auto result{DiffImages(frame, golden, diff)};
+			passed = result.psnr >= scene.minPsnr && result.maxError <= scene.maxError;
+			std::println("{:<12} {} PSNR {:.2f} dB (min {:.1f}), max error {} (max {})", scene.name,
+			             passed ? "pass" : "FAIL", result.psnr, scene.minPsnr, result.maxError, scene.maxError);
+			if (result.maxError > 0) {
+				const auto diffPath{outputDirectory / (std::string{scene.name} + "-diff.png")};
+				if (!IMG_SavePNG(diff, diffPath.string().c_str()))
+					throw SDLException{"Couldn't save " + diffPath.string()};
+			}
+			SDL_DestroySurface(diff);
+		}
+
+		SDL_DestroySurface(frame);
+		SDL_DestroySurface(golden);
+		return passed;
+	}
+}
+
+int main(int argc, char **argv) {
+	const auto arguments{std::span{argv, static_cast<size_t>(argc)}.subspan(1)};
+	const auto filter{FindOption(arguments, "filter").value_or("")};
+	const auto update{HasFlag(arguments, "update")};
+	const std::filesystem::path goldenDirectory{FindOption(arguments, "goldens").value_or(GOLDEN_IMAGE_DIRECTORY)};
+	const std::filesystem::path outputDirectory{FindOption(arguments, "output").value_or("golden-output")};
+	if (const auto driver{FindOption(arguments, "vulkan-driver")}; driver && !std::filesystem::exists(*driver)) {
+		std::println("No Vulkan driver manifest at {}, the golden images need lavapipe", *driver);
+		return SkipExitCode;
+	}
+	if (!update && !std::filesystem::is_directory(goldenDirectory)) {
+		std::println("No golden images in {}, render them with --update", goldenDirectory.string());
+		return SkipExitCode;
+	}
+	std::filesystem::create_directories(outputDirectory);
+
+	Uint32 failedCount{};
+	for (const auto &scene: Scenes)
+		if (scene.name.contains(filter) && !CheckScene(scene, goldenDirectory, outputDirectory, update))
+			++failedCount;
+
+	if (failedCount) {
+		std::println("{} scenes failed, frames and diff images are in {}", failedCount, outputDirectory.string());
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
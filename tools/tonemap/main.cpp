@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+#include "CommandLine.hpp"
+#include "HdrImage.hpp"
+#include "ImageDiff.hpp"
+#include "JobSystem.hpp"
+#include "SDLException.hpp"
+#include "ToneMapping.hpp"
+
+namespace {
+	constexpr std::array Operators{
+		ToneMapOperator::None, ToneMapOperator::Reinhard, ToneMapOperator::ExtendedReinhard, ToneMapOperator::Hable,
+		ToneMapOperator::Aces,
+	};
+	constexpr std::array TransferFunctions{TransferFunction::Srgb, TransferFunction::Pq};
+
+	// Long enough for a stable best time on a single core too
+	constexpr std::chrono::milliseconds BenchmarkTime{300};
+
+	template<typename Function>
+	double MeasureMegapixelsPerSecond(const HdrImage &image, Function &&function) {
+		using Clock = std::chrono::steady_clock;
+		auto best{Clock::duration::max()};
+		const auto start{Clock::now()};
+		do {
+			const auto runStart{Clock::now()};
+			function();
+			best = std::min(best, Clock::now() - runStart);
+		} while (Clock::now() - start < BenchmarkTime);
+		return static_cast<double>(image.width) * image.height / std::chrono::duration<double, std::micro>(best).count();
+	}
+
+	// Wraps RGBA32 pixels without copying them, the surface has to be destroyed before the pixels
+	SDL_Surface *WrapPixels(std::vector<Uint8> &pixels, const Uint32 width, const Uint32 height) {
+		auto surface{
+			SDL_CreateSurfaceFrom(static_cast<int>(width), static_cast<int>(height), SDL_PIXELFORMAT_RGBA32,
+			                      pixels.data(), static_cast<int>(width * 4))
+		};
+		if (!surface)
+			throw SDLException{"Couldn't create surface"};
+		return surface;
+	}
+
+	void SavePng(std::vector<Uint8> &pixels, const Uint32 width, const Uint32 height, const std::filesystem::path &path) {
+		auto surface{WrapPixels(pixels, width, height)};
+		const auto saved{IMG_SavePNG(surface, path.string().c_str())};
+		SDL_DestroySurface(surface);
+		if (!saved)
+			throw SDLException{"Couldn't save " + path.string()};
+	}
+
+	bool ReportDiff(const std::string_view label, const SDL_Surface *result, const SDL_Surface *reference,
+	                const Uint8 maxError) {
+		const auto diff{DiffImages(result, reference)};
+		const auto passed{diff.maxError <= maxError};
+		std::println("{:<23} {} PSNR {:.2f} dB, max error {} (max {})", label, passed ? "pass" : "FAIL", diff.psnr,
+		             diff.maxError, maxError);
+		return passed;
+	}
+
+	// Whether the result matches an image made elsewhere
+	bool CompareWithReference(std::vector<Uint8> &pixels, const Uint32 width, const Uint32 height,
+	                          const std::filesystem::path &path, const Uint8 maxError) {
+		auto loaded{IMG_Load(path.string().c_str())};
+		if (!loaded)
+			throw SDLException{"Couldn't load " + path.string()};
+		auto reference{SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32)};
+		SDL_DestroySurface(loaded);
+		if (!reference)
+			throw SDLException{"Couldn't convert " + path.string()};
+		auto result{WrapPixels(pixels, width, height)};
+
+		auto passed{result->w == reference->w && result->h == reference->h};
+		if (!passed)
+			std::println("{:<23} FAIL the reference is {}x{}", "reference", reference->w, reference->h);
+		else
+			passed = ReportDiff("reference", result, reference, maxError);
+		SDL_DestroySurface(result);
+		SDL_DestroySurface(reference);
+		return passed;
+	}
+
+	// Whether two results of the same image match
+	bool ComparePixels(const std::string_view label, std::vector<Uint8> &pixels, std::vector<Uint8> &expected,
+	                   const Uint32 width, const Uint32 height, const Uint8 maxError) {
+		auto result{WrapPixels(pixels, width, height)};
+		auto reference{WrapPixels(expected, width, height)};
+		const auto passed{ReportDiff(label, result, reference, maxError)};
+		SDL_DestroySurface(result);
+		SDL_DestroySurface(reference);
+		return passed;
+	}
+
+	// The shaders run in 8x8 groups, read InImage as a read-only storage texture and write OutImage, both RGBA32F
+	constexpr Uint32 ComputeGroupSize{8};
+
+	std::string_view ToneMapShaderName(const ToneMapOperator toneMapOperator) {
+		switch (toneMapOperator) {
+			case ToneMapOperator::Reinhard: return "ToneMapReinhard.comp";
+			case ToneMapOperator::ExtendedReinhard: return "ToneMapExtendedReinhardLuminance.comp";
+			case ToneMapOperator::Hable: return "ToneMapHable.comp";
+			case ToneMapOperator::Aces: return "ToneMapACES.comp";
+			case ToneMapOperator::None: break;
+		}
+		return {};
+	}
+
+	std::string_view EncodeShaderName(const TransferFunction transferFunction) {
+		return transferFunction == TransferFunction::Srgb ? "LinearToSRGB.comp" : "LinearToST2084.comp";
+	}
+
+	SDL_GPUComputePipeline *LoadComputePipeline(SDL_GPUDevice *device, const std::string_view shaderName) {
+		const auto shaderDirectory{std::filesystem::path{SDL_GetBasePath()} / "Content" / "Shaders" / "Compiled"};
+		const auto backendFormats{SDL_GetGPUShaderFormats(device)};
+		std::filesystem::path path;
+		SDL_GPUShaderFormat format;
+		auto entrypoint{"main"};
+		if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV) {
+			path = shaderDirectory / "SPIRV" / (std::string{shaderName} + ".spv");
+			format = SDL_GPU_SHADERFORMAT_SPIRV;
+		} else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL) {
+			path = shaderDirectory / "MSL" / (std::string{shaderName} + ".msl");
+			format = SDL_GPU_SHADERFORMAT_MSL;
+			entrypoint = "main0";
+		} else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL) {
+			path = shaderDirectory / "DXIL" / (std::string{shaderName} + ".dxil");
+			format = SDL_GPU_SHADERFORMAT_DXIL;
+		} else throw std::runtime_error{"No supported shader formats available"};
+
+		size_t codeSize{};
+		auto code{SDL_LoadFile(path.string().c_str(), &codeSize)};
+		if (!code)
+			throw SDLException{"Couldn't load " + path.string()};
+		const SDL_GPUComputePipelineCreateInfo createInfo{
+			.code_size = codeSize,
+			.code = static_cast<const Uint8 *>(code),
+			.entrypoint = entrypoint,
+			.format = format,
+			.num_readonly_storage_textures = 1,
+			.num_readwrite_storage_textures = 1,
+			.threadcount_x = ComputeGroupSize,
+			.threadcount_y = ComputeGroupSize,
+			.threadcount_z = 1,
+		};
+		auto pipeline{SDL_CreateGPUComputePipeline(device, &createInfo)};
+		SDL_free(code);
+		if (!pipeline)
+			throw SDLException{"Couldn't create compute pipeline " + std::string{shaderName}};
+		return pipeline;
+	}
+
+	SDL_GPUTransferBuffer *CreateTransferBuffer(SDL_GPUDevice *device, const SDL_GPUTransferBufferUsage usage,
+	                                            const Uint32 size) {
+		const SDL_GPUTransferBufferCreateInfo createInfo{.usage = usage, .size = size};
+		auto transferBuffer{SDL_CreateGPUTransferBuffer(device, &createInfo)};
+		if (!transferBuffer)
+			throw SDLException{"Couldn't create transfer buffer"};
+		return transferBuffer;
+	}
+
+	// Runs the ToneMap*.comp shader of the operator, if any, then the LinearTo*.comp one, and reads the result back as
+	// RGBA32 pixels rounded like ToneMapPixels does
+	std::vector<Uint8> ToneMapOnGpu(SDL_GPUDevice *device, const HdrImage &image, const ToneMapOperator toneMapOperator,
+	                                const TransferFunction transferFunction) {
+		std::vector<SDL_GPUComputePipeline *> pipelines;
+		if (toneMapOperator != ToneMapOperator::None)
+			pipelines.push_back(LoadComputePipeline(device, ToneMapShaderName(toneMapOperator)));
+		pipelines.push_back(LoadComputePipeline(device, EncodeShaderName(transferFunction)));
+
+		// Every pass reads the texture before its output
+		std::vector<SDL_GPUTexture *> textures;
+		for (size_t texture{}; texture <= pipelines.size(); ++texture) {
+			const SDL_GPUTextureCreateInfo createInfo{
+				.type = SDL_GPU_TEXTURETYPE_2D,
+				.format = SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT,
+				.usage = SDL_GPU_TEXTUREUSAGE_COMPUTE_STORAGE_READ | SDL_GPU_TEXTUREUSAGE_COMPUTE_STORAGE_WRITE,
+				.width = image.width,
+				.height = image.height,
+				.layer_count_or_depth = 1,
+				.num_levels = 1,
+			};
+			textures.push_back(SDL_CreateGPUTexture(device, &createInfo));
+			if (!textures.back())
+				throw SDLException{"Couldn't create texture"};
+		}
+
+		const auto byteCount{static_cast<Uint32>(image.pixels.size() * sizeof(float))};
+		auto uploadBuffer{CreateTransferBuffer(device, SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, byteCount)};
+		auto downloadBuffer{CreateTransferBuffer(device, SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD, byteCount)};
+		const auto mapped{SDL_MapGPUTransferBuffer(device, uploadBuffer, false)};
+		if (!mapped)
+			throw SDLException{"Couldn't map transfer buffer"};
+		std::memcpy(mapped, image.pixels.data(), byteCount);
+		SDL_UnmapGPUTransferBuffer(device, uploadBuffer);
+
+		auto commandBuffer{SDL_AcquireGPUCommandBuffer(device)};
+		if (!commandBuffer)
+			throw SDLException{"Couldn't acquire command buffer"};
+		const SDL_GPUTextureTransferInfo uploadInfo{.transfer_buffer = uploadBuffer};
+		const SDL_GPUTextureRegion inputRegion{
+			.texture = textures.front(), .w = image.width, .h = image.height, .d = 1
+		};
+		auto copyPass{SDL_BeginGPUCopyPass(commandBuffer)};
+		SDL_UploadToGPUTexture(copyPass, &uploadInfo, &inputRegion, false);
+		SDL_EndGPUCopyPass(copyPass);
+
+		for (size_t pass{}; pass < pipelines.size(); ++pass) {
+			const SDL_GPUStorageTextureReadWriteBinding output{.texture = textures[pass + 1]};
+			auto computePass{SDL_BeginGPUComputePass(commandBuffer, &output, 1, nullptr, 0)};
+			SDL_BindGPUComputePipeline(computePass, pipelines[pass]);
+			SDL_BindGPUComputeStorageTextures(computePass, 0, &textures[pass], 1);
+			SDL_DispatchGPUCompute(computePass, (image.width + ComputeGroupSize - 1) / ComputeGroupSize,
+			                       (image.height + ComputeGroupSize - 1) / ComputeGroupSize, 1);
+			SDL_EndGPUComputePass(computePass);
+		}
+
+		const SDL_GPUTextureRegion outputRegion{
+			.texture = textures.back(), .w = image.width, .h = image.height, .d = 1
+		};
+		const SDL_GPUTextureTransferInfo downloadInfo{.transfer_buffer = downloadBuffer};
+		copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+		SDL_DownloadFromGPUTexture(copyPass, &outputRegion, &downloadInfo);
+		SDL_EndGPUCopyPass(copyPass);
+		auto fence{SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer)};
+		if (!fence)
+			throw SDLException{"Couldn't submit command buffer"};
+		SDL_WaitForGPUFences(device, true, &fence, 1);
+		SDL_ReleaseGPUFence(device, fence);
+
+		std::vector<Uint8> pixels(image.pixels.size());
+		const auto *result{static_cast<const float *>(SDL_MapGPUTransferBuffer(device, downloadBuffer, false))};
+		if (!result)
+			throw SDLException{"Couldn't map transfer buffer"};
+		std::ranges::transform(result, result + pixels.size(), pixels.begin(), [](const float channel) {
+			return static_cast<Uint8>(std::clamp(channel, 0.0f, 1.0f) * 255.0f + 0.5f);
+		});
+		SDL_UnmapGPUTransferBuffer(device, downloadBuffer);
+
+		SDL_ReleaseGPUTransferBuffer(device, uploadBuffer);
+		SDL_ReleaseGPUTransferBuffer(device, downloadBuffer);
+		for (const auto texture: textures)
+			SDL_ReleaseGPUTexture(device, texture);
+		for (const auto pipeline: pipelines)
+			SDL_ReleaseGPUComputePipeline(device, pipeline);
+		return pixels;
+	}
+}
+
+int Run(const std::span<char *> arguments) {
+	std::filesystem::path inputPath{
+		std::filesystem::path{SDL_GetBasePath()} / "Content" / "Images" / "memorial.hdr"
+	};
+	for (const std::string_view argument: arguments)
+		if (!argument.starts_with("--"))
+			inputPath = argument;
+
+	std::vector<ToneMapOperator> operators{Operators.begin(), Operators.end()};
+	if (const auto value{FindOption(arguments, "operator")}; value && value != "all") {
+		const auto toneMapOperator{ParseToneMapOperator(*value)};
+		if (!toneMapOperator)
+			throw UsageError{"Unknown tone map operator: " + std::string{*value}};
+		operators = {*toneMapOperator};
+	}
+	std::vector<TransferFunction> transferFunctions{TransferFunction::Srgb};
+	if (const auto value{FindOption(arguments, "encode")}) {
+		if (value == "all")
+			transferFunctions = {TransferFunctions.begin(), TransferFunctions.end()};
+		else if (const auto transferFunction{ParseTransferFunction(*value)})
+			transferFunctions = {*transferFunction};
+		else
+			throw UsageError{"Unknown transfer function: " + std::string{*value}};
+	}
+	const auto referencePath{FindOption(arguments, "reference")};
+	if (referencePath && operators.size() * transferFunctions.size() != 1)
+		throw UsageError{"--reference needs a single --operator and --encode"};
+	const auto maxError{FindUnsignedOption<Uint8>(arguments, "max-error").value_or(1)};
+	const std::filesystem::path outputDirectory{FindOption(arguments, "output").value_or("tonemap-output")};
+	const auto benchmark{HasFlag(arguments, "benchmark")};
+	const auto compareScalar{HasFlag(arguments, "compare-scalar")};
+	const auto compareGpu{HasFlag(arguments, "compare-gpu")};
+
+	JobSystem jobSystem{
+		FindUnsignedOption(arguments, "job-threads")
+		.value_or(static_cast<Uint32>(std::max(SDL_GetNumLogicalCPUCores() - 1, 0)))
+	};
+
+	// Compute only, the offscreen video driver works without a display like the engine's headless mode
+	SDL_GPUDevice *device{};
+	if (compareGpu) {
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+		if (!SDL_Init(SDL_INIT_VIDEO))
+			throw SDLException{"Couldn't initialize SDL"};
+		device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_MSL | SDL_GPU_SHADERFORMAT_DXIL,
+		                             false, nullptr);
+		if (!device)
+			throw SDLException{"Couldn't create GPU device"};
+		std::println("GPU driver {}", SDL_GetGPUDeviceDriver(device));
+	}
+
+	const auto image{LoadHdrImage(inputPath)};
+	std::println("{} {}x{}, {} job threads", inputPath.string(), image.width, image.height,
+	             jobSystem.GetThreadCount());
+	const auto pixelCount{static_cast<size_t>(image.width) * image.height};
+	std::vector<Uint8> pixels(pixelCount * 4);
+	std::filesystem::create_directories(outputDirectory);
+
+	auto passed{true};
+	for (const auto toneMapOperator: operators)
+		for (const auto transferFunction: transferFunctions) {
+			ToneMapImage(jobSystem, image, toneMapOperator, transferFunction, pixels.data());
+			const auto path{
+				outputDirectory / std::format("{}-{}-{}.png", inputPath.stem().string(), ToString(toneMapOperator),
+				                              ToString(transferFunction))
+			};
+			SavePng(pixels, image.width, image.height, path);
+			std::println("{:<18} {:<4} wrote {}", ToString(toneMapOperator), ToString(transferFunction),
+			             path.string());
+
+			if (referencePath)
+				passed &= CompareWithReference(pixels, image.width, image.height, *referencePath, maxError);
+			if (compareScalar) {
+				std::vector<Uint8> expected(pixels.size());
+				ToneMapPixelsReference(image.pixels.data(), pixelCount, toneMapOperator, transferFunction,
+				                       expected.data());
+				passed &= ComparePixels("scalar reference", pixels, expected, image.width, image.height, maxError);
+			}
+			if (compareGpu) {
+				auto gpuPixels{ToneMapOnGpu(device, image, toneMapOperator, transferFunction)};
+				passed &= ComparePixels(std::format("{} shaders", SDL_GetGPUDeviceDriver(device)), gpuPixels, pixels,
+				                        image.width, image.height, maxError);
+			}
+
+			if (benchmark) {
+				const auto singleThread{
+					MeasureMegapixelsPerSecond(image, [&] {
+						ToneMapPixels(image.pixels.data(), pixelCount, toneMapOperator, transferFunction,
+						              pixels.data());
+					})
+				};
+				const auto jobs{
+					MeasureMegapixelsPerSecond(image, [&] {
+						ToneMapImage(jobSystem, image, toneMapOperator, transferFunction, pixels.data());
+					})
+				};
+				std::println("{:<18} {:<4} {:.1f} MP/s on one thread, {:.1f} MP/s on the job system",
+				             ToString(toneMapOperator), ToString(transferFunction), singleThread, jobs);
+			}
+		}
+
+	if (device) {
+		SDL_DestroyGPUDevice(device);
+		SDL_Quit();
+	}
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+	try {
+		return Run(std::span{argv, static_cast<size_t>(argc)}.subspan(1));
+	} catch (const UsageError &error) {
+		std::println(stderr, "{}", error.what());
+		return EXIT_FAILURE;
+	}
+}